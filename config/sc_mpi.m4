@@ -360,6 +360,67 @@ mpiret = MPI_Finalize ();
  $2])
 ])
 
+dnl SC_MPINBC_C_COMPILE_AND_LINK([action-if-successful], [action-if-failed])
+dnl Compile and link an MPI-3 nonblocking collectives test program
+dnl
+AC_DEFUN([SC_MPINBC_C_COMPILE_AND_LINK],
+[
+AC_MSG_CHECKING([compile/link for MPI nonblocking collectives C program])
+AC_LINK_IFELSE([AC_LANG_PROGRAM(
+[[
+#undef MPI
+#include <mpi.h>
+]], [[
+int mpiret;
+int flag;
+int sendval = 0, recvval;
+MPI_Request request;
+MPI_Init ((int *) 0, (char ***) 0);
+mpiret = MPI_Iallreduce (&sendval, &recvval, 1, MPI_INT, MPI_SUM,
+                         MPI_COMM_WORLD, &request);
+mpiret = MPI_Test (&request, &flag, MPI_STATUS_IGNORE);
+mpiret = MPI_Iallgather (&sendval, 1, MPI_INT, &recvval, 1, MPI_INT,
+                         MPI_COMM_WORLD, &request);
+mpiret = MPI_Wait (&request, MPI_STATUS_IGNORE);
+mpiret = MPI_Ibarrier (MPI_COMM_WORLD, &request);
+mpiret = MPI_Wait (&request, MPI_STATUS_IGNORE);
+mpiret = MPI_Finalize ();
+]])],
+[AC_MSG_RESULT([successful])
+ $1],
+[AC_MSG_RESULT([failed])
+ $2])
+])
+
+dnl SC_SHMPOSIX_C_COMPILE_AND_LINK([action-if-successful], [action-if-failed])
+dnl Compile and link a POSIX shared memory test program
+dnl Searches for shm_open in librt first, which older glibc versions require
+dnl
+AC_DEFUN([SC_SHMPOSIX_C_COMPILE_AND_LINK],
+[
+AC_SEARCH_LIBS([shm_open], [rt])
+AC_MSG_CHECKING([compile/link for POSIX shared memory C program])
+AC_LINK_IFELSE([AC_LANG_PROGRAM(
+[[
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+]], [[
+int fd;
+void *ptr;
+fd = shm_open ("/sc_conftest", O_CREAT | O_EXCL | O_RDWR, 0600);
+(void) ftruncate (fd, 4096);
+ptr = mmap (0, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+(void) close (fd);
+(void) shm_unlink ("/sc_conftest");
+(void) munmap (ptr, 4096);
+]])],
+[AC_MSG_RESULT([successful])
+ $1],
+[AC_MSG_RESULT([failed])
+ $2])
+])
+
 dnl SC_MPI_INCLUDES
 dnl Call the compiler with various --show* options
 dnl to figure out the MPI_INCLUDES and MPI_INCLUDE_PATH varables
@@ -456,6 +517,16 @@ dnl  ])
   if test "x$$1_ENABLE_MPICOMMSHARED" = xyes ; then
     AC_DEFINE([ENABLE_MPICOMMSHARED], 1, [Define to 1 if we can use MPI_COMM_TYPE_SHARED])
   fi
+  $1_ENABLE_MPINBC=yes
+  SC_MPINBC_C_COMPILE_AND_LINK(,[$1_ENABLE_MPINBC=no])
+  if test "x$$1_ENABLE_MPINBC" = xyes ; then
+    AC_DEFINE([ENABLE_MPINBC], 1, [Define to 1 if we can use MPI nonblocking collectives])
+  fi
+  $1_ENABLE_SHMPOSIX=yes
+  SC_SHMPOSIX_C_COMPILE_AND_LINK(,[$1_ENABLE_SHMPOSIX=no])
+  if test "x$$1_ENABLE_SHMPOSIX" = xyes ; then
+    AC_DEFINE([ENABLE_SHMPOSIX], 1, [Define to 1 if we can use POSIX shared memory between MPI processes])
+  fi
 fi
 
 dnl figure out the MPI include directories
@@ -41,6 +41,20 @@ dnl Keep the variables changed as done above
 dnl CFLAGS="$PRE_PTHREAD_CFLAGS"
 
   AC_MSG_RESULT([successful])
+
+dnl Atomic builtins let threads update counters without a mutex
+  AC_MSG_CHECKING([for atomic builtins])
+  AC_LINK_IFELSE([AC_LANG_PROGRAM(
+[[
+static int counter = 0;
+]],[[
+  __atomic_fetch_add (&counter, 1, __ATOMIC_RELAXED);
+  return __atomic_load_n (&counter, __ATOMIC_ACQUIRE) != 1;
+]])],
+    [AC_MSG_RESULT([successful])
+     AC_DEFINE([HAVE_ATOMIC_BUILTINS], 1,
+               [Define to 1 if the compiler has the __atomic builtins])],
+    [AC_MSG_RESULT([failed])])
 else
   AC_MSG_RESULT([not used])
 fi
@@ -304,6 +304,26 @@ test_shmem_test1 ()
   sc_log_indent_pop ();
 }
 
+/* Let sc_shmem_autotune time every type and verify the chosen one. */
+void
+test_shmem_autotune ()
+{
+  sc_shmem_type_t     type;
+
+  SC_GLOBAL_ESSENTIAL ("Testing sc_shmem_autotune.\n");
+  sc_log_indent_push ();
+  type = sc_shmem_autotune (sc_MPI_COMM_WORLD);
+  SC_CHECK_ABORT (sc_shmem_get_type (sc_MPI_COMM_WORLD) == type,
+                  "Error in shmem_autotune. Type is not cached.");
+  SC_GLOBAL_ESSENTIALF ("Tuned type is %s.\n",
+                        sc_shmem_type_to_string[type]);
+  test_shmem_allgather (type);
+  test_shmem_copy (type);
+  test_shmem_write (type);
+  test_shmem_prefix (type);
+  sc_log_indent_pop ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -315,6 +335,7 @@ main (int argc, char *argv[])
   sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
 
   test_shmem_test1 ();
+  test_shmem_autotune ();
 
   sc_finalize ();
 
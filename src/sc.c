@@ -22,6 +22,7 @@
 */
 
 #include <sc_private.h>
+#include <sc_notify.h>
 
 #ifdef SC_HAVE_SIGNAL_H
 #include <signal.h>
@@ -41,6 +42,17 @@ typedef void        (*sc_sig_t) (int);
 
 #include <errno.h>
 
+#if defined SC_HAVE_SYS_MMAN_H && defined SC_HAVE_MMAP
+#include <sys/mman.h>
+#define SC_MEMORY_MMAP
+#if defined SC_HAVE_SYS_SYSCALL_H && defined SC_HAVE_SYSCALL
+#include <sys/syscall.h>
+#ifdef SYS_mbind
+#define SC_MEMORY_MBIND
+#endif
+#endif
+#endif
+
 #ifdef SC_ENABLE_PTHREAD
 #include <pthread.h>
 #endif
@@ -53,6 +65,8 @@ typedef struct sc_package
   int                 log_indent;
   int                 malloc_count;
   int                 free_count;
+  sc_memory_stats_t   memory_stats;
+  sc_memory_policy_t  memory_policy;
   int                 rc_active;
   int                 abort_mismatch;
   const char         *name;
@@ -96,6 +110,10 @@ int                 sc_trace_prio = SC_LP_STATISTICS;
 
 static int          default_malloc_count = 0;
 static int          default_free_count = 0;
+#ifdef SC_ENABLE_MEMSTATS
+static sc_memory_stats_t default_memory_stats;
+#endif
+static sc_memory_policy_t default_memory_policy;
 static int          default_rc_active = 0;
 static int          default_abort_mismatch = 1;
 
@@ -295,6 +313,44 @@ sc_log_handler (FILE * log_stream, const char *filename, int lineno,
   fflush (log_stream);
 }
 
+/* With atomic builtins the allocation counters need no mutex.
+ * Each package keeps one shared counter per direction: a relaxed atomic
+ * increment takes no lock, and reading needs no merge over per-thread
+ * copies.  There is no thread-local cache of freed blocks; the system
+ * allocator keeps per-thread caches of small blocks already, and only
+ * --enable-memstats stores the block size that such a cache would need. */
+#if defined SC_ENABLE_PTHREAD && defined SC_HAVE_ATOMIC_BUILTINS
+#define SC_ATOMIC_COUNTS
+#endif
+
+/** Add one to an allocation counter of a package. */
+static inline void
+sc_count_increment (int package, int *count)
+{
+#ifdef SC_ATOMIC_COUNTS
+  __atomic_fetch_add (count, 1, __ATOMIC_RELAXED);
+#else
+#ifdef SC_ENABLE_PTHREAD
+  sc_package_lock (package);
+#endif
+  ++*count;
+#ifdef SC_ENABLE_PTHREAD
+  sc_package_unlock (package);
+#endif
+#endif
+}
+
+/** Read an allocation counter that other threads may be changing. */
+static inline int
+sc_count_read (const int *count)
+{
+#ifdef SC_ATOMIC_COUNTS
+  return __atomic_load_n (count, __ATOMIC_ACQUIRE);
+#else
+  return *count;
+#endif
+}
+
 static int         *
 sc_malloc_count (int package)
 {
@@ -315,6 +371,102 @@ sc_free_count (int package)
   return &sc_packages[package].free_count;
 }
 
+#ifdef SC_ENABLE_MEMSTATS
+
+static sc_memory_stats_t *
+sc_memory_stats_package (int package)
+{
+  if (package == -1)
+    return &default_memory_stats;
+
+  SC_ASSERT (sc_package_is_registered (package));
+  return &sc_packages[package].memory_stats;
+}
+
+/* The header in front of each allocation keeps its size.
+ * A multiple of the alignment keeps the returned pointer aligned. */
+#if defined SC_ENABLE_MEMALIGN && SC_MEMALIGN_BYTES > 16
+#define SC_MEMSTATS_HEADER ((size_t) SC_MEMALIGN_BYTES)
+#else
+#define SC_MEMSTATS_HEADER ((size_t) 16)
+#endif
+
+#ifdef SC_ATOMIC_COUNTS
+#define SC_MEMSTATS_ADD(v,a) __atomic_add_fetch (&(v), (a), __ATOMIC_RELAXED)
+#define SC_MEMSTATS_SUB(v,a) __atomic_sub_fetch (&(v), (a), __ATOMIC_RELAXED)
+#define SC_MEMSTATS_READ(v) __atomic_load_n (&(v), __ATOMIC_RELAXED)
+#else
+#define SC_MEMSTATS_ADD(v,a) ((v) += (a))
+#define SC_MEMSTATS_SUB(v,a) ((v) -= (a))
+#define SC_MEMSTATS_READ(v) (v)
+#endif
+
+/** Account for an allocation changing from old_size to new_size bytes.
+ * \param [in] is_new  True if new_size bytes have been (re)allocated. */
+static void
+sc_memstats_update (int package, size_t old_size, size_t new_size,
+                    int is_new)
+{
+  int                 b;
+  size_t              current;
+  sc_memory_stats_t  *stats = sc_memory_stats_package (package);
+
+#if defined SC_ENABLE_PTHREAD && !defined SC_ATOMIC_COUNTS
+  sc_package_lock (package);
+#endif
+  if (new_size >= old_size) {
+    current = SC_MEMSTATS_ADD (stats->current_bytes, new_size - old_size);
+  }
+  else {
+    current = SC_MEMSTATS_SUB (stats->current_bytes, old_size - new_size);
+  }
+  if (is_new) {
+    SC_MEMSTATS_ADD (stats->total_bytes, new_size);
+    b = new_size == 0 ? 0 : SC_LOG2_64 ((uint64_t) new_size) + 1;
+    SC_MEMSTATS_ADD (stats->histogram[SC_MIN (b,
+                                              SC_MEMORY_HISTOGRAM_SIZE - 1)],
+                     1);
+  }
+#ifdef SC_ATOMIC_COUNTS
+  {
+    size_t              peak =
+      __atomic_load_n (&stats->peak_bytes, __ATOMIC_RELAXED);
+
+    while (current > peak &&
+           !__atomic_compare_exchange_n (&stats->peak_bytes, &peak, current,
+                                         1, __ATOMIC_RELAXED,
+                                         __ATOMIC_RELAXED)) {
+    }
+  }
+#else
+  stats->peak_bytes = SC_MAX (stats->peak_bytes, current);
+#endif
+#if defined SC_ENABLE_PTHREAD && !defined SC_ATOMIC_COUNTS
+  sc_package_unlock (package);
+#endif
+}
+
+/** Write the size into the header and return the memory behind it. */
+static void        *
+sc_memstats_enter (int package, void *base, size_t size)
+{
+  *(size_t *) base = size;
+  sc_memstats_update (package, 0, size, 1);
+  return (char *) base + SC_MEMSTATS_HEADER;
+}
+
+/** Account for freeing memory and return the start of its header. */
+static void        *
+sc_memstats_leave (int package, void *ptr)
+{
+  char               *base = (char *) ptr - SC_MEMSTATS_HEADER;
+
+  sc_memstats_update (package, *(size_t *) base, 0, 0);
+  return base;
+}
+
+#endif /* SC_ENABLE_MEMSTATS */
+
 #ifdef SC_ENABLE_MEMALIGN
 
 /* *INDENT-OFF* */
@@ -513,71 +665,416 @@ sc_realloc_aligned (void *ptr, size_t alignment, size_t size)
 
 #endif /* SC_ENABLE_MEMALIGN */
 
-void               *
-sc_malloc (int package, size_t size)
+/** Allocate memory without header and policy, abort if out of memory. */
+static void        *
+sc_malloc_plain (size_t size)
 {
-  void               *ret;
-  int                *malloc_count = sc_malloc_count (package);
-
-  /* allocate memory */
 #if defined SC_ENABLE_MEMALIGN
-  ret = sc_malloc_aligned (SC_MEMALIGN_BYTES, size);
+  return sc_malloc_aligned (SC_MEMALIGN_BYTES, size);
 #else
-  ret = malloc (size);
+  void               *ret = malloc (size);
+
   if (size > 0) {
     SC_CHECK_ABORTF (ret != NULL, "Allocation (malloc size %lli)",
                      (long long int) size);
   }
+  return ret;
 #endif
+}
 
-  /* count the allocations */
+/** Reallocate memory obtained by sc_malloc_plain to size > 0 bytes. */
+static void        *
+sc_realloc_plain (void *ptr, size_t size)
+{
+#if defined SC_ENABLE_MEMALIGN
+  return sc_realloc_aligned (ptr, SC_MEMALIGN_BYTES, size);
+#else
+  void               *ret = realloc (ptr, size);
+
+  SC_CHECK_ABORTF (ret != NULL, "Reallocation (realloc size %lli)",
+                   (long long int) size);
+  return ret;
+#endif
+}
+
+/** Free memory obtained by sc_malloc_plain or sc_realloc_plain. */
+static void
+sc_free_plain (void *ptr)
+{
+#if defined SC_ENABLE_MEMALIGN
+  sc_free_aligned (ptr, SC_MEMALIGN_BYTES);
+#else
+  free (ptr);
+#endif
+}
+
+static sc_memory_policy_t *
+sc_memory_policy_package (int package)
+{
+  if (package == -1)
+    return &default_memory_policy;
+
+  SC_ASSERT (sc_package_is_registered (package));
+  return &sc_packages[package].memory_policy;
+}
+
+/** Return true if an allocation of size bytes is to be mapped. */
+static inline int
+sc_memory_policy_applies (const sc_memory_policy_t * policy, size_t size)
+{
+  return policy->flags != 0 && size > 0 && size >= policy->threshold;
+}
+
+#ifdef SC_MEMORY_MMAP
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+/* The size of transparent huge pages on common hardware. */
+#define SC_MMAP_HUGEPAGE ((size_t) 1 << 21)
+
+#ifdef SC_MEMORY_MBIND
+/* Values and bit count of the Linux NUMA interface, see numaif.h. */
+#define SC_MPOL_INTERLEAVE 3
+#define SC_MPOL_LOCAL 4
+#define SC_MPOL_F_MEMS_ALLOWED 4
+#define SC_MPOL_MAXNODE 1024
+#endif
+
+/** A mapping made by sc_mmap_alloc.
+ * Mapped blocks are few and large, so an unsorted array finds them. */
+typedef struct sc_mmap_block
+{
+  char               *ptr;      /* start of the mapping */
+  size_t              length;   /* length of the mapping */
+  size_t              size;     /* bytes requested */
+}
+sc_mmap_block_t;
+
+static sc_mmap_block_t *sc_mmap_blocks = NULL;
+static int          sc_mmap_num_blocks = 0;
+static int          sc_mmap_num_alloc = 0;
+static size_t       sc_mmap_page = 0;       /* set with the first block */
 #ifdef SC_ENABLE_PTHREAD
-  sc_package_lock (package);
+static pthread_mutex_t sc_mmap_mutex = PTHREAD_MUTEX_INITIALIZER;
 #endif
-  if (size > 0) {
-    ++*malloc_count;
+
+static void
+sc_mmap_lock (void)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth = pthread_mutex_lock (&sc_mmap_mutex);
+
+  sc_check_abort_thread (pth == 0, -1, "sc_mmap_lock");
+#endif
+}
+
+static void
+sc_mmap_unlock (void)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth = pthread_mutex_unlock (&sc_mmap_mutex);
+
+  sc_check_abort_thread (pth == 0, -1, "sc_mmap_unlock");
+#endif
+}
+
+/** Change the number of blocks with the registry locked.
+ * Other threads may read it without locking, see sc_mmap_find. */
+static void
+sc_mmap_set_num_blocks (int num_blocks)
+{
+#ifdef SC_ATOMIC_COUNTS
+  __atomic_store_n (&sc_mmap_num_blocks, num_blocks, __ATOMIC_RELEASE);
+#else
+  sc_mmap_num_blocks = num_blocks;
+#endif
+}
+
+/** Apply the placement flags to a new mapping.
+ * The flags are advisory, so failing system calls are ignored. */
+static void
+sc_mmap_advise (char *ptr, size_t length, int flags)
+{
+#if defined SC_HAVE_MADVISE && defined MADV_HUGEPAGE
+  if (flags & SC_MEMORY_POLICY_HUGEPAGE) {
+    (void) madvise (ptr, length, MADV_HUGEPAGE);
   }
-  else {
-    *malloc_count += ((ret == NULL) ? 0 : 1);
+#endif
+#ifdef SC_MEMORY_MBIND
+  if (flags & SC_MEMORY_POLICY_INTERLEAVE) {
+    unsigned long       nodemask[SC_MPOL_MAXNODE / (8 * sizeof (long))];
+
+    /* interleave over the nodes this process may allocate on */
+    if (syscall (SYS_get_mempolicy, NULL, nodemask,
+                 (unsigned long) SC_MPOL_MAXNODE, NULL,
+                 (unsigned long) SC_MPOL_F_MEMS_ALLOWED) == 0) {
+      /* the kernel expects one more than the number of bits */
+      (void) syscall (SYS_mbind, ptr, (unsigned long) length,
+                      SC_MPOL_INTERLEAVE, nodemask,
+                      (unsigned long) SC_MPOL_MAXNODE + 1, 0U);
+    }
+  }
+  else if (flags & SC_MEMORY_POLICY_FIRST_TOUCH) {
+    (void) syscall (SYS_mbind, ptr, (unsigned long) length,
+                    SC_MPOL_LOCAL, NULL, 0UL, 0U);
+  }
+#endif
+}
+
+/** Map memory according to a policy and register the mapping.
+ * \return      Zeroed memory, or NULL if malloc is to be used instead.
+ */
+static void        *
+sc_mmap_alloc (size_t size, const sc_memory_policy_t * policy)
+{
+  const size_t        page = (size_t) sysconf (_SC_PAGESIZE);
+  size_t              align, length, lead, extra;
+  char               *map, *ptr;
+  sc_mmap_block_t    *block;
+
+  if (!sc_memory_policy_applies (policy, size)) {
+    return NULL;
+  }
+
+  /* over-allocate to align the mapping for huge pages and trim it */
+  align = SC_MAX (page, (policy->flags & SC_MEMORY_POLICY_HUGEPAGE) ?
+                  SC_MMAP_HUGEPAGE : page);
+  length = SC_ALIGN_UP (size, page);
+  extra = align - page;
+  map = (char *) mmap (NULL, length + extra, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map == (char *) MAP_FAILED) {
+    return NULL;
+  }
+  lead = (align - (size_t) ((uintptr_t) map % align)) % align;
+  if (lead > 0) {
+    (void) munmap (map, lead);
+  }
+  if (extra > lead) {
+    (void) munmap (map + lead + length, extra - lead);
+  }
+  ptr = map + lead;
+  sc_mmap_advise (ptr, length, policy->flags);
+
+  sc_mmap_lock ();
+  if (sc_mmap_num_blocks == sc_mmap_num_alloc) {
+    sc_mmap_num_alloc = 2 * sc_mmap_num_alloc + 8;
+    sc_mmap_blocks = (sc_mmap_block_t *)
+      realloc (sc_mmap_blocks, sc_mmap_num_alloc * sizeof (sc_mmap_block_t));
+    SC_CHECK_ABORT (sc_mmap_blocks != NULL, "Failed to allocate memory");
+  }
+  block = sc_mmap_blocks + sc_mmap_num_blocks;
+  block->ptr = ptr;
+  block->length = length;
+  block->size = size;
+  sc_mmap_page = page;
+  sc_mmap_set_num_blocks (sc_mmap_num_blocks + 1);
+  sc_mmap_unlock ();
+
+  return ptr;
+}
+
+/** Look up a pointer among the mappings.
+ * \param [in] remove   If true, unregister and unmap the mapping.
+ * \return              Bytes requested for the mapping, 0 if not mapped.
+ */
+static size_t
+sc_mmap_find (void *ptr, int remove)
+{
+  int                 i;
+  size_t              size = 0;
+  sc_mmap_block_t     found;
+
+  /* a pointer passed to this thread has been registered before */
+  if (sc_count_read (&sc_mmap_num_blocks) == 0) {
+    return 0;
+  }
+
+  /* mappings are page aligned: reject most pointers without locking */
+  if ((uintptr_t) ptr % sc_mmap_page != 0) {
+    return 0;
+  }
+
+  sc_mmap_lock ();
+  for (i = sc_mmap_num_blocks - 1; i >= 0; --i) {
+    if (sc_mmap_blocks[i].ptr == (char *) ptr) {
+      found = sc_mmap_blocks[i];
+      size = found.size;
+      if (remove) {
+        sc_mmap_blocks[i] = sc_mmap_blocks[sc_mmap_num_blocks - 1];
+        sc_mmap_set_num_blocks (sc_mmap_num_blocks - 1);
+        if (sc_mmap_num_blocks == 0) {
+          free (sc_mmap_blocks);
+          sc_mmap_blocks = NULL;
+          sc_mmap_num_alloc = 0;
+        }
+      }
+      break;
+    }
+  }
+  sc_mmap_unlock ();
+
+  if (remove && size > 0) {
+    SC_EXECUTE_ASSERT_FALSE (munmap (found.ptr, found.length));
+  }
+  return size;
+}
+
+#endif /* SC_MEMORY_MMAP */
+
+/** Allocate memory without header according to a policy. */
+static void        *
+sc_malloc_placed (size_t size, const sc_memory_policy_t * policy)
+{
+#ifdef SC_MEMORY_MMAP
+  void               *ret = sc_mmap_alloc (size, policy);
+
+  if (ret != NULL) {
+    return ret;
   }
-#ifdef SC_ENABLE_PTHREAD
-  sc_package_unlock (package);
 #endif
+  return sc_malloc_plain (size);
+}
 
+/** Reallocate memory without header according to a policy. */
+static void        *
+sc_realloc_placed (void *ptr, size_t size, const sc_memory_policy_t * policy)
+{
+#ifdef SC_MEMORY_MMAP
+  void               *ret;
+  size_t              old_size = sc_mmap_find (ptr, 0);
+
+  if (old_size == 0) {
+    if (!sc_memory_policy_applies (policy, size)) {
+      return sc_realloc_plain (ptr, size);
+    }
+
+    /* we do not know the old size, but realloc makes size bytes valid */
+    ptr = sc_realloc_plain (ptr, size);
+    ret = sc_mmap_alloc (size, policy);
+    if (ret == NULL) {
+      return ptr;
+    }
+    memcpy (ret, ptr, size);
+    sc_free_plain (ptr);
+    return ret;
+  }
+
+  /* move the mapped memory into a new mapping or a malloc block */
+  ret = sc_malloc_placed (size, policy);
+  memcpy (ret, ptr, SC_MIN (old_size, size));
+  sc_mmap_find (ptr, 1);
   return ret;
+#else
+  return sc_realloc_plain (ptr, size);
+#endif
+}
+
+/** Free memory without header allocated by any policy. */
+static void
+sc_free_placed (void *ptr)
+{
+#ifdef SC_MEMORY_MMAP
+  if (sc_mmap_find (ptr, 1) > 0) {
+    return;
+  }
+#endif
+  sc_free_plain (ptr);
+}
+
+void
+sc_memory_policy_set (int package, const sc_memory_policy_t * policy)
+{
+  sc_memory_policy_t *p = sc_memory_policy_package (package);
+
+  if (policy == NULL) {
+    memset (p, 0, sizeof (sc_memory_policy_t));
+    return;
+  }
+  SC_CHECK_ABORT (!(policy->flags & SC_MEMORY_POLICY_INTERLEAVE) ||
+                  !(policy->flags & SC_MEMORY_POLICY_FIRST_TOUCH),
+                  "Memory policy interleave excludes first touch");
+  *p = *policy;
+}
+
+void
+sc_memory_policy_get (int package, sc_memory_policy_t * policy)
+{
+  *policy = *sc_memory_policy_package (package);
 }
 
 void               *
-sc_calloc (int package, size_t nmemb, size_t size)
+sc_malloc_policy (int package, size_t size, const sc_memory_policy_t * policy)
 {
   void               *ret;
   int                *malloc_count = sc_malloc_count (package);
+  size_t              alloc_size = size;
+
+#ifdef SC_ENABLE_MEMSTATS
+  alloc_size += SC_MEMSTATS_HEADER;
+#endif
 
   /* allocate memory */
+  ret = sc_malloc_placed (alloc_size, policy);
+#ifdef SC_ENABLE_MEMSTATS
+  ret = sc_memstats_enter (package, ret, size);
+#endif
+
+  /* count the allocations */
+  if (size > 0 || ret != NULL) {
+    sc_count_increment (package, malloc_count);
+  }
+
+  return ret;
+}
+
+void               *
+sc_malloc (int package, size_t size)
+{
+  return sc_malloc_policy (package, size, sc_memory_policy_package (package));
+}
+
+void               *
+sc_calloc (int package, size_t nmemb, size_t size)
+{
+  void               *ret = NULL;
+  int                *malloc_count = sc_malloc_count (package);
+  size_t              alloc_size = nmemb * size;
+
+#ifdef SC_ENABLE_MEMSTATS
+  alloc_size += SC_MEMSTATS_HEADER;
+#endif
+
+  /* allocate memory, mapped memory is zeroed already */
+#ifdef SC_MEMORY_MMAP
+  ret = sc_mmap_alloc (alloc_size, sc_memory_policy_package (package));
+#endif
+  if (ret == NULL) {
 #if defined SC_ENABLE_MEMALIGN
-  ret = sc_malloc_aligned (SC_MEMALIGN_BYTES, nmemb * size);
-  memset (ret, 0, nmemb * size);
+    ret = sc_malloc_aligned (SC_MEMALIGN_BYTES, alloc_size);
+    memset (ret, 0, alloc_size);
 #else
-  ret = calloc (nmemb, size);
-  if (nmemb * size > 0) {
-    SC_CHECK_ABORTF (ret != NULL, "Allocation (calloc size %lli)",
-                     (long long int) size);
+#ifdef SC_ENABLE_MEMSTATS
+    ret = calloc (1, alloc_size);
+#else
+    ret = calloc (nmemb, size);
+#endif
+    if (alloc_size > 0) {
+      SC_CHECK_ABORTF (ret != NULL, "Allocation (calloc size %lli)",
+                       (long long int) size);
+    }
+#endif
   }
+#ifdef SC_ENABLE_MEMSTATS
+  ret = sc_memstats_enter (package, ret, nmemb * size);
 #endif
 
   /* count the allocations */
-#ifdef SC_ENABLE_PTHREAD
-  sc_package_lock (package);
-#endif
-  if (nmemb * size > 0) {
-    ++*malloc_count;
-  }
-  else {
-    *malloc_count += ((ret == NULL) ? 0 : 1);
+  if (nmemb * size > 0 || ret != NULL) {
+    sc_count_increment (package, malloc_count);
   }
-#ifdef SC_ENABLE_PTHREAD
-  sc_package_unlock (package);
-#endif
 
   return ret;
 }
@@ -594,13 +1091,21 @@ sc_realloc (int package, void *ptr, size_t size)
   }
   else {
     void               *ret;
+    size_t              alloc_size = size;
+#ifdef SC_ENABLE_MEMSTATS
+    size_t              old_size;
 
-#if defined SC_ENABLE_MEMALIGN
-    ret = sc_realloc_aligned (ptr, SC_MEMALIGN_BYTES, size);
-#else
-    ret = realloc (ptr, size);
-    SC_CHECK_ABORTF (ret != NULL, "Reallocation (realloc size %lli)",
-                     (long long int) size);
+    ptr = (char *) ptr - SC_MEMSTATS_HEADER;
+    old_size = *(size_t *) ptr;
+    alloc_size += SC_MEMSTATS_HEADER;
+#endif
+
+    ret = sc_realloc_placed (ptr, alloc_size,
+                             sc_memory_policy_package (package));
+#ifdef SC_ENABLE_MEMSTATS
+    *(size_t *) ret = size;
+    sc_memstats_update (package, old_size, size, 1);
+    ret = (char *) ret + SC_MEMSTATS_HEADER;
 #endif
 
     return ret;
@@ -632,23 +1137,14 @@ sc_free (int package, void *ptr)
   }
   else {
     /* uncount the allocations */
-    int                *free_count = sc_free_count (package);
-
-#ifdef SC_ENABLE_PTHREAD
-    sc_package_lock (package);
-#endif
-    ++*free_count;
-#ifdef SC_ENABLE_PTHREAD
-    sc_package_unlock (package);
+    sc_count_increment (package, sc_free_count (package));
+#ifdef SC_ENABLE_MEMSTATS
+    ptr = sc_memstats_leave (package, ptr);
 #endif
   }
 
   /* free memory */
-#if defined SC_ENABLE_MEMALIGN
-  sc_free_aligned (ptr, SC_MEMALIGN_BYTES);
-#else
-  free (ptr);
-#endif
+  sc_free_placed (ptr);
 }
 
 int
@@ -657,12 +1153,72 @@ sc_memory_status (int package)
   sc_package_t       *p;
 
   if (package == -1) {
-    return (default_malloc_count - default_free_count);
+    return (sc_count_read (&default_malloc_count) -
+            sc_count_read (&default_free_count));
   }
   else {
     SC_ASSERT (sc_package_is_registered (package));
     p = sc_packages + package;
-    return (p->malloc_count - p->free_count);
+    return (sc_count_read (&p->malloc_count) -
+            sc_count_read (&p->free_count));
+  }
+}
+
+int
+sc_memory_stats (int package, sc_memory_stats_t * stats)
+{
+#ifdef SC_ENABLE_MEMSTATS
+  int                 b;
+  sc_memory_stats_t  *p = sc_memory_stats_package (package);
+
+  stats->current_bytes = SC_MEMSTATS_READ (p->current_bytes);
+  stats->peak_bytes = SC_MEMSTATS_READ (p->peak_bytes);
+  stats->total_bytes = SC_MEMSTATS_READ (p->total_bytes);
+  for (b = 0; b < SC_MEMORY_HISTOGRAM_SIZE; ++b) {
+    stats->histogram[b] = SC_MEMSTATS_READ (p->histogram[b]);
+  }
+  return 1;
+#else
+  memset (stats, 0, sizeof (sc_memory_stats_t));
+  return 0;
+#endif
+}
+
+void
+sc_memory_stats_print (int package, int log_priority)
+{
+  int                 b;
+  sc_memory_stats_t   stats;
+
+  if (!sc_memory_stats (package, &stats)) {
+    return;
+  }
+  SC_GEN_LOGF (sc_package_id, SC_LC_GLOBAL, log_priority,
+               "Memory of %s: current %llu peak %llu total %llu bytes\n",
+               package == -1 ? "default" : sc_packages[package].name,
+               (unsigned long long) stats.current_bytes,
+               (unsigned long long) stats.peak_bytes,
+               (unsigned long long) stats.total_bytes);
+  for (b = 0; b < SC_MEMORY_HISTOGRAM_SIZE; ++b) {
+    if (stats.histogram[b] == 0) {
+      continue;
+    }
+    if (b == 0) {
+      SC_GEN_LOGF (sc_package_id, SC_LC_GLOBAL, log_priority,
+                   "   size 0: %llu\n",
+                   (unsigned long long) stats.histogram[b]);
+    }
+    else if (b < SC_MEMORY_HISTOGRAM_SIZE - 1) {
+      SC_GEN_LOGF (sc_package_id, SC_LC_GLOBAL, log_priority,
+                   "   size [%llu, %llu): %llu\n",
+                   1ULL << (b - 1), 1ULL << b,
+                   (unsigned long long) stats.histogram[b]);
+    }
+    else {
+      SC_GEN_LOGF (sc_package_id, SC_LC_GLOBAL, log_priority,
+                   "   size [%llu, ...): %llu\n", 1ULL << (b - 1),
+                   (unsigned long long) stats.histogram[b]);
+    }
   }
 }
 
@@ -685,26 +1241,24 @@ void
 sc_memory_check (int package)
 {
   sc_package_t       *p;
+  const int           balance = sc_memory_status (package);
 
   if (package == -1) {
     SC_CHECK_ABORT (default_rc_active == 0, "Leftover references (default)");
     if (default_abort_mismatch) {
-      SC_CHECK_ABORT (default_malloc_count == default_free_count,
-                      "Memory balance (default)");
+      SC_CHECK_ABORT (balance == 0, "Memory balance (default)");
     }
-    else if (default_malloc_count != default_free_count) {
+    else if (balance != 0) {
       SC_GLOBAL_LERROR ("Memory balance (default)\n");
     }
   }
   else {
-    SC_ASSERT (sc_package_is_registered (package));
     p = sc_packages + package;
     SC_CHECK_ABORTF (p->rc_active == 0, "Leftover references (%s)", p->name);
     if (p->abort_mismatch) {
-      SC_CHECK_ABORTF (p->malloc_count == p->free_count,
-                       "Memory balance (%s)", p->name);
+      SC_CHECK_ABORTF (balance == 0, "Memory balance (%s)", p->name);
     }
-    else if (p->malloc_count != p->free_count) {
+    else if (balance != 0) {
       SC_GLOBAL_LERRORF ("Memory balance (%s)\n", p->name);
     }
   }
@@ -1058,6 +1612,8 @@ sc_package_register (sc_log_handler_t log_handler, int log_threshold,
       p->log_indent = 0;
       p->malloc_count = 0;
       p->free_count = 0;
+      memset (&p->memory_stats, 0, sizeof (sc_memory_stats_t));
+      memset (&p->memory_policy, 0, sizeof (sc_memory_policy_t));
       p->rc_active = 0;
       p->name = NULL;
       p->full = NULL;
@@ -1070,6 +1626,8 @@ sc_package_register (sc_log_handler_t log_handler, int log_threshold,
   new_package->log_indent = 0;
   new_package->malloc_count = 0;
   new_package->free_count = 0;
+  memset (&new_package->memory_stats, 0, sizeof (sc_memory_stats_t));
+  memset (&new_package->memory_policy, 0, sizeof (sc_memory_policy_t));
   new_package->rc_active = 0;
   new_package->abort_mismatch = 1;
   new_package->name = name;
@@ -1128,6 +1686,8 @@ sc_package_unregister (int package_id)
   p->log_handler = NULL;
   p->log_threshold = SC_LP_DEFAULT;
   p->malloc_count = p->free_count = 0;
+  memset (&p->memory_stats, 0, sizeof (sc_memory_stats_t));
+  memset (&p->memory_policy, 0, sizeof (sc_memory_policy_t));
   p->rc_active = 0;
 #ifdef SC_ENABLE_PTHREAD
   i = pthread_mutex_destroy (&p->mutex);
@@ -1283,6 +1843,16 @@ sc_finalize (void)
 #if defined(SC_ENABLE_MPI) && defined(SC_ENABLE_MPICOMMSHARED)
   sc_mpi_comm_detach_node_comms (sc_mpicomm);
 #endif
+  sc_mpi_free_nbc_tags ();
+  sc_notify_free_types ();
+
+#ifdef SC_ENABLE_MEMSTATS
+  /* report memory usage while the packages are still registered */
+  sc_memory_stats_print (-1, SC_LP_STATISTICS);
+  for (i = 0; i < sc_num_packages_alloc; ++i)
+    if (sc_packages[i].is_registered)
+      sc_memory_stats_print (i, SC_LP_STATISTICS);
+#endif
 
   /* sc_packages is static and thus initialized to all zeros */
   for (i = sc_num_packages_alloc - 1; i >= 0; --i)
@@ -264,6 +264,8 @@ void                SC_CHECK_ABORTF (int success, const char *fmt, ...)
                                                (size_t) (n), sizeof(t))
 #define SC_REALLOC(p,t,n)     (t *) sc_realloc (sc_package_id,          \
                                              (p), (n) * sizeof(t))
+#define SC_ALLOC_POLICY(t,n,y) (t *) sc_malloc_policy (sc_package_id,   \
+                                                   (n) * sizeof(t), (y))
 #define SC_STRDUP(s)                sc_strdup (sc_package_id, (s))
 #define SC_FREE(p)                  sc_free (sc_package_id, (p))
 
@@ -500,6 +502,106 @@ void                sc_free (int package, void *ptr);
 int                 sc_memory_status (int package);
 void                sc_memory_check (int package);
 
+/** Number of size classes in the histogram of sc_memory_stats_t. */
+#define SC_MEMORY_HISTOGRAM_SIZE 40
+
+/** Byte statistics of the allocations of one package.
+ * They are only recorded if configured with --enable-memstats.
+ * Then every allocation carries a small header that stores its size.
+ */
+typedef struct sc_memory_stats
+{
+  size_t              current_bytes;    /**< Bytes allocated right now. */
+  size_t              peak_bytes;       /**< Maximum of current_bytes. */
+  size_t              total_bytes;      /**< Bytes of all allocations and
+                                             reallocations ever made. */
+  size_t              histogram[SC_MEMORY_HISTOGRAM_SIZE];
+                                        /**< Allocations by size: entry 0
+                                             counts size 0, entry b > 0
+                                             sizes in [2^(b-1), 2^b).  The
+                                             last entry counts all larger. */
+}
+sc_memory_stats_t;
+
+/** Query the byte statistics of a package.
+ * \param [in] package     Must be -1 for the default package or
+ *                         the identifier of a registered package.
+ * \param [out] stats      Filled with the statistics, or zeroed if byte
+ *                         statistics are not configured.
+ * \return                 True if byte statistics are configured.
+ */
+int                 sc_memory_stats (int package, sc_memory_stats_t * stats);
+
+/** Log the byte statistics of a package and its nonempty size classes.
+ * Uses the SC_LC_GLOBAL log category which by default only prints on rank 0.
+ * \param [in] package         Must be -1 for the default package or
+ *                             the identifier of a registered package.
+ * \param [in] log_priority    Priority passed to sc log functions.
+ */
+void                sc_memory_stats_print (int package, int log_priority);
+
+/** Serve large allocations by anonymous mmap instead of malloc. */
+#define SC_MEMORY_POLICY_MMAP         0x1
+/** Align mapped memory to 2 MiB and advise transparent huge pages. */
+#define SC_MEMORY_POLICY_HUGEPAGE     0x2
+/** Interleave the pages of mapped memory over all NUMA nodes. */
+#define SC_MEMORY_POLICY_INTERLEAVE   0x4
+/** Place each page of mapped memory on the node of the thread that first
+ * touches it, regardless of the policy of the process. */
+#define SC_MEMORY_POLICY_FIRST_TOUCH  0x8
+
+/** Default size in bytes from which a memory policy applies. */
+#define SC_MEMORY_POLICY_THRESHOLD    ((size_t) 1 << 24)
+
+/** How sc_malloc, sc_calloc and sc_realloc place large allocations.
+ * Allocations of at least threshold bytes are mapped if any flag is set;
+ * the flags HUGEPAGE, INTERLEAVE and FIRST_TOUCH imply MMAP, and
+ * INTERLEAVE and FIRST_TOUCH are mutually exclusive.
+ * The placement is advisory: if a system call is not supported or fails,
+ * the memory is obtained by mmap with fewer properties or by malloc.
+ * Mapped memory is released by sc_free and reallocated by sc_realloc as
+ * usual, so containers such as sc_array_t and sc_dmatrix_t need no change.
+ */
+typedef struct sc_memory_policy
+{
+  int                 flags;            /**< Bitwise or of SC_MEMORY_POLICY
+                                             flags, 0 to always malloc. */
+  size_t              threshold;        /**< Minimum size in bytes that
+                                             the flags apply to. */
+}
+sc_memory_policy_t;
+
+/** Set the memory policy of a package.
+ * All later allocations of this package are placed accordingly, for
+ * example those of sc_array_resize, sc_dmatrix_new and sc_darray_work_new
+ * when called with the libsc package sc_package_id.
+ * This function must not be called concurrently with allocations.
+ * \param [in] package     Must be -1 for the default package or
+ *                         the identifier of a registered package.
+ * \param [in] policy      The policy to copy, or NULL to reset it to malloc.
+ */
+void                sc_memory_policy_set (int package,
+                                          const sc_memory_policy_t * policy);
+
+/** Query the memory policy of a package.
+ * \param [in] package     Must be -1 for the default package or
+ *                         the identifier of a registered package.
+ * \param [out] policy     Filled with the current policy of the package.
+ */
+void                sc_memory_policy_get (int package,
+                                          sc_memory_policy_t * policy);
+
+/** Allocate memory with a given policy instead of the package policy.
+ * The memory is counted for the package and released with sc_free.
+ * \param [in] package     Must be -1 for the default package or
+ *                         the identifier of a registered package.
+ * \param [in] size        Size in bytes of the allocation.
+ * \param [in] policy      Placement for this allocation only.
+ * \return                 Allocated memory; aborts if out of memory.
+ */
+void               *sc_malloc_policy (int package, size_t size,
+                                      const sc_memory_policy_t * policy);
+
 /* comparison functions for various integer sizes */
 
 int                 sc_int_compare (const void *v1, const void *v2);
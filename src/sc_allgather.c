@@ -23,6 +23,14 @@
 
 #include <sc_allgather.h>
 
+const char         *sc_allgather_mode_to_string[SC_ALLGATHER_NUM_MODES] = {
+  "auto",
+  "flat",
+  "node"
+};
+
+sc_allgather_mode_t sc_allgather_default_mode = SC_ALLGATHER_AUTO;
+
 void
 sc_allgather_alltoall (sc_MPI_Comm mpicomm, char *data, int datasize,
                        int groupsize, int myoffset, int myrank)
@@ -130,6 +138,87 @@ sc_allgather_recursive (sc_MPI_Comm mpicomm, char *data, int datasize,
   }
 }
 
+void
+sc_allgather_node (sc_MPI_Comm mpicomm, char *data, int datasize,
+                   sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  int                 intrarank, intrasize;
+  int                 interrank, intersize;
+  char               *nodedata, *mydata;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+  SC_CHECK_MPI (mpiret);
+
+  /* the node root gathers the node's block in place */
+  nodedata = data + (mpirank - intrarank) * datasize;
+  if (intrasize > 1) {
+    /* the send buffer must not alias the receive buffer on the root */
+    mydata = SC_ALLOC (char, datasize);
+    memcpy (mydata, nodedata + intrarank * datasize, datasize);
+    mpiret = sc_MPI_Gather (mydata, datasize, sc_MPI_BYTE,
+                            nodedata, datasize, sc_MPI_BYTE, 0, intranode);
+    SC_CHECK_MPI (mpiret);
+    SC_FREE (mydata);
+  }
+
+  /* the node roots exchange the node blocks */
+  if (intrarank == 0) {
+    mpiret = sc_MPI_Comm_rank (internode, &interrank);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Comm_size (internode, &intersize);
+    SC_CHECK_MPI (mpiret);
+    SC_ASSERT (mpirank == interrank * intrasize);
+    sc_allgather_recursive (internode, data, intrasize * datasize,
+                            intersize, interrank, interrank);
+  }
+
+  /* every node root broadcasts the result on its node */
+  if (intrasize > 1) {
+    mpiret = sc_MPI_Bcast (data, mpisize * datasize, sc_MPI_BYTE, 0,
+                           intranode);
+    SC_CHECK_MPI (mpiret);
+  }
+}
+
+sc_allgather_mode_t
+sc_allgather_get_mode (sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 mpisize, intrasize;
+  sc_MPI_Comm         intranode, internode;
+
+  if (sc_allgather_default_mode == SC_ALLGATHER_FLAT) {
+    return SC_ALLGATHER_FLAT;
+  }
+
+  /* the node algorithm requires attached node communicators
+     whose nodes are blocks of consecutive ranks */
+  sc_mpi_comm_get_node_comms (mpicomm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL ||
+      !sc_mpi_comm_node_comms_contiguous (mpicomm)) {
+    return SC_ALLGATHER_FLAT;
+  }
+  if (sc_allgather_default_mode == SC_ALLGATHER_NODE) {
+    return SC_ALLGATHER_NODE;
+  }
+
+  /* automatic choice: a single node or one process per node is flat */
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+  SC_CHECK_MPI (mpiret);
+  return (intrasize > 1 && intrasize < mpisize) ?
+    SC_ALLGATHER_NODE : SC_ALLGATHER_FLAT;
+}
+
 int
 sc_allgather (void *sendbuf, int sendcount, sc_MPI_Datatype sendtype,
               void *recvbuf, int recvcount, sc_MPI_Datatype recvtype,
@@ -139,6 +228,8 @@ sc_allgather (void *sendbuf, int sendcount, sc_MPI_Datatype sendtype,
   int                 mpisize;
   int                 mpirank;
   size_t              datasize;
+  sc_allgather_mode_t mode;
+  sc_MPI_Comm         intranode, internode;
 #ifdef SC_ENABLE_DEBUG
   size_t              datasize2;
 #endif
@@ -159,9 +250,158 @@ sc_allgather (void *sendbuf, int sendcount, sc_MPI_Datatype sendtype,
   mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
   SC_CHECK_MPI (mpiret);
 
+  mode = sc_allgather_get_mode (mpicomm);
+  SC_GLOBAL_LDEBUGF ("Allgather algorithm %s\n",
+                     sc_allgather_mode_to_string[mode]);
+
   memcpy (((char *) recvbuf) + mpirank * datasize, sendbuf, datasize);
-  sc_allgather_recursive (mpicomm, (char *) recvbuf, (int) datasize,
-                          mpisize, mpirank, mpirank);
+  if (mode == SC_ALLGATHER_NODE) {
+    sc_mpi_comm_get_node_comms (mpicomm, &intranode, &internode);
+    sc_allgather_node (mpicomm, (char *) recvbuf, (int) datasize,
+                       intranode, internode);
+  }
+  else {
+    sc_allgather_recursive (mpicomm, (char *) recvbuf, (int) datasize,
+                            mpisize, mpirank, mpirank);
+  }
+
+  return sc_MPI_SUCCESS;
+}
+
+struct sc_allgather_request
+{
+  int                 native;
+  sc_MPI_Comm         mpicomm;
+  int                 tag, rank, size;
+  int                 distance;
+  size_t              datasize;
+  char               *recvbuf, *work;
+  sc_MPI_Request      requests[2];
+};
+
+/** Post the messages of the Bruck round of the current distance.
+ * The work buffer holds the data of rank + i at position i.
+ */
+static void
+sc_iallgather_post_round (sc_allgather_request_t * req)
+{
+  int                 mpiret;
+  int                 dist = req->distance;
+  int                 num = SC_MIN (dist, req->size - dist);
+
+  mpiret = sc_MPI_Irecv (req->work + dist * req->datasize,
+                         num * (int) req->datasize, sc_MPI_BYTE,
+                         (req->rank + dist) % req->size, req->tag,
+                         req->mpicomm, req->requests + 0);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Isend (req->work, num * (int) req->datasize, sc_MPI_BYTE,
+                         (req->rank - dist + req->size) % req->size,
+                         req->tag, req->mpicomm, req->requests + 1);
+  SC_CHECK_MPI (mpiret);
+}
+
+/** Progress a request and free it on completion.
+ * \return True if the request has completed.
+ */
+static int
+sc_iallgather_progress (sc_allgather_request_t ** request, int block)
+{
+  int                 mpiret;
+  int                 flag;
+  int                 i;
+  sc_allgather_request_t *req = *request;
+
+  SC_ASSERT (req != NULL);
+  while (req->native || req->distance < req->size) {
+    if (block) {
+      mpiret = sc_MPI_Waitall (2, req->requests, sc_MPI_STATUSES_IGNORE);
+      SC_CHECK_MPI (mpiret);
+    }
+    else {
+      mpiret = sc_MPI_Testall (2, req->requests, &flag,
+                               sc_MPI_STATUSES_IGNORE);
+      SC_CHECK_MPI (mpiret);
+      if (!flag) {
+        return 0;
+      }
+    }
+    if (req->native) {
+      break;
+    }
+    req->distance *= 2;
+    if (req->distance < req->size) {
+      sc_iallgather_post_round (req);
+    }
+  }
+
+  /* rotate the work buffer into rank order */
+  if (req->work != NULL) {
+    for (i = 0; i < req->size; ++i) {
+      memcpy (req->recvbuf + ((req->rank + i) % req->size) * req->datasize,
+              req->work + i * req->datasize, req->datasize);
+    }
+    SC_FREE (req->work);
+  }
+  SC_FREE (req);
+  *request = NULL;
+  return 1;
+}
+
+int
+sc_iallgather (void *sendbuf, int sendcount, sc_MPI_Datatype sendtype,
+               void *recvbuf, int recvcount, sc_MPI_Datatype recvtype,
+               sc_MPI_Comm mpicomm, sc_allgather_request_t ** request)
+{
+  int                 mpiret;
+  sc_allgather_request_t *req;
+
+  SC_ASSERT (sendcount >= 0 && recvcount >= 0);
+  SC_ASSERT (request != NULL);
+
+  req = *request = SC_ALLOC_ZERO (sc_allgather_request_t, 1);
+  req->requests[0] = req->requests[1] = sc_MPI_REQUEST_NULL;
+#ifdef SC_ENABLE_MPINBC
+  req->native = 1;
+  mpiret = MPI_Iallgather (sendbuf, sendcount, sendtype, recvbuf,
+                           recvcount, recvtype, mpicomm, req->requests);
+  SC_CHECK_MPI (mpiret);
+#else
+  /* *INDENT-OFF* HORRIBLE indent bug */
+  req->datasize = (size_t) sendcount * sc_mpi_sizeof (sendtype);
+  /* *INDENT-ON* */
+  SC_ASSERT (req->datasize ==
+             (size_t) recvcount * sc_mpi_sizeof (recvtype));
+  req->mpicomm = mpicomm;
+  req->recvbuf = (char *) recvbuf;
+  mpiret = sc_MPI_Comm_size (mpicomm, &req->size);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &req->rank);
+  SC_CHECK_MPI (mpiret);
+
+  req->work = SC_ALLOC (char, req->size * req->datasize);
+  memcpy (req->work, sendbuf, req->datasize);
+  req->distance = 1;
+  if (req->size > 1) {
+    req->tag = sc_mpi_comm_get_nbc_tag (mpicomm);
+    sc_iallgather_post_round (req);
+  }
+#endif
+
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_iallgather_test (sc_allgather_request_t ** request, int *flag)
+{
+  *flag = sc_iallgather_progress (request, 0);
+
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_iallgather_wait (sc_allgather_request_t ** request)
+{
+  SC_EXECUTE_ASSERT_TRUE (sc_iallgather_progress (request, 1));
 
   return sc_MPI_SUCCESS;
 }
@@ -32,6 +32,23 @@
 
 SC_EXTERN_C_BEGIN;
 
+/** Algorithms used by sc_allgather. */
+typedef enum
+{
+  SC_ALLGATHER_AUTO,            /**< Use node communicators if attached
+                                     and contiguous. */
+  SC_ALLGATHER_FLAT,            /**< Recursive halving on all processes. */
+  SC_ALLGATHER_NODE,            /**< Gather on nodes, exchange between node
+                                     roots, broadcast on nodes. */
+  SC_ALLGATHER_NUM_MODES
+}
+sc_allgather_mode_t;
+
+extern const char  *sc_allgather_mode_to_string[SC_ALLGATHER_NUM_MODES];
+
+/** The algorithm requested by sc_allgather; may be changed at runtime. */
+extern sc_allgather_mode_t sc_allgather_default_mode;
+
 /** Allgather by direct point-to-point communication.
  * Only makes sense for small group sizes.
  */
@@ -46,13 +63,66 @@ void                sc_allgather_recursive (sc_MPI_Comm mpicomm, char *data,
                                             int datasize, int groupsize,
                                             int myoffset, int myrank);
 
+/** Allgather in three stages using the node communicators attached by
+ * sc_mpi_comm_attach_node_comms.  Processes of the same node must have
+ * contiguous ranks in \a mpicomm, as is the case for an explicit number of
+ * processes per node.  Only the node roots communicate between nodes.
+ * \param [in,out] data     Buffer of groupsize * datasize bytes that holds
+ *                          the local contribution at the position of the
+ *                          rank and all contributions on output.
+ */
+void                sc_allgather_node (sc_MPI_Comm mpicomm, char *data,
+                                       int datasize,
+                                       sc_MPI_Comm intranode,
+                                       sc_MPI_Comm internode);
+
+/** Return the algorithm that sc_allgather uses on a communicator.
+ * This resolves SC_ALLGATHER_AUTO and falls back to SC_ALLGATHER_FLAT
+ * when no usable node communicators are attached, including the case
+ * that the nodes are not blocks of consecutive ranks, which is checked
+ * once by sc_mpi_comm_attach_node_comms.
+ */
+sc_allgather_mode_t sc_allgather_get_mode (sc_MPI_Comm mpicomm);
+
 /** Drop-in allgather replacement.
+ * The algorithm is chosen by sc_allgather_get_mode and logged.
  */
 int                 sc_allgather (void *sendbuf, int sendcount,
                                   sc_MPI_Datatype sendtype, void *recvbuf,
                                   int recvcount, sc_MPI_Datatype recvtype,
                                   sc_MPI_Comm mpicomm);
 
+/** Opaque handle of a nonblocking allgather. */
+typedef struct sc_allgather_request sc_allgather_request_t;
+
+/** Start a nonblocking allgather.
+ * Maps to MPI_Iallgather if MPI provides it.  Otherwise the Bruck
+ * algorithm exchanges point-to-point messages in ceil (log2 (P)) rounds
+ * that advance on every call to sc_iallgather_test or sc_iallgather_wait.
+ * Nonblocking collectives must be started in the same order on all
+ * processes of the communicator.  The buffers must not be accessed until
+ * the request has completed.
+ * \param [out] request    Handle to be passed to sc_iallgather_test or
+ *                         sc_iallgather_wait.  Set to NULL on completion.
+ */
+int                 sc_iallgather (void *sendbuf, int sendcount,
+                                   sc_MPI_Datatype sendtype, void *recvbuf,
+                                   int recvcount, sc_MPI_Datatype recvtype,
+                                   sc_MPI_Comm mpicomm,
+                                   sc_allgather_request_t ** request);
+
+/** Progress a nonblocking allgather without blocking.
+ * \param [in,out] request On completion, the request is freed and NULL.
+ * \param [out] flag       True if the allgather has completed.
+ */
+int                 sc_iallgather_test (sc_allgather_request_t ** request,
+                                        int *flag);
+
+/** Complete a nonblocking allgather.
+ * \param [in,out] request Freed and set to NULL.
+ */
+int                 sc_iallgather_wait (sc_allgather_request_t ** request);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_ALLGATHER_H */
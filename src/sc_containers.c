@@ -25,12 +25,24 @@
 #ifdef SC_HAVE_ZLIB
 #include <zlib.h>
 #endif
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+#if defined (__AVX2__)
+#include <immintrin.h>
+#elif defined (__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /* array routines */
 
 size_t
 sc_array_memory_used (sc_array_t * array, int is_dynamic)
 {
+  if (array->arena != NULL) {
+    /* the memory is counted by sc_arena_memory_used */
+    return 0;
+  }
   return (is_dynamic ? sizeof (sc_array_t) : 0) +
     (SC_ARRAY_IS_OWNER (array) ? array->byte_alloc : 0);
 }
@@ -83,9 +95,28 @@ sc_array_new_data (void *base, size_t elem_size, size_t elem_count)
   return view;
 }
 
+sc_array_t         *
+sc_array_new_arena (size_t elem_size, size_t elem_count, sc_arena_t * arena)
+{
+  sc_array_t         *array;
+
+  if (arena == NULL) {
+    return sc_array_new_count (elem_size, elem_count);
+  }
+  array = (sc_array_t *) sc_arena_alloc (arena, sizeof (sc_array_t));
+
+  sc_array_init_arena (array, elem_size, elem_count, arena);
+
+  return array;
+}
+
 void
 sc_array_destroy (sc_array_t * array)
 {
+  if (array->arena != NULL) {
+    /* the memory is released with the arena */
+    return;
+  }
   if (SC_ARRAY_IS_OWNER (array)) {
     SC_FREE (array->array);
   }
@@ -101,6 +132,8 @@ sc_array_init (sc_array_t * array, size_t elem_size)
   array->elem_count = 0;
   array->byte_alloc = 0;
   array->array = NULL;
+  array->arena = NULL;
+  array->growth = NULL;
 }
 
 void
@@ -112,6 +145,27 @@ sc_array_init_size (sc_array_t * array, size_t elem_size, size_t elem_count)
   array->elem_count = elem_count;
   array->byte_alloc = (ssize_t) (elem_size * elem_count);
   array->array = SC_ALLOC (char, (size_t) array->byte_alloc);
+  array->arena = NULL;
+  array->growth = NULL;
+}
+
+void
+sc_array_init_arena (sc_array_t * array, size_t elem_size, size_t elem_count,
+                     sc_arena_t * arena)
+{
+  SC_ASSERT (elem_size > 0);
+
+  if (arena == NULL) {
+    sc_array_init_size (array, elem_size, elem_count);
+    return;
+  }
+  array->elem_size = elem_size;
+  array->elem_count = elem_count;
+  array->byte_alloc = (ssize_t) (elem_size * elem_count);
+  array->array = elem_count == 0 ? NULL :
+    (char *) sc_arena_alloc (arena, (size_t) array->byte_alloc);
+  array->arena = arena;
+  array->growth = NULL;
 }
 
 void
@@ -124,6 +178,8 @@ sc_array_init_view (sc_array_t * view, sc_array_t * array, size_t offset,
   view->elem_count = length;
   view->byte_alloc = -(ssize_t) (length * array->elem_size + 1);
   view->array = array->array + offset * array->elem_size;
+  view->arena = NULL;
+  view->growth = NULL;
 }
 
 void
@@ -136,12 +192,14 @@ sc_array_init_data (sc_array_t * view, void *base, size_t elem_size,
   view->elem_count = elem_count;
   view->byte_alloc = -(ssize_t) (elem_count * elem_size + 1);
   view->array = (char *) base;
+  view->arena = NULL;
+  view->growth = NULL;
 }
 
 void
 sc_array_reset (sc_array_t * array)
 {
-  if (SC_ARRAY_IS_OWNER (array)) {
+  if (SC_ARRAY_IS_OWNER (array) && array->arena == NULL) {
     SC_FREE (array->array);
   }
   array->array = NULL;
@@ -169,26 +227,158 @@ sc_array_rewind (sc_array_t * array, size_t new_count)
   SC_ASSERT (array != NULL);
   SC_ASSERT (array->elem_count >= new_count);
 
-  if (new_count == 0 && SC_ARRAY_IS_OWNER (array)) {
+  if (new_count == 0 && SC_ARRAY_IS_OWNER (array) && array->growth == NULL) {
     sc_array_reset (array);
   }
   else {
+#ifdef SC_ENABLE_DEBUG
+    /* sc_array_resize expects unused memory of the allocation to be -1 */
+    if (SC_ARRAY_IS_OWNER (array)) {
+      memset (array->array + new_count * array->elem_size, -1,
+              (array->elem_count - new_count) * array->elem_size);
+    }
+#endif
     array->elem_count = new_count;
   }
 }
 
-void
-sc_array_resize (sc_array_t * array, size_t new_count)
+/** Compute the allocation in bytes that a growth policy chooses for an
+ * array whose byte size changes to newoffs.
+ * \return      The new allocation, or the current one if it is kept.
+ */
+static size_t
+sc_array_growth_bytes (const sc_array_t * array, size_t newoffs)
 {
-  size_t              newoffs, roundup, newsize;
-#if !defined SC_ENABLE_USE_REALLOC || defined SC_ENABLE_DEBUG
-  size_t              oldoffs, minoffs;
-#endif
-#ifndef SC_ENABLE_USE_REALLOC
+  const sc_array_growth_t *growth = array->growth;
+  const size_t        byte_alloc = (size_t) array->byte_alloc;
+  size_t              target;
+
+  if (growth == NULL) {
+    /* grow or shrink to the next power of two */
+    target = (size_t) SC_ROUNDUP2_64 (newoffs);
+    SC_ASSERT (target >= newoffs && target <= 2 * newoffs);
+    return newoffs > byte_alloc || target < byte_alloc ? target : byte_alloc;
+  }
+  if (newoffs <= byte_alloc &&
+      (growth->shrink <= 0 ||
+       newoffs > byte_alloc / (size_t) growth->shrink)) {
+    return byte_alloc;
+  }
+  if (newoffs == 0) {
+    return 0;
+  }
+
+  switch (growth->type) {
+  case SC_ARRAY_GROWTH_POW2:
+    target = (size_t) SC_ROUNDUP2_64 (newoffs);
+    break;
+  case SC_ARRAY_GROWTH_GEOMETRIC:
+    SC_ASSERT (growth->factor > 1.);
+    target = (size_t) (growth->factor *
+                       (newoffs > byte_alloc ? byte_alloc : newoffs));
+    target = SC_MAX (target, newoffs);
+    break;
+  case SC_ARRAY_GROWTH_CHUNK:
+    SC_ASSERT (growth->chunk > 0);
+    target = SC_ALIGN_UP (newoffs, growth->chunk * array->elem_size);
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+
+  /* shrinking must not increase the allocation */
+  return newoffs > byte_alloc ? target : SC_MIN (target, byte_alloc);
+}
+
+/* Buffers of at least this many bytes are always reallocated in place,
+ * which lets the C library remap large blocks instead of copying them. */
+#define SC_ARRAY_REALLOC_BYTES ((size_t) 1 << 20)
+
+/** Change the allocation of an array that owns its memory.
+ * The elements that fit into the new allocation are preserved.
+ * \param [in,out] array    Its byte_alloc is set to newsize.
+ * \param [in] newsize      New allocation in bytes, may be zero.
+ */
+static void
+sc_array_reallocate (sc_array_t * array, size_t newsize)
+{
+  size_t              minoffs;
   char               *ptr;
+
+  SC_ASSERT (SC_ARRAY_IS_OWNER (array));
+
+  minoffs = SC_MIN (array->elem_count * array->elem_size, newsize);
+  if (array->arena != NULL) {
+    /* the old memory stays in the arena until it is rewound */
+    ptr = newsize == 0 ? NULL : (char *) sc_arena_alloc (array->arena,
+                                                          newsize);
+    memcpy (ptr, array->array, minoffs);
+    array->array = ptr;
+  }
+  else if (newsize == 0) {
+    SC_FREE (array->array);
+    array->array = NULL;
+  }
+  else {
+#ifndef SC_ENABLE_USE_REALLOC
+    if (newsize < SC_ARRAY_REALLOC_BYTES) {
+      ptr = SC_ALLOC (char, newsize);
+      memcpy (ptr, array->array, minoffs);
+      SC_FREE (array->array);
+      array->array = ptr;
+    }
+    else
 #endif
+    {
+      array->array = SC_REALLOC (array->array, char, newsize);
+    }
+  }
+  array->byte_alloc = (ssize_t) newsize;
+
 #ifdef SC_ENABLE_DEBUG
-  size_t              i;
+  SC_ASSERT (minoffs <= newsize);
+  memset (array->array + minoffs, -1, newsize - minoffs);
+#endif
+}
+
+void
+sc_array_set_growth (sc_array_t * array, const sc_array_growth_t * growth)
+{
+  SC_ASSERT (SC_ARRAY_IS_OWNER (array));
+
+  array->growth = growth;
+}
+
+void
+sc_array_reserve (sc_array_t * array, size_t elem_count)
+{
+  const size_t        newsize = elem_count * array->elem_size;
+
+  SC_ASSERT (SC_ARRAY_IS_OWNER (array));
+
+  if (newsize > (size_t) array->byte_alloc) {
+    sc_array_reallocate (array, newsize);
+  }
+}
+
+void
+sc_array_shrink_to_fit (sc_array_t * array)
+{
+  const size_t        newsize = array->elem_count * array->elem_size;
+
+  SC_ASSERT (SC_ARRAY_IS_OWNER (array));
+
+  if (array->arena == NULL && newsize < (size_t) array->byte_alloc) {
+    sc_array_reallocate (array, newsize);
+  }
+}
+
+void
+sc_array_resize (sc_array_t * array, size_t new_count)
+{
+  size_t              newoffs, newsize;
+#ifdef SC_ENABLE_DEBUG
+  size_t              oldoffs, i;
 #endif
 
   if (!SC_ARRAY_IS_OWNER (array)) {
@@ -201,56 +391,39 @@ sc_array_resize (sc_array_t * array, size_t new_count)
   }
 
   /* We know that this array is not a view now so we can call reset. */
-  if (new_count == 0) {
+  if (new_count == 0 && array->growth == NULL) {
     sc_array_reset (array);
     return;
   }
 
   /* Figure out how the array size will change */
   newoffs = new_count * array->elem_size;
-#if defined SC_ENABLE_DEBUG || !defined SC_ENABLE_USE_REALLOC
-  oldoffs = array->elem_count * array->elem_size;
-  minoffs = SC_MIN (oldoffs, newoffs);
-#endif
-  array->elem_count = new_count;
-  roundup = (size_t) SC_ROUNDUP2_64 (newoffs);
-  SC_ASSERT (roundup >= newoffs && roundup <= 2 * newoffs);
+  newsize = sc_array_growth_bytes (array, newoffs);
+  SC_ASSERT (newsize >= newoffs);
+  if (array->arena != NULL && newoffs <= (size_t) array->byte_alloc) {
+    /* arena memory is never given back before the arena is rewound */
+    newsize = (size_t) array->byte_alloc;
+  }
 
-  if (newoffs > (size_t) array->byte_alloc ||
-      roundup < (size_t) array->byte_alloc) {
+  if (newsize != (size_t) array->byte_alloc) {
     /* we will reallocate the array memory, either grow or shrink it */
-    array->byte_alloc = (ssize_t) roundup;
-  }
-  else {
-#ifdef SC_ENABLE_DEBUG
-    if (newoffs < oldoffs) {
-      memset (array->array + newoffs, -1, oldoffs - newoffs);
-    }
-    for (i = oldoffs; i < newoffs; ++i) {
-      SC_ASSERT (array->array[i] == (char) -1);
-    }
-#endif
-    /* we keep the current allocation */
+    array->elem_count = SC_MIN (array->elem_count, new_count);
+    sc_array_reallocate (array, newsize);
+    array->elem_count = new_count;
     return;
   }
 
-  /* byte_alloc is the size to be realloced to, it may be smaller than oldoffs */
-  SC_ASSERT ((size_t) array->byte_alloc >= newoffs);
-
-  newsize = (size_t) array->byte_alloc;
-#ifdef SC_ENABLE_USE_REALLOC
-  array->array = SC_REALLOC (array->array, char, newsize);
-#else
-  ptr = SC_ALLOC (char, newsize);
-  memcpy (ptr, array->array, minoffs);
-  SC_FREE (array->array);
-  array->array = ptr;
-#endif
-
 #ifdef SC_ENABLE_DEBUG
-  SC_ASSERT (minoffs <= newsize);
-  memset (array->array + minoffs, -1, newsize - minoffs);
+  oldoffs = array->elem_count * array->elem_size;
+  if (newoffs < oldoffs) {
+    memset (array->array + newoffs, -1, oldoffs - newoffs);
+  }
+  for (i = oldoffs; i < newoffs; ++i) {
+    SC_ASSERT (array->array[i] == (char) -1);
+  }
 #endif
+  /* we keep the current allocation */
+  array->elem_count = new_count;
 }
 
 void
@@ -263,12 +436,337 @@ sc_array_copy (sc_array_t * dest, sc_array_t * src)
   memcpy (dest->array, src->array, src->elem_count * src->elem_size);
 }
 
+void               *
+sc_array_append_data (sc_array_t * array, const void *data, size_t count)
+{
+  const size_t        old_count = array->elem_count;
+  const size_t        old_bytes = old_count * array->elem_size;
+  const char         *src = (const char *) data;
+  char               *dest;
+
+  if (count == 0) {
+    return array->array + old_bytes;
+  }
+  if (old_bytes > 0 && src >= array->array && src < array->array + old_bytes) {
+    /* the source moves along with the array */
+    const size_t        offset = (size_t) (src - array->array);
+
+    SC_ASSERT (offset + count * array->elem_size <= old_bytes);
+    sc_array_resize (array, old_count + count);
+    src = array->array + offset;
+  }
+  else {
+    sc_array_resize (array, old_count + count);
+  }
+  dest = array->array + old_bytes;
+  memcpy (dest, src, count * array->elem_size);
+
+  return dest;
+}
+
+void               *
+sc_array_append (sc_array_t * dest, sc_array_t * src)
+{
+  SC_ASSERT (dest->elem_size == src->elem_size);
+
+  return sc_array_append_data (dest, src->array, src->elem_count);
+}
+
+void               *
+sc_array_insert_range (sc_array_t * array, size_t position, size_t count,
+                       const void *data)
+{
+  const size_t        old_count = array->elem_count;
+  const size_t        elem_size = array->elem_size;
+  char               *dest;
+
+  SC_ASSERT (position <= old_count);
+
+  sc_array_resize (array, old_count + count);
+  dest = array->array + position * elem_size;
+  if (count > 0) {
+    SC_ASSERT (data == NULL ||
+               (const char *) data + count * elem_size <= array->array ||
+               (const char *) data >= array->array + old_count * elem_size);
+    memmove (dest + count * elem_size, dest,
+             (old_count - position) * elem_size);
+    if (data != NULL) {
+      memcpy (dest, data, count * elem_size);
+    }
+  }
+
+  return dest;
+}
+
+void
+sc_array_erase_range (sc_array_t * array, size_t position, size_t count)
+{
+  const size_t        elem_size = array->elem_size;
+  char               *dest;
+
+  SC_ASSERT (position + count <= array->elem_count);
+
+  if (count == 0) {
+    return;
+  }
+  dest = array->array + position * elem_size;
+  memmove (dest, dest + count * elem_size,
+           (array->elem_count - position - count) * elem_size);
+  sc_array_resize (array, array->elem_count - count);
+}
+
+size_t
+sc_array_erase_if (sc_array_t * array,
+                   int (*predicate) (const void *elem, void *user),
+                   void *user)
+{
+  const size_t        incount = array->elem_count;
+  const size_t        elem_size = array->elem_size;
+  size_t              i, j, run;
+
+  /* j counts the kept elements, i scans for runs of them;
+     the predicate is called exactly once per element */
+  i = j = 0;
+  while (i < incount) {
+    if (predicate (array->array + i * elem_size, user)) {
+      ++i;
+      continue;
+    }
+    for (run = i + 1; run < incount &&
+         !predicate (array->array + run * elem_size, user); ++run) {
+    }
+    if (i > j) {
+      memmove (array->array + j * elem_size, array->array + i * elem_size,
+               (run - i) * elem_size);
+    }
+    j += run - i;
+
+    /* the element ending the run, if any, is to be removed */
+    i = run < incount ? run + 1 : run;
+  }
+  SC_ASSERT (j <= incount);
+  if (j < incount) {
+    sc_array_resize (array, j);
+  }
+
+  return incount - j;
+}
+
 void
 sc_array_sort (sc_array_t * array, int (*compar) (const void *, const void *))
 {
   qsort (array->array, array->elem_count, array->elem_size, compar);
 }
 
+/** Key and original position of an element during radix sort. */
+typedef struct sc_array_radix
+{
+  uint64_t            key;
+  size_t              index;
+}
+sc_array_radix_t;
+
+/** Read a key and map it to an unsigned value of the same order.
+ * Signed keys have their sign bit flipped.
+ */
+static inline       uint64_t
+sc_array_radix_get (const char *p, size_t key_size, int is_signed)
+{
+  uint8_t             u8;
+  uint16_t            u16;
+  uint32_t            u32;
+  uint64_t            u64;
+
+  switch (key_size) {
+  case 1:
+    memcpy (&u8, p, 1);
+    return is_signed ? (uint64_t) (u8 ^ 0x80U) : (uint64_t) u8;
+  case 2:
+    memcpy (&u16, p, 2);
+    return is_signed ? (uint64_t) (u16 ^ 0x8000U) : (uint64_t) u16;
+  case 4:
+    memcpy (&u32, p, 4);
+    return is_signed ? (uint64_t) (u32 ^ 0x80000000U) : (uint64_t) u32;
+  default:
+    SC_ASSERT (key_size == 8);
+    memcpy (&u64, p, 8);
+    return is_signed ? u64 ^ 0x8000000000000000ULL : u64;
+  }
+}
+
+/** Inverse of sc_array_radix_get. */
+static inline void
+sc_array_radix_set (char *p, uint64_t key, size_t key_size, int is_signed)
+{
+  uint8_t             u8;
+  uint16_t            u16;
+  uint32_t            u32;
+
+  switch (key_size) {
+  case 1:
+    u8 = (uint8_t) (is_signed ? key ^ 0x80U : key);
+    memcpy (p, &u8, 1);
+    break;
+  case 2:
+    u16 = (uint16_t) (is_signed ? key ^ 0x8000U : key);
+    memcpy (p, &u16, 2);
+    break;
+  case 4:
+    u32 = (uint32_t) (is_signed ? key ^ 0x80000000U : key);
+    memcpy (p, &u32, 4);
+    break;
+  default:
+    SC_ASSERT (key_size == 8);
+    key = is_signed ? key ^ 0x8000000000000000ULL : key;
+    memcpy (p, &key, 8);
+  }
+}
+
+/** Reorder an array such that position i receives old position index[i]. */
+static void
+sc_array_radix_gather (sc_array_t * array, const sc_array_radix_t * sorted)
+{
+  const size_t        n = array->elem_count;
+  const size_t        es = array->elem_size;
+  size_t              zz;
+  char               *temp;
+
+  temp = SC_ALLOC (char, n * es);
+  for (zz = 0; zz < n; ++zz) {
+    memcpy (temp + zz * es, array->array + sorted[zz].index * es, es);
+  }
+  memcpy (array->array, temp, n * es);
+  SC_FREE (temp);
+}
+
+/** Count the digits of all passes at once.
+ * \param [in] stride  Distance in bytes between consecutive keys.
+ * \return     Array of 256 counters for each byte of the key.
+ */
+static size_t      (*sc_array_radix_count (const uint64_t * keys,
+                                            size_t stride, size_t n,
+                                            size_t key_size))[256]
+{
+  size_t              zz, b;
+  uint64_t            key;
+  size_t            (*count)[256];
+
+  count = (size_t (*)[256]) SC_ALLOC_ZERO (size_t, 256 * key_size);
+  for (zz = 0; zz < n; ++zz) {
+    key = *(const uint64_t *) ((const char *) keys + zz * stride);
+    for (b = 0; b < key_size; ++b) {
+      ++count[b][(key >> (8 * b)) & 0xff];
+    }
+  }
+  return count;
+}
+
+/** Turn the counters of one pass into offsets.
+ * \return     False if all keys share the same digit in this pass.
+ */
+static int
+sc_array_radix_offsets (size_t * count, size_t n, uint64_t first, size_t b)
+{
+  size_t              digit, sum, c;
+
+  if (count[(first >> (8 * b)) & 0xff] == n) {
+    return 0;
+  }
+  for (sum = 0, digit = 0; digit < 256; ++digit) {
+    c = count[digit];
+    count[digit] = sum;
+    sum += c;
+  }
+  return 1;
+}
+
+void
+sc_array_sort_radix_payload (sc_array_t * array, size_t key_offset,
+                             size_t key_size, int is_signed,
+                             sc_array_t * payload)
+{
+  const size_t        n = array->elem_count;
+  const size_t        es = array->elem_size;
+  size_t              zz, b;
+  size_t            (*count)[256];
+  uint64_t           *ksrc, *kdst, *kswap;
+  sc_array_radix_t   *src, *dst, *swap;
+
+  SC_ASSERT (key_size == 1 || key_size == 2 || key_size == 4 ||
+             key_size == 8);
+  SC_ASSERT (key_offset + key_size <= es);
+  SC_ASSERT (payload == NULL || payload->elem_count == n);
+
+  if (n <= 1) {
+    return;
+  }
+
+  if (payload == NULL && key_offset == 0 && key_size == es) {
+    /* the elements are the keys: no positions need to be tracked */
+    ksrc = SC_ALLOC (uint64_t, n);
+    kdst = SC_ALLOC (uint64_t, n);
+    for (zz = 0; zz < n; ++zz) {
+      ksrc[zz] = sc_array_radix_get (array->array + zz * es, key_size,
+                                     is_signed);
+    }
+    count = sc_array_radix_count (ksrc, sizeof (uint64_t), n, key_size);
+    for (b = 0; b < key_size; ++b) {
+      if (sc_array_radix_offsets (count[b], n, ksrc[0], b)) {
+        for (zz = 0; zz < n; ++zz) {
+          kdst[count[b][(ksrc[zz] >> (8 * b)) & 0xff]++] = ksrc[zz];
+        }
+        kswap = ksrc;
+        ksrc = kdst;
+        kdst = kswap;
+      }
+    }
+    for (zz = 0; zz < n; ++zz) {
+      sc_array_radix_set (array->array + zz * es, ksrc[zz], key_size,
+                          is_signed);
+    }
+    SC_FREE (count);
+    SC_FREE (kdst);
+    SC_FREE (ksrc);
+    return;
+  }
+
+  /* sort pairs of key and position, then move the elements once */
+  src = SC_ALLOC (sc_array_radix_t, n);
+  dst = SC_ALLOC (sc_array_radix_t, n);
+  for (zz = 0; zz < n; ++zz) {
+    src[zz].key = sc_array_radix_get (array->array + zz * es + key_offset,
+                                      key_size, is_signed);
+    src[zz].index = zz;
+  }
+  count = sc_array_radix_count (&src[0].key, sizeof (sc_array_radix_t),
+                                n, key_size);
+  for (b = 0; b < key_size; ++b) {
+    if (sc_array_radix_offsets (count[b], n, src[0].key, b)) {
+      for (zz = 0; zz < n; ++zz) {
+        dst[count[b][(src[zz].key >> (8 * b)) & 0xff]++] = src[zz];
+      }
+      swap = src;
+      src = dst;
+      dst = swap;
+    }
+  }
+  sc_array_radix_gather (array, src);
+  if (payload != NULL) {
+    sc_array_radix_gather (payload, src);
+  }
+
+  SC_FREE (count);
+  SC_FREE (dst);
+  SC_FREE (src);
+}
+
+void
+sc_array_sort_radix (sc_array_t * array, size_t key_offset,
+                     size_t key_size, int is_signed)
+{
+  sc_array_sort_radix_payload (array, key_offset, key_size, is_signed, NULL);
+}
+
 int
 sc_array_is_sorted (sc_array_t * array,
                     int (*compar) (const void *, const void *))
@@ -343,70 +841,446 @@ sc_array_uniq (sc_array_t * array, int (*compar) (const void *, const void *))
   sc_array_resize (array, j);
 }
 
-ssize_t
-sc_array_bsearch (sc_array_t * array, const void *key,
-                  int (*compar) (const void *, const void *))
-{
-  ssize_t             is = -1;
-  char               *retval;
-
-  retval = (char *)
-    bsearch (key, array->array, array->elem_count, array->elem_size, compar);
+/** Function run by each thread of sc_array_run_threads. */
+typedef void        (*sc_array_thread_fn_t) (void *data, int thread_id);
 
-  if (retval != NULL) {
-    is = (ssize_t) ((retval - array->array) / array->elem_size);
-    SC_ASSERT (is >= 0 && is < (ssize_t) array->elem_count);
-  }
+#ifdef SC_ENABLE_PTHREAD
 
-  return is;
+typedef struct sc_array_thread
+{
+  pthread_t           thread;
+  int                 thread_id;
+  sc_array_thread_fn_t fn;
+  void               *data;
 }
+sc_array_thread_t;
 
-void
-sc_array_split (sc_array_t * array, sc_array_t * offsets, size_t num_types,
-                sc_array_type_t type_fn, void *data)
+static void        *
+sc_array_thread_start (void *v)
 {
-  const size_t        count = array->elem_count;
-  size_t              zi, *zp;
-  size_t              guess, low, high, type, step;
+  sc_array_thread_t  *td = (sc_array_thread_t *) v;
 
-  SC_ASSERT (offsets->elem_size == sizeof (size_t));
+  td->fn (td->data, td->thread_id);
+  return v;
+}
 
-  sc_array_resize (offsets, num_types + 1);
+#endif /* SC_ENABLE_PTHREAD */
 
-  /** The point of this algorithm is to put offsets[i] into its final position
-   * for i = 0,...,num_types, where the final position of offsets[i] is the
-   * unique index k such that type_fn (array, j, data) < i for all j < k
-   * and type_fn (array, j, data) >= i for all j >= k.
-   *
-   * The invariants of the loop are:
-   *  1) if i < step, then offsets[i] <= low, and offsets[i] is final.
-   *  2) if i >= step, then low is less than or equal to the final value of
-   *     offsets[i].
-   *  3) for 0 <= i <= num_types, offsets[i] is greater than or equal to its
-   *     final value.
-   *  4) for every index k in the array with k < low,
-   *     type_fn (array, k, data) < step,
-   *  5) for 0 <= i < num_types,
-   *     for every index k in the array with k >= offsets[i],
-   *     type_fn (array, k, data) >= i.
-   *  6) if i < j, offsets[i] <= offsets[j].
-   *
-   * Initializing offsets[0] = 0, offsets[i] = count for i > 0,
-   * low = 0, and step = 1, the invariants are trivially satisfied.
-   */
-  zp = (size_t *) sc_array_index (offsets, 0);
-  *zp = 0;
-  for (zi = 1; zi <= num_types; zi++) {
-    zp = (size_t *) sc_array_index (offsets, zi);
-    *zp = count;
-  }
+/** Run a function on a number of threads and wait for all of them.
+ * The calling thread runs thread id 0.  Without --enable-pthread we use
+ * OpenMP if the library is compiled with it, and run serially otherwise.
+ */
+static void
+sc_array_run_threads (int num_threads, sc_array_thread_fn_t fn, void *data)
+{
+  int                 i;
+#if defined (SC_ENABLE_PTHREAD)
+  int                 pth;
+  void               *exitval;
+  sc_array_thread_t  *td;
 
-  if (count == 0 || num_types <= 1) {
+  SC_ASSERT (num_threads >= 1);
+  if (num_threads == 1) {
+    fn (data, 0);
     return;
   }
 
-  /** Because count > 0 we can add another invariant:
-   *   7) if step < num_types, low < high = offsets[step].
+  td = SC_ALLOC (sc_array_thread_t, num_threads);
+  for (i = 1; i < num_threads; ++i) {
+    td[i].thread_id = i;
+    td[i].fn = fn;
+    td[i].data = data;
+    pth = pthread_create (&td[i].thread, NULL, sc_array_thread_start, &td[i]);
+    SC_CHECK_ABORTF (pth == 0, "pthread_create error %d", pth);
+  }
+  fn (data, 0);
+  for (i = 1; i < num_threads; ++i) {
+    pth = pthread_join (td[i].thread, &exitval);
+    SC_CHECK_ABORT (pth == 0, "Fail in pthread_join");
+    SC_ASSERT (exitval == &td[i]);
+  }
+  SC_FREE (td);
+#elif defined (SC_ENABLE_OPENMP) && defined (_OPENMP)
+  SC_ASSERT (num_threads >= 1);
+#pragma omp parallel for num_threads (num_threads) schedule (static, 1)
+  for (i = 0; i < num_threads; ++i) {
+    fn (data, i);
+  }
+#else
+  SC_ASSERT (num_threads >= 1);
+  for (i = 0; i < num_threads; ++i) {
+    fn (data, i);
+  }
+#endif
+}
+
+/** Shared state of the threaded array algorithms. */
+typedef struct sc_array_threaded
+{
+  sc_array_t         *array;
+  int                 (*compar) (const void *, const void *);
+  int                 num_threads;
+  size_t              run_width;        /**< number of chunks per sorted run */
+  char               *src, *dst;
+  size_t             *counts;   /**< one entry per thread */
+  int                *results;  /**< one entry per thread */
+  size_t              num_types;        /**< for split: types per thread */
+  sc_array_type_t     type_fn;
+  void               *type_data;
+  const size_t       *newind;   /**< for permute: new positions */
+}
+sc_array_threaded_t;
+
+/** First element of a chunk when splitting n elements into equal parts. */
+static inline size_t
+sc_array_chunk (size_t n, int k, int num_chunks)
+{
+  return (size_t) (((uint64_t) n * (uint64_t) k) / (uint64_t) num_chunks);
+}
+
+static void
+sc_array_sort_chunk (void *data, int thread_id)
+{
+  sc_array_threaded_t *st = (sc_array_threaded_t *) data;
+  const size_t        n = st->array->elem_count;
+  const size_t        begin = sc_array_chunk (n, thread_id, st->num_threads);
+  const size_t        end = sc_array_chunk (n, thread_id + 1,
+                                            st->num_threads);
+
+  qsort (st->array->array + begin * st->array->elem_size, end - begin,
+         st->array->elem_size, st->compar);
+}
+
+/** Find how many elements of run a precede position k of the stable merge
+ * of runs a and b.  Ties are taken from a first.
+ */
+static size_t
+sc_array_merge_corank (size_t k, const char *a, size_t na,
+                       const char *b, size_t nb, size_t es,
+                       int (*compar) (const void *, const void *))
+{
+  size_t              lo, hi, i, j;
+
+  lo = k > nb ? k - nb : 0;
+  hi = SC_MIN (k, na);
+  for (;;) {
+    i = lo + (hi - lo) / 2;
+    j = k - i;
+    if (i > 0 && j < nb && compar (a + (i - 1) * es, b + j * es) > 0) {
+      hi = i - 1;
+    }
+    else if (j > 0 && i < na && compar (b + (j - 1) * es, a + i * es) >= 0) {
+      lo = i + 1;
+    }
+    else {
+      return i;
+    }
+  }
+}
+
+static void
+sc_array_merge_range (char *dst, const char *a, size_t na,
+                      const char *b, size_t nb, size_t es,
+                      int (*compar) (const void *, const void *))
+{
+  size_t              i = 0, j = 0;
+
+  while (i < na && j < nb) {
+    if (compar (a + i * es, b + j * es) <= 0) {
+      memcpy (dst, a + i * es, es);
+      ++i;
+    }
+    else {
+      memcpy (dst, b + j * es, es);
+      ++j;
+    }
+    dst += es;
+  }
+  memcpy (dst, a + i * es, (na - i) * es);
+  memcpy (dst + (na - i) * es, b + j * es, (nb - j) * es);
+}
+
+/** Each thread produces an equal share of the output of one merge round.
+ * Its output range may span parts of several merges of adjacent runs.
+ */
+static void
+sc_array_merge_round (void *data, int thread_id)
+{
+  sc_array_threaded_t *st = (sc_array_threaded_t *) data;
+  const int           T = st->num_threads;
+  const size_t        w = st->run_width;
+  const size_t        n = st->array->elem_count;
+  const size_t        es = st->array->elem_size;
+  const size_t        out_begin = sc_array_chunk (n, thread_id, T);
+  const size_t        out_end = sc_array_chunk (n, thread_id + 1, T);
+  size_t              k, lo, mid, hi;
+  size_t              o1, o2, i1, i2;
+
+  for (k = 0; k < (size_t) T; k += 2 * w) {
+    /* the merge of runs [lo, mid) and [mid, hi) */
+    lo = sc_array_chunk (n, (int) k, T);
+    mid = sc_array_chunk (n, (int) SC_MIN (k + w, (size_t) T), T);
+    hi = sc_array_chunk (n, (int) SC_MIN (k + 2 * w, (size_t) T), T);
+    o1 = SC_MAX (lo, out_begin);
+    o2 = SC_MIN (hi, out_end);
+    if (o1 >= o2) {
+      continue;
+    }
+    i1 = sc_array_merge_corank (o1 - lo, st->src + lo * es, mid - lo,
+                                st->src + mid * es, hi - mid, es,
+                                st->compar);
+    i2 = sc_array_merge_corank (o2 - lo, st->src + lo * es, mid - lo,
+                                st->src + mid * es, hi - mid, es,
+                                st->compar);
+    sc_array_merge_range (st->dst + o1 * es,
+                          st->src + (lo + i1) * es, i2 - i1,
+                          st->src + (mid + (o1 - lo - i1)) * es,
+                          (o2 - o1) - (i2 - i1), es, st->compar);
+  }
+}
+
+void
+sc_array_sort_threaded (sc_array_t * array,
+                        int (*compar) (const void *, const void *),
+                        int num_threads)
+{
+  const size_t        n = array->elem_count;
+  const size_t        es = array->elem_size;
+  char               *temp, *swap;
+  sc_array_threaded_t st;
+
+  SC_ASSERT (num_threads >= 1);
+  num_threads = (int) SC_MIN ((size_t) num_threads, n / 2 + 1);
+  if (num_threads <= 1) {
+    sc_array_sort (array, compar);
+    return;
+  }
+
+  st.array = array;
+  st.compar = compar;
+  st.num_threads = num_threads;
+
+  /* sort one chunk per thread */
+  sc_array_run_threads (num_threads, sc_array_sort_chunk, &st);
+
+  /* merge adjacent runs of chunks with all threads in every round */
+  temp = SC_ALLOC (char, n * es);
+  st.src = array->array;
+  st.dst = temp;
+  for (st.run_width = 1; st.run_width < (size_t) num_threads;
+       st.run_width *= 2) {
+    sc_array_run_threads (num_threads, sc_array_merge_round, &st);
+    swap = st.src;
+    st.src = st.dst;
+    st.dst = swap;
+  }
+  if (st.src != array->array) {
+    memcpy (array->array, st.src, n * es);
+  }
+  SC_FREE (temp);
+}
+
+static void
+sc_array_is_sorted_chunk (void *data, int thread_id)
+{
+  sc_array_threaded_t *st = (sc_array_threaded_t *) data;
+  const size_t        n = st->array->elem_count;
+  const size_t        es = st->array->elem_size;
+  const size_t        begin = sc_array_chunk (n, thread_id, st->num_threads);
+  size_t              end = sc_array_chunk (n, thread_id + 1,
+                                            st->num_threads);
+  size_t              zz;
+  const char         *base = st->array->array;
+
+  /* also compare the last element of this chunk with the next one */
+  end = SC_MIN (end + 1, n);
+  st->results[thread_id] = 1;
+  for (zz = begin + 1; zz < end; ++zz) {
+    if (st->compar (base + (zz - 1) * es, base + zz * es) > 0) {
+      st->results[thread_id] = 0;
+      return;
+    }
+  }
+}
+
+int
+sc_array_is_sorted_threaded (sc_array_t * array,
+                             int (*compar) (const void *, const void *),
+                             int num_threads)
+{
+  int                 i, result;
+  sc_array_threaded_t st;
+
+  SC_ASSERT (num_threads >= 1);
+  num_threads = (int) SC_MIN ((size_t) num_threads, array->elem_count / 2 + 1);
+  if (num_threads <= 1) {
+    return sc_array_is_sorted (array, compar);
+  }
+
+  st.array = array;
+  st.compar = compar;
+  st.num_threads = num_threads;
+  st.results = SC_ALLOC (int, num_threads);
+  sc_array_run_threads (num_threads, sc_array_is_sorted_chunk, &st);
+  for (result = 1, i = 0; i < num_threads; ++i) {
+    result = result && st.results[i];
+  }
+  SC_FREE (st.results);
+
+  return result;
+}
+
+/** An element is kept by sc_array_uniq if it differs from its successor. */
+static inline int
+sc_array_uniq_keep (sc_array_threaded_t * st, size_t zz)
+{
+  const size_t        es = st->array->elem_size;
+  const char         *base = st->array->array;
+
+  return zz + 1 == st->array->elem_count ||
+    st->compar (base + zz * es, base + (zz + 1) * es) != 0;
+}
+
+static void
+sc_array_uniq_count (void *data, int thread_id)
+{
+  sc_array_threaded_t *st = (sc_array_threaded_t *) data;
+  const size_t        n = st->array->elem_count;
+  const size_t        begin = sc_array_chunk (n, thread_id, st->num_threads);
+  const size_t        end = sc_array_chunk (n, thread_id + 1,
+                                            st->num_threads);
+  size_t              zz, count = 0;
+
+  for (zz = begin; zz < end; ++zz) {
+    count += sc_array_uniq_keep (st, zz);
+  }
+  st->counts[thread_id] = count;
+}
+
+static void
+sc_array_uniq_scatter (void *data, int thread_id)
+{
+  sc_array_threaded_t *st = (sc_array_threaded_t *) data;
+  const size_t        n = st->array->elem_count;
+  const size_t        es = st->array->elem_size;
+  const size_t        begin = sc_array_chunk (n, thread_id, st->num_threads);
+  const size_t        end = sc_array_chunk (n, thread_id + 1,
+                                            st->num_threads);
+  size_t              zz;
+  char               *dst = st->dst + st->counts[thread_id] * es;
+
+  for (zz = begin; zz < end; ++zz) {
+    if (sc_array_uniq_keep (st, zz)) {
+      memcpy (dst, st->array->array + zz * es, es);
+      dst += es;
+    }
+  }
+}
+
+void
+sc_array_uniq_threaded (sc_array_t * array,
+                        int (*compar) (const void *, const void *),
+                        int num_threads)
+{
+  int                 i;
+  size_t              sum, c;
+  sc_array_threaded_t st;
+
+  SC_ASSERT (SC_ARRAY_IS_OWNER (array));
+  SC_ASSERT (num_threads >= 1);
+  num_threads = (int) SC_MIN ((size_t) num_threads, array->elem_count / 2 + 1);
+  if (num_threads <= 1) {
+    sc_array_uniq (array, compar);
+    return;
+  }
+
+  st.array = array;
+  st.compar = compar;
+  st.num_threads = num_threads;
+  st.counts = SC_ALLOC (size_t, num_threads);
+
+  /* count the kept elements per chunk and turn the counts into offsets */
+  sc_array_run_threads (num_threads, sc_array_uniq_count, &st);
+  for (sum = 0, i = 0; i < num_threads; ++i) {
+    c = st.counts[i];
+    st.counts[i] = sum;
+    sum += c;
+  }
+
+  /* compact out of place since chunks would overwrite each other */
+  st.dst = SC_ALLOC (char, sum * array->elem_size);
+  sc_array_run_threads (num_threads, sc_array_uniq_scatter, &st);
+  memcpy (array->array, st.dst, sum * array->elem_size);
+  sc_array_resize (array, sum);
+
+  SC_FREE (st.dst);
+  SC_FREE (st.counts);
+}
+
+ssize_t
+sc_array_bsearch (sc_array_t * array, const void *key,
+                  int (*compar) (const void *, const void *))
+{
+  ssize_t             is = -1;
+  char               *retval;
+
+  retval = (char *)
+    bsearch (key, array->array, array->elem_count, array->elem_size, compar);
+
+  if (retval != NULL) {
+    is = (ssize_t) ((retval - array->array) / array->elem_size);
+    SC_ASSERT (is >= 0 && is < (ssize_t) array->elem_count);
+  }
+
+  return is;
+}
+
+void
+sc_array_split (sc_array_t * array, sc_array_t * offsets, size_t num_types,
+                sc_array_type_t type_fn, void *data)
+{
+  const size_t        count = array->elem_count;
+  size_t              zi, *zp;
+  size_t              guess, low, high, type, step;
+
+  SC_ASSERT (offsets->elem_size == sizeof (size_t));
+
+  sc_array_resize (offsets, num_types + 1);
+
+  /** The point of this algorithm is to put offsets[i] into its final position
+   * for i = 0,...,num_types, where the final position of offsets[i] is the
+   * unique index k such that type_fn (array, j, data) < i for all j < k
+   * and type_fn (array, j, data) >= i for all j >= k.
+   *
+   * The invariants of the loop are:
+   *  1) if i < step, then offsets[i] <= low, and offsets[i] is final.
+   *  2) if i >= step, then low is less than or equal to the final value of
+   *     offsets[i].
+   *  3) for 0 <= i <= num_types, offsets[i] is greater than or equal to its
+   *     final value.
+   *  4) for every index k in the array with k < low,
+   *     type_fn (array, k, data) < step,
+   *  5) for 0 <= i < num_types,
+   *     for every index k in the array with k >= offsets[i],
+   *     type_fn (array, k, data) >= i.
+   *  6) if i < j, offsets[i] <= offsets[j].
+   *
+   * Initializing offsets[0] = 0, offsets[i] = count for i > 0,
+   * low = 0, and step = 1, the invariants are trivially satisfied.
+   */
+  zp = (size_t *) sc_array_index (offsets, 0);
+  *zp = 0;
+  for (zi = 1; zi <= num_types; zi++) {
+    zp = (size_t *) sc_array_index (offsets, zi);
+    *zp = count;
+  }
+
+  if (count == 0 || num_types <= 1) {
+    return;
+  }
+
+  /** Because count > 0 we can add another invariant:
+   *   7) if step < num_types, low < high = offsets[step].
    */
 
   low = 0;
@@ -555,6 +1429,178 @@ sc_array_permute (sc_array_t * array, sc_array_t * newindices, int keepperm)
   SC_FREE (temp);
 }
 
+/** Copy a chunk of the scratch buffer back into the array. */
+static void
+sc_array_copy_back (void *data, int thread_id)
+{
+  sc_array_threaded_t *st = (sc_array_threaded_t *) data;
+  const size_t        n = st->array->elem_count;
+  const size_t        es = st->array->elem_size;
+  const size_t        begin = sc_array_chunk (n, thread_id, st->num_threads);
+  const size_t        end = sc_array_chunk (n, thread_id + 1,
+                                            st->num_threads);
+
+  memcpy (st->array->array + begin * es, st->dst + begin * es,
+          (end - begin) * es);
+}
+
+static void
+sc_array_split_count (void *data, int thread_id)
+{
+  sc_array_threaded_t *st = (sc_array_threaded_t *) data;
+  const size_t        n = st->array->elem_count;
+  const size_t        begin = sc_array_chunk (n, thread_id, st->num_threads);
+  const size_t        end = sc_array_chunk (n, thread_id + 1,
+                                            st->num_threads);
+  size_t              zz, type, last;
+  size_t             *counts = st->counts + thread_id * st->num_types;
+  int                 sorted = 1;
+
+  memset (counts, 0, st->num_types * sizeof (size_t));
+  last = begin > 0 ? st->type_fn (st->array, begin - 1, st->type_data) : 0;
+  for (zz = begin; zz < end; ++zz) {
+    type = st->type_fn (st->array, zz, st->type_data);
+    SC_ASSERT (type < st->num_types);
+    ++counts[type];
+    sorted = sorted && type >= last;
+    last = type;
+  }
+  st->results[thread_id] = sorted;
+}
+
+static void
+sc_array_split_scatter (void *data, int thread_id)
+{
+  sc_array_threaded_t *st = (sc_array_threaded_t *) data;
+  const size_t        n = st->array->elem_count;
+  const size_t        es = st->array->elem_size;
+  const size_t        begin = sc_array_chunk (n, thread_id, st->num_threads);
+  const size_t        end = sc_array_chunk (n, thread_id + 1,
+                                            st->num_threads);
+  size_t              zz, type;
+  size_t             *positions = st->counts + thread_id * st->num_types;
+
+  for (zz = begin; zz < end; ++zz) {
+    type = st->type_fn (st->array, zz, st->type_data);
+    memcpy (st->dst + positions[type]++ * es, st->array->array + zz * es,
+            es);
+  }
+}
+
+void
+sc_array_split_threaded (sc_array_t * array, sc_array_t * offsets,
+                         size_t num_types, sc_array_type_t type_fn,
+                         void *data, int num_threads)
+{
+  const size_t        count = array->elem_count;
+  int                 i, sorted;
+  size_t              zt, sum, c;
+  size_t             *zp;
+  sc_array_threaded_t st;
+
+  SC_ASSERT (offsets->elem_size == sizeof (size_t));
+  SC_ASSERT (num_threads >= 1);
+
+  sc_array_resize (offsets, num_types + 1);
+  zp = (size_t *) offsets->array;
+  if (count == 0 || num_types == 0) {
+    for (zt = 0; zt <= num_types; ++zt) {
+      zp[zt] = zt == 0 ? 0 : count;
+    }
+    return;
+  }
+  num_threads = (int) SC_MIN ((size_t) num_threads, count);
+
+  st.array = array;
+  st.num_threads = num_threads;
+  st.num_types = num_types;
+  st.type_fn = type_fn;
+  st.type_data = data;
+  st.counts = SC_ALLOC (size_t, num_threads * num_types);
+  st.results = SC_ALLOC (int, num_threads);
+
+  /* count the types per thread and turn the counts into positions */
+  sc_array_run_threads (num_threads, sc_array_split_count, &st);
+  sorted = 1;
+  sum = 0;
+  for (zt = 0; zt < num_types; ++zt) {
+    zp[zt] = sum;
+    for (i = 0; i < num_threads; ++i) {
+      c = st.counts[i * num_types + zt];
+      st.counts[i * num_types + zt] = sum;
+      sum += c;
+    }
+  }
+  zp[num_types] = sum;
+  SC_ASSERT (sum == count);
+  for (i = 0; i < num_threads; ++i) {
+    sorted = sorted && st.results[i];
+  }
+
+  /* scatter out of place unless the array is grouped already */
+  if (!sorted) {
+    SC_ASSERT (SC_ARRAY_IS_OWNER (array));
+    st.dst = SC_ALLOC (char, count * array->elem_size);
+    sc_array_run_threads (num_threads, sc_array_split_scatter, &st);
+    sc_array_run_threads (num_threads, sc_array_copy_back, &st);
+    SC_FREE (st.dst);
+  }
+
+  SC_FREE (st.results);
+  SC_FREE (st.counts);
+}
+
+static void
+sc_array_permute_scatter (void *data, int thread_id)
+{
+  sc_array_threaded_t *st = (sc_array_threaded_t *) data;
+  const size_t        n = st->array->elem_count;
+  const size_t        es = st->array->elem_size;
+  const size_t        begin = sc_array_chunk (n, thread_id, st->num_threads);
+  const size_t        end = sc_array_chunk (n, thread_id + 1,
+                                            st->num_threads);
+  size_t              zz;
+
+  for (zz = begin; zz < end; ++zz) {
+    memcpy (st->dst + st->newind[zz] * es, st->array->array + zz * es, es);
+  }
+}
+
+void
+sc_array_permute_threaded (sc_array_t * array, sc_array_t * newindices,
+                           sc_array_t * scratch, int num_threads)
+{
+  const size_t        count = array->elem_count;
+  sc_array_threaded_t st;
+
+  SC_ASSERT (newindices->elem_size == sizeof (size_t));
+  SC_ASSERT (newindices->elem_count == count);
+  SC_ASSERT (sc_array_is_permutation (newindices));
+  SC_ASSERT (num_threads >= 1);
+  if (count == 0) {
+    return;
+  }
+
+  st.array = array;
+  st.num_threads = (int) SC_MIN ((size_t) num_threads, count);
+  st.newind = (const size_t *) newindices->array;
+  if (scratch != NULL) {
+    SC_ASSERT (scratch->elem_size == array->elem_size);
+    sc_array_resize (scratch, count);
+    st.dst = scratch->array;
+  }
+  else {
+    st.dst = SC_ALLOC (char, count * array->elem_size);
+  }
+
+  sc_array_run_threads (st.num_threads, sc_array_permute_scatter, &st);
+  sc_array_run_threads (st.num_threads, sc_array_copy_back, &st);
+
+  if (scratch == NULL) {
+    SC_FREE (st.dst);
+  }
+}
+
 unsigned
 sc_array_checksum (sc_array_t * array)
 {
@@ -690,42 +1736,370 @@ sc_array_pqueue_pop (sc_array_t * array, void *result,
   return swaps;
 }
 
-/* mempool routines */
+/* d-ary priority queue routines */
 
-size_t
-sc_mempool_memory_used (sc_mempool_t * mempool)
+/* The heap shrinks only when a quarter of it is used, so a queue that
+ * oscillates in size does not reallocate on every push and pop. */
+static const sc_array_growth_t sc_pqueue_growth = {
+  SC_ARRAY_GROWTH_POW2, 0., 0, 4
+};
+
+static inline char *
+sc_pqueue_slot (sc_pqueue_t * pqueue, size_t pos)
 {
-  return sizeof (sc_mempool_t) +
-    obstack_memory_used (&mempool->obstack) +
-    sc_array_memory_used (&mempool->freed, 0);
+  return pqueue->heap.array + pos * pqueue->heap.elem_size;
 }
 
-static void        *
-sc_containers_malloc (size_t n)
+static inline       size_t
+sc_pqueue_handle (sc_pqueue_t * pqueue, size_t pos)
 {
-  return sc_malloc (sc_package_id, n);
+  return pqueue->indexed ?
+    *(size_t *) sc_array_index (&pqueue->handles, pos) : SC_PQUEUE_NO_HANDLE;
 }
 
-static void        *(*obstack_chunk_alloc) (size_t) = sc_containers_malloc;
+/** Store an element and its handle at a position of the heap. */
+static inline void
+sc_pqueue_set (sc_pqueue_t * pqueue, size_t pos, const void *elem,
+               size_t handle)
+{
+  memcpy (sc_pqueue_slot (pqueue, pos), elem, pqueue->heap.elem_size);
+  if (pqueue->indexed) {
+    *(size_t *) sc_array_index (&pqueue->handles, pos) = handle;
+    *(size_t *) sc_array_index (&pqueue->positions, handle) = pos;
+  }
+}
 
+/** Change the number of elements in the heap and its handles. */
 static void
-sc_containers_free (void *p)
+sc_pqueue_resize (sc_pqueue_t * pqueue, size_t new_count)
 {
-  sc_free (sc_package_id, p);
+  sc_array_resize (&pqueue->heap, new_count);
+  if (pqueue->indexed) {
+    sc_array_resize (&pqueue->handles, new_count);
+  }
 }
 
-static void         (*obstack_chunk_free) (void *) = sc_containers_free;
+/** Obtain a handle for a new element of an indexed queue. */
+static              size_t
+sc_pqueue_new_handle (sc_pqueue_t * pqueue)
+{
+  if (pqueue->free_handles.elem_count > 0) {
+    return *(size_t *) sc_array_pop (&pqueue->free_handles);
+  }
+  *(size_t *) sc_array_push (&pqueue->positions) = SC_PQUEUE_NO_HANDLE;
+  return pqueue->positions.elem_count - 1;
+}
 
-/** This function is static; we do not like to expose _ext functions in libsc. */
+/** Make the handle of an element that left the queue available again. */
 static void
-sc_mempool_init_ext (sc_mempool_t * mempool, size_t elem_size,
-                     int zero_and_persist)
+sc_pqueue_release_handle (sc_pqueue_t * pqueue, size_t handle)
 {
-  mempool->elem_size = elem_size;
-  mempool->elem_count = 0;
-  mempool->zero_and_persist = zero_and_persist;
+  if (pqueue->indexed) {
+    *(size_t *) sc_array_index (&pqueue->positions, handle) =
+      SC_PQUEUE_NO_HANDLE;
+    *(size_t *) sc_array_push (&pqueue->free_handles) = handle;
+  }
+}
 
-  obstack_init (&mempool->obstack);
+/** Move the element in temp up from a hole at pos to its place. */
+static void
+sc_pqueue_sift_up (sc_pqueue_t * pqueue, size_t pos, size_t handle)
+{
+  size_t              parent;
+
+  while (pos > 0) {
+    parent = (pos - 1) / (size_t) pqueue->arity;
+    if (pqueue->compar (sc_pqueue_slot (pqueue, parent), pqueue->temp) <= 0) {
+      break;
+    }
+    sc_pqueue_set (pqueue, pos, sc_pqueue_slot (pqueue, parent),
+                   sc_pqueue_handle (pqueue, parent));
+    pos = parent;
+  }
+  sc_pqueue_set (pqueue, pos, pqueue->temp, handle);
+}
+
+/** Find the smallest child of a node, or return 0 for a leaf. */
+static inline       size_t
+sc_pqueue_min_child (sc_pqueue_t * pqueue, size_t pos)
+{
+  const size_t        n = pqueue->heap.elem_count;
+  const size_t        first = pos * (size_t) pqueue->arity + 1;
+  size_t              last, child, best;
+
+  if (first >= n) {
+    return 0;
+  }
+  last = SC_MIN (first + (size_t) pqueue->arity, n);
+  best = first;
+  for (child = first + 1; child < last; ++child) {
+    if (pqueue->compar (sc_pqueue_slot (pqueue, child),
+                        sc_pqueue_slot (pqueue, best)) < 0) {
+      best = child;
+    }
+  }
+  return best;
+}
+
+/** Move the element in temp down from a hole at pos to its place. */
+static void
+sc_pqueue_sift_down (sc_pqueue_t * pqueue, size_t pos, size_t handle)
+{
+  size_t              child;
+
+  while ((child = sc_pqueue_min_child (pqueue, pos)) > 0 &&
+         pqueue->compar (sc_pqueue_slot (pqueue, child), pqueue->temp) < 0) {
+    sc_pqueue_set (pqueue, pos, sc_pqueue_slot (pqueue, child),
+                   sc_pqueue_handle (pqueue, child));
+    pos = child;
+  }
+  sc_pqueue_set (pqueue, pos, pqueue->temp, handle);
+}
+
+/** Fill a hole at pos with the last element and shorten the heap. */
+static void
+sc_pqueue_fill_hole (sc_pqueue_t * pqueue, size_t pos)
+{
+  const size_t        last = pqueue->heap.elem_count - 1;
+  size_t              handle, child;
+
+  if (pos == last) {
+    sc_pqueue_resize (pqueue, last);
+    return;
+  }
+  handle = sc_pqueue_handle (pqueue, last);
+  memcpy (pqueue->temp, sc_pqueue_slot (pqueue, last),
+          pqueue->heap.elem_size);
+  sc_pqueue_resize (pqueue, last);
+
+  if (pos > 0 &&
+      pqueue->compar (pqueue->temp,
+                      sc_pqueue_slot (pqueue,
+                                      (pos - 1) /
+                                      (size_t) pqueue->arity)) < 0) {
+    sc_pqueue_sift_up (pqueue, pos, handle);
+    return;
+  }
+
+  /* the last element is likely to belong near the bottom: sink the hole
+     to a leaf along the smallest children, then sift the element up */
+  while ((child = sc_pqueue_min_child (pqueue, pos)) > 0) {
+    sc_pqueue_set (pqueue, pos, sc_pqueue_slot (pqueue, child),
+                   sc_pqueue_handle (pqueue, child));
+    pos = child;
+  }
+  sc_pqueue_sift_up (pqueue, pos, handle);
+}
+
+size_t
+sc_pqueue_memory_used (sc_pqueue_t * pqueue)
+{
+  return sizeof (sc_pqueue_t) + pqueue->heap.elem_size +
+    sc_array_memory_used (&pqueue->heap, 0) +
+    sc_array_memory_used (&pqueue->handles, 0) +
+    sc_array_memory_used (&pqueue->positions, 0) +
+    sc_array_memory_used (&pqueue->free_handles, 0);
+}
+
+sc_pqueue_t        *
+sc_pqueue_new (size_t elem_size, int arity,
+               int (*compar) (const void *, const void *), int indexed)
+{
+  sc_pqueue_t        *pqueue;
+
+  SC_ASSERT (elem_size > 0);
+  SC_ASSERT (arity >= 2);
+
+  pqueue = SC_ALLOC (sc_pqueue_t, 1);
+  sc_array_init (&pqueue->heap, elem_size);
+  sc_array_set_growth (&pqueue->heap, &sc_pqueue_growth);
+  pqueue->arity = arity;
+  pqueue->indexed = indexed;
+  pqueue->compar = compar;
+  sc_array_init (&pqueue->handles, sizeof (size_t));
+  sc_array_set_growth (&pqueue->handles, &sc_pqueue_growth);
+  sc_array_init (&pqueue->positions, sizeof (size_t));
+  sc_array_init (&pqueue->free_handles, sizeof (size_t));
+  pqueue->temp = SC_ALLOC (char, elem_size);
+
+  return pqueue;
+}
+
+void
+sc_pqueue_destroy (sc_pqueue_t * pqueue)
+{
+  sc_array_reset (&pqueue->heap);
+  sc_array_reset (&pqueue->handles);
+  sc_array_reset (&pqueue->positions);
+  sc_array_reset (&pqueue->free_handles);
+  SC_FREE (pqueue->temp);
+  SC_FREE (pqueue);
+}
+
+size_t
+sc_pqueue_push (sc_pqueue_t * pqueue, const void *elem)
+{
+  const size_t        pos = pqueue->heap.elem_count;
+  size_t              handle = SC_PQUEUE_NO_HANDLE;
+
+  if (pqueue->indexed) {
+    handle = sc_pqueue_new_handle (pqueue);
+  }
+  sc_pqueue_resize (pqueue, pos + 1);
+  memcpy (pqueue->temp, elem, pqueue->heap.elem_size);
+  sc_pqueue_sift_up (pqueue, pos, handle);
+
+  return handle;
+}
+
+void
+sc_pqueue_push_batch (sc_pqueue_t * pqueue, const void *elems, size_t count,
+                      size_t * handles)
+{
+  const size_t        old_count = pqueue->heap.elem_count;
+  const size_t        es = pqueue->heap.elem_size;
+  size_t              zz, pos, handle;
+
+  if (count == 0) {
+    return;
+  }
+
+  /* few elements are cheaper to add one by one */
+  if (count < old_count / 4) {
+    for (zz = 0; zz < count; ++zz) {
+      handle = sc_pqueue_push (pqueue, (const char *) elems + zz * es);
+      if (handles != NULL) {
+        handles[zz] = handle;
+      }
+    }
+    return;
+  }
+
+  /* append the elements and heapify from the last parent upwards */
+  sc_pqueue_resize (pqueue, old_count + count);
+  for (zz = 0; zz < count; ++zz) {
+    handle = pqueue->indexed ?
+      sc_pqueue_new_handle (pqueue) : SC_PQUEUE_NO_HANDLE;
+    sc_pqueue_set (pqueue, old_count + zz, (const char *) elems + zz * es,
+                   handle);
+    if (handles != NULL) {
+      handles[zz] = handle;
+    }
+  }
+  pos = pqueue->heap.elem_count < 2 ? 0 :
+    (pqueue->heap.elem_count - 2) / (size_t) pqueue->arity + 1;
+  while (pos-- > 0) {
+    handle = sc_pqueue_handle (pqueue, pos);
+    memcpy (pqueue->temp, sc_pqueue_slot (pqueue, pos), es);
+    sc_pqueue_sift_down (pqueue, pos, handle);
+  }
+}
+
+void               *
+sc_pqueue_top (sc_pqueue_t * pqueue)
+{
+  return pqueue->heap.elem_count > 0 ? pqueue->heap.array : NULL;
+}
+
+int
+sc_pqueue_pop (sc_pqueue_t * pqueue, void *result)
+{
+  if (pqueue->heap.elem_count == 0) {
+    return 0;
+  }
+  if (result != NULL) {
+    memcpy (result, pqueue->heap.array, pqueue->heap.elem_size);
+  }
+  sc_pqueue_release_handle (pqueue, sc_pqueue_handle (pqueue, 0));
+  sc_pqueue_fill_hole (pqueue, 0);
+
+  return 1;
+}
+
+void               *
+sc_pqueue_lookup (sc_pqueue_t * pqueue, size_t handle)
+{
+  size_t              pos;
+
+  SC_ASSERT (pqueue->indexed);
+  SC_ASSERT (handle < pqueue->positions.elem_count);
+
+  pos = *(size_t *) sc_array_index (&pqueue->positions, handle);
+  return pos == SC_PQUEUE_NO_HANDLE ? NULL : sc_pqueue_slot (pqueue, pos);
+}
+
+void
+sc_pqueue_update (sc_pqueue_t * pqueue, size_t handle, const void *elem)
+{
+  size_t              pos;
+
+  SC_ASSERT (sc_pqueue_lookup (pqueue, handle) != NULL);
+
+  pos = *(size_t *) sc_array_index (&pqueue->positions, handle);
+  memcpy (pqueue->temp, elem, pqueue->heap.elem_size);
+  if (pos > 0 &&
+      pqueue->compar (pqueue->temp,
+                      sc_pqueue_slot (pqueue,
+                                      (pos - 1) /
+                                      (size_t) pqueue->arity)) < 0) {
+    sc_pqueue_sift_up (pqueue, pos, handle);
+  }
+  else {
+    sc_pqueue_sift_down (pqueue, pos, handle);
+  }
+}
+
+void
+sc_pqueue_remove (sc_pqueue_t * pqueue, size_t handle, void *result)
+{
+  size_t              pos;
+
+  SC_ASSERT (sc_pqueue_lookup (pqueue, handle) != NULL);
+
+  pos = *(size_t *) sc_array_index (&pqueue->positions, handle);
+  if (result != NULL) {
+    memcpy (result, sc_pqueue_slot (pqueue, pos), pqueue->heap.elem_size);
+  }
+  sc_pqueue_release_handle (pqueue, handle);
+  sc_pqueue_fill_hole (pqueue, pos);
+}
+
+/* mempool routines */
+
+size_t
+sc_mempool_memory_used (sc_mempool_t * mempool)
+{
+  return sizeof (sc_mempool_t) +
+    obstack_memory_used (&mempool->obstack) +
+    sc_array_memory_used (&mempool->freed, 0);
+}
+
+static void        *
+sc_containers_malloc (size_t n)
+{
+  return sc_malloc (sc_package_id, n);
+}
+
+static void        *(*obstack_chunk_alloc) (size_t) = sc_containers_malloc;
+
+static void
+sc_containers_free (void *p)
+{
+  sc_free (sc_package_id, p);
+}
+
+static void         (*obstack_chunk_free) (void *) = sc_containers_free;
+
+/** This function is static; we do not like to expose _ext functions in libsc. */
+static void
+sc_mempool_init_ext (sc_mempool_t * mempool, size_t elem_size,
+                     int zero_and_persist)
+{
+  mempool->elem_size = elem_size;
+  mempool->elem_count = 0;
+  mempool->zero_and_persist = zero_and_persist;
+
+  obstack_init (&mempool->obstack);
   sc_array_init (&mempool->freed, sizeof (void *));
 }
 
@@ -786,8 +2160,93 @@ sc_mempool_truncate (sc_mempool_t * mempool)
   mempool->elem_count = 0;
 }
 
+/* arena routines */
+
+size_t
+sc_arena_memory_used (sc_arena_t * arena)
+{
+  return sizeof (sc_arena_t) + obstack_memory_used (&arena->obstack);
+}
+
+sc_arena_t         *
+sc_arena_new (void)
+{
+  sc_arena_t         *arena;
+
+  arena = SC_ALLOC (sc_arena_t, 1);
+  obstack_init (&arena->obstack);
+  arena->start = obstack_alloc (&arena->obstack, 0);
+
+  return arena;
+}
+
+void
+sc_arena_destroy (sc_arena_t * arena)
+{
+  obstack_free (&arena->obstack, NULL);
+  SC_FREE (arena);
+}
+
+void               *
+sc_arena_alloc (sc_arena_t * arena, size_t size)
+{
+  /* obstack sizes are int; truncating would corrupt memory */
+  SC_CHECK_ABORTF (size <= (size_t) INT_MAX,
+                   "Arena allocation of %llu bytes exceeds INT_MAX",
+                   (unsigned long long) size);
+
+  return obstack_alloc (&arena->obstack, (int) size);
+}
+
+void               *
+sc_arena_alloc_aligned (sc_arena_t * arena, size_t size, size_t alignment)
+{
+  char               *ptr;
+
+  SC_ASSERT (alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+  /* pad so that an aligned address with size bytes behind it exists */
+  ptr = (char *) sc_arena_alloc (arena, size + alignment - 1);
+  return ptr + ((alignment - (uintptr_t) ptr % alignment) % alignment);
+}
+
+void               *
+sc_arena_mark (sc_arena_t * arena)
+{
+  return obstack_alloc (&arena->obstack, 0);
+}
+
+void
+sc_arena_rewind (sc_arena_t * arena, void *mark)
+{
+  /* freeing the empty object at start keeps the first chunk */
+  obstack_free (&arena->obstack, mark != NULL ? mark : arena->start);
+  if (mark == NULL) {
+    arena->start = obstack_alloc (&arena->obstack, 0);
+  }
+}
+
 /* list routines */
 
+/** Allocate a link from the arena or allocator of a list. */
+static sc_link_t   *
+sc_list_alloc_link (sc_list_t * list)
+{
+  if (list->arena != NULL) {
+    return (sc_link_t *) sc_arena_alloc (list->arena, sizeof (sc_link_t));
+  }
+  return (sc_link_t *) sc_mempool_alloc (list->allocator);
+}
+
+/** Return a link to the allocator of a list; arena links stay put. */
+static void
+sc_list_free_link (sc_list_t * list, sc_link_t * lynk)
+{
+  if (list->arena == NULL) {
+    sc_mempool_free (list->allocator, lynk);
+  }
+}
+
 size_t
 sc_list_memory_used (sc_list_t * list, int is_dynamic)
 {
@@ -805,6 +2264,7 @@ sc_list_new (sc_mempool_t * allocator)
   list->elem_count = 0;
   list->first = NULL;
   list->last = NULL;
+  list->arena = NULL;
 
   if (allocator != NULL) {
     SC_ASSERT (allocator->elem_size == sizeof (sc_link_t));
@@ -819,10 +2279,33 @@ sc_list_new (sc_mempool_t * allocator)
   return list;
 }
 
+sc_list_t          *
+sc_list_new_arena (sc_arena_t * arena)
+{
+  sc_list_t          *list;
+
+  if (arena == NULL) {
+    return sc_list_new (NULL);
+  }
+  list = (sc_list_t *) sc_arena_alloc (arena, sizeof (sc_list_t));
+
+  list->elem_count = 0;
+  list->first = NULL;
+  list->last = NULL;
+  list->allocator_owned = 0;
+  list->allocator = NULL;
+  list->arena = arena;
+
+  return list;
+}
+
 void
 sc_list_destroy (sc_list_t * list)
 {
-
+  if (list->arena != NULL) {
+    /* the memory is released with the arena */
+    return;
+  }
   if (list->allocator_owned) {
     sc_list_unlink (list);
     sc_mempool_destroy (list->allocator);
@@ -845,6 +2328,7 @@ sc_list_init (sc_list_t * list, sc_mempool_t * allocator)
 
   list->allocator = allocator;
   list->allocator_owned = 0;
+  list->arena = NULL;
 }
 
 void
@@ -856,7 +2340,7 @@ sc_list_reset (sc_list_t * list)
   lynk = list->first;
   while (lynk != NULL) {
     temp = lynk->next;
-    sc_mempool_free (list->allocator, lynk);
+    sc_list_free_link (list, lynk);
     lynk = temp;
     --list->elem_count;
   }
@@ -877,7 +2361,7 @@ sc_list_prepend (sc_list_t * list, void *data)
 {
   sc_link_t          *lynk;
 
-  lynk = (sc_link_t *) sc_mempool_alloc (list->allocator);
+  lynk = sc_list_alloc_link (list);
   lynk->data = data;
   lynk->next = list->first;
   list->first = lynk;
@@ -894,7 +2378,7 @@ sc_list_append (sc_list_t * list, void *data)
 {
   sc_link_t          *lynk;
 
-  lynk = (sc_link_t *) sc_mempool_alloc (list->allocator);
+  lynk = sc_list_alloc_link (list);
   lynk->data = data;
   lynk->next = NULL;
   if (list->last != NULL) {
@@ -916,7 +2400,7 @@ sc_list_insert (sc_list_t * list, sc_link_t * pred, void *data)
 
   SC_ASSERT (pred != NULL);
 
-  lynk = (sc_link_t *) sc_mempool_alloc (list->allocator);
+  lynk = sc_list_alloc_link (list);
   lynk->data = data;
   lynk->next = pred->next;
   pred->next = lynk;
@@ -947,7 +2431,7 @@ sc_list_remove (sc_list_t * list, sc_link_t * pred)
   if (list->last == lynk) {
     list->last = pred;
   }
-  sc_mempool_free (list->allocator, lynk);
+  sc_list_free_link (list, lynk);
 
   --list->elem_count;
   return data;
@@ -964,7 +2448,7 @@ sc_list_pop (sc_list_t * list)
   lynk = list->first;
   list->first = lynk->next;
   data = lynk->data;
-  sc_mempool_free (list->allocator, lynk);
+  sc_list_free_link (list, lynk);
   if (list->first == NULL) {
     list->last = NULL;
   }
@@ -1026,6 +2510,15 @@ sc_hash_memory_used (sc_hash_t * hash)
 static const size_t sc_hash_minimal_size = (size_t) ((1 << 8) - 1);
 static const size_t sc_hash_shrink_interval = (size_t) (1 << 8);
 
+/* number of keys whose slots are prefetched together by the batch calls */
+#define SC_HASH_BATCH_SIZE 16
+
+#if defined (__GNUC__)
+#define SC_HASH_PREFETCH(p) __builtin_prefetch ((const void *) (p))
+#else
+#define SC_HASH_PREFETCH(p) SC_NOOP ()
+#endif
+
 static void
 sc_hash_maybe_resize (sc_hash_t * hash)
 {
@@ -1200,14 +2693,16 @@ sc_hash_unlink_destroy (sc_hash_t * hash)
   SC_FREE (hash);
 }
 
-int
-sc_hash_lookup (sc_hash_t * hash, void *v, void ***found)
+/** Look up an object whose hash value has been computed already. */
+static int
+sc_hash_lookup_hashed (sc_hash_t * hash, void *v, unsigned hraw,
+                       void ***found)
 {
   size_t              hval;
   sc_list_t          *list;
   sc_link_t          *lynk;
 
-  hval = hash->hash_fn (v, hash->user_data) % hash->slots->elem_count;
+  hval = hraw % hash->slots->elem_count;
   list = (sc_list_t *) sc_array_index (hash->slots, hval);
 
   for (lynk = list->first; lynk != NULL; lynk = lynk->next) {
@@ -1223,13 +2718,22 @@ sc_hash_lookup (sc_hash_t * hash, void *v, void ***found)
 }
 
 int
-sc_hash_insert_unique (sc_hash_t * hash, void *v, void ***found)
+sc_hash_lookup (sc_hash_t * hash, void *v, void ***found)
+{
+  return sc_hash_lookup_hashed (hash, v, hash->hash_fn (v, hash->user_data),
+                                found);
+}
+
+/** Insert an object whose hash value has been computed already. */
+static int
+sc_hash_insert_unique_hashed (sc_hash_t * hash, void *v, unsigned hraw,
+                              void ***found)
 {
   size_t              hval;
   sc_list_t          *list;
   sc_link_t          *lynk;
 
-  hval = hash->hash_fn (v, hash->user_data) % hash->slots->elem_count;
+  hval = hraw % hash->slots->elem_count;
   list = (sc_list_t *) sc_array_index (hash->slots, hval);
 
   /* check if an equal object is already contained in the hash table */
@@ -1253,7 +2757,7 @@ sc_hash_insert_unique (sc_hash_t * hash, void *v, void ***found)
   if (hash->elem_count % hash->slots->elem_count == 0) {
     sc_hash_maybe_resize (hash);
     if (found != NULL) {
-      SC_EXECUTE_ASSERT_TRUE (sc_hash_lookup (hash, v, found));
+      SC_EXECUTE_ASSERT_TRUE (sc_hash_lookup_hashed (hash, v, hraw, found));
     }
   }
 
@@ -1261,40 +2765,166 @@ sc_hash_insert_unique (sc_hash_t * hash, void *v, void ***found)
 }
 
 int
-sc_hash_remove (sc_hash_t * hash, void *v, void **found)
+sc_hash_insert_unique (sc_hash_t * hash, void *v, void ***found)
 {
-  size_t              hval;
+  return sc_hash_insert_unique_hashed (hash, v,
+                                       hash->hash_fn (v, hash->user_data),
+                                       found);
+}
+
+/** Compute the hash values of a batch of keys and prefetch their slots.
+ * \param [in] keys     Array of void * pointers to the objects.
+ * \param [in] offset   First key of the batch.
+ * \param [in] count    Number of keys in the batch.
+ * \param [out] hraw    Hash values of the keys in the batch.
+ */
+static void
+sc_hash_batch_prefetch (sc_hash_t * hash, sc_array_t * keys, size_t offset,
+                        size_t count, unsigned *hraw)
+{
+  size_t              zz;
   sc_list_t          *list;
-  sc_link_t          *lynk, *prev;
+  const size_t        num_slots = hash->slots->elem_count;
 
-  hval = hash->hash_fn (v, hash->user_data) % hash->slots->elem_count;
-  list = (sc_list_t *) sc_array_index (hash->slots, hval);
+  for (zz = 0; zz < count; ++zz) {
+    hraw[zz] = hash->hash_fn (*(void **) sc_array_index (keys, offset + zz),
+                              hash->user_data);
+    SC_HASH_PREFETCH (sc_array_index (hash->slots, hraw[zz] % num_slots));
+  }
+  for (zz = 0; zz < count; ++zz) {
+    list = (sc_list_t *) sc_array_index (hash->slots, hraw[zz] % num_slots);
+    if (list->first != NULL) {
+      SC_HASH_PREFETCH (list->first);
+    }
+  }
+}
 
-  prev = NULL;
-  for (lynk = list->first; lynk != NULL; lynk = lynk->next) {
-    /* check if an equal object is contained in the hash table */
-    if (hash->equal_fn (lynk->data, v, hash->user_data)) {
-      if (found != NULL) {
-        *found = lynk->data;
-      }
-      (void) sc_list_remove (list, prev);
-      --hash->elem_count;
+size_t
+sc_hash_lookup_batch (sc_hash_t * hash, sc_array_t * keys, sc_array_t * found)
+{
+  size_t              zz, offset, count;
+  size_t              num_found = 0;
+  unsigned            hraw[SC_HASH_BATCH_SIZE];
+  void             ***out;
 
-      /* check for resize at specific intervals and return */
-      if (hash->elem_count % sc_hash_shrink_interval == 0) {
-        sc_hash_maybe_resize (hash);
+  SC_ASSERT (keys->elem_size == sizeof (void *));
+  SC_ASSERT (found == NULL || found->elem_size == sizeof (void **));
+
+  if (found != NULL) {
+    sc_array_resize (found, keys->elem_count);
+  }
+  for (offset = 0; offset < keys->elem_count; offset += count) {
+    count = SC_MIN (keys->elem_count - offset, SC_HASH_BATCH_SIZE);
+    sc_hash_batch_prefetch (hash, keys, offset, count, hraw);
+    for (zz = 0; zz < count; ++zz) {
+      out = found == NULL ? NULL :
+        (void ***) sc_array_index (found, offset + zz);
+      if (sc_hash_lookup_hashed (hash, *(void **) sc_array_index
+                                 (keys, offset + zz), hraw[zz], out)) {
+        ++num_found;
+      }
+      else if (out != NULL) {
+        *out = NULL;
       }
-      return 1;
     }
-    prev = lynk;
   }
-  return 0;
+  return num_found;
 }
 
-void
-sc_hash_foreach (sc_hash_t * hash, sc_hash_foreach_t fn)
+size_t
+sc_hash_insert_unique_batch (sc_hash_t * hash, sc_array_t * keys,
+                             sc_array_t * found)
 {
-  size_t              slot;
+  size_t              zz, offset, count;
+  size_t              num_added = 0, num_stale = 0;
+  size_t              resize_actions = hash->resize_actions;
+  unsigned            hraw[SC_HASH_BATCH_SIZE];
+  unsigned           *hashes = NULL;
+  void             ***out;
+
+  SC_ASSERT (keys->elem_size == sizeof (void *));
+  SC_ASSERT (found == NULL || found->elem_size == sizeof (void **));
+
+  if (found != NULL) {
+    sc_array_resize (found, keys->elem_count);
+    hashes = SC_ALLOC (unsigned, keys->elem_count);
+  }
+  for (offset = 0; offset < keys->elem_count; offset += count) {
+    count = SC_MIN (keys->elem_count - offset, SC_HASH_BATCH_SIZE);
+    sc_hash_batch_prefetch (hash, keys, offset, count, hraw);
+    for (zz = 0; zz < count; ++zz) {
+      out = found == NULL ? NULL :
+        (void ***) sc_array_index (found, offset + zz);
+      num_added += sc_hash_insert_unique_hashed
+        (hash, *(void **) sc_array_index (keys, offset + zz), hraw[zz], out);
+      if (hash->resize_actions != resize_actions) {
+        /* the output of the current key is reassigned already */
+        resize_actions = hash->resize_actions;
+        num_stale = offset + zz;
+      }
+    }
+    if (hashes != NULL) {
+      memcpy (hashes + offset, hraw, count * sizeof (unsigned));
+    }
+  }
+
+  /* a resize moves the links: reassign the output of the keys before it */
+  if (found != NULL) {
+    for (zz = 0; zz < num_stale; ++zz) {
+      SC_EXECUTE_ASSERT_TRUE (sc_hash_lookup_hashed
+                              (hash, *(void **) sc_array_index (keys, zz),
+                               hashes[zz],
+                               (void ***) sc_array_index (found, zz)));
+    }
+    SC_FREE (hashes);
+  }
+  return num_added;
+}
+
+/** Remove an object whose hash value has been computed already. */
+static int
+sc_hash_remove_hashed (sc_hash_t * hash, void *v, unsigned hraw,
+                       void **found)
+{
+  size_t              hval;
+  sc_list_t          *list;
+  sc_link_t          *lynk, *prev;
+
+  hval = hraw % hash->slots->elem_count;
+  list = (sc_list_t *) sc_array_index (hash->slots, hval);
+
+  prev = NULL;
+  for (lynk = list->first; lynk != NULL; lynk = lynk->next) {
+    /* check if an equal object is contained in the hash table */
+    if (hash->equal_fn (lynk->data, v, hash->user_data)) {
+      if (found != NULL) {
+        *found = lynk->data;
+      }
+      (void) sc_list_remove (list, prev);
+      --hash->elem_count;
+
+      /* check for resize at specific intervals and return */
+      if (hash->elem_count % sc_hash_shrink_interval == 0) {
+        sc_hash_maybe_resize (hash);
+      }
+      return 1;
+    }
+    prev = lynk;
+  }
+  return 0;
+}
+
+int
+sc_hash_remove (sc_hash_t * hash, void *v, void **found)
+{
+  return sc_hash_remove_hashed (hash, v, hash->hash_fn (v, hash->user_data),
+                                found);
+}
+
+void
+sc_hash_foreach (sc_hash_t * hash, sc_hash_foreach_t fn)
+{
+  size_t              slot;
   sc_list_t          *list;
   sc_link_t          *lynk;
 
@@ -1338,6 +2968,606 @@ sc_hash_print_statistics (int package_id, int log_priority, sc_hash_t * hash)
                (unsigned long) hash->resize_actions);
 }
 
+/* concurrent hash table routines */
+
+static const int    sc_chash_default_log = 6;
+
+/** Choose the shard from the high bits of the mixed hash value.
+ * The slot within the shard is chosen by the hash value modulo its size,
+ * which keeps both choices independent.
+ */
+static inline int
+sc_chash_shard (const sc_chash_t * chash, unsigned hraw)
+{
+  return chash->num_shards == 1 ? 0 :
+    (int) (((uint64_t) hraw * 0x9E3779B97F4A7C15ULL) >> chash->shift);
+}
+
+static inline void
+sc_chash_lock (sc_chash_t * chash, int shard)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+
+  pth = pthread_mutex_lock ((pthread_mutex_t *) chash->locks + shard);
+  SC_CHECK_ABORT (pth == 0, "sc_chash_lock");
+#endif
+}
+
+static inline void
+sc_chash_unlock (sc_chash_t * chash, int shard)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+
+  pth = pthread_mutex_unlock ((pthread_mutex_t *) chash->locks + shard);
+  SC_CHECK_ABORT (pth == 0, "sc_chash_unlock");
+#endif
+}
+
+size_t
+sc_chash_memory_used (sc_chash_t * chash)
+{
+  int                 i;
+  size_t              mem;
+
+  mem = sizeof (sc_chash_t) + chash->num_shards * sizeof (sc_hash_t *);
+#ifdef SC_ENABLE_PTHREAD
+  mem += chash->num_shards * sizeof (pthread_mutex_t);
+#endif
+  for (i = 0; i < chash->num_shards; ++i) {
+    sc_chash_lock (chash, i);
+    mem += sc_hash_memory_used (chash->shards[i]);
+    sc_chash_unlock (chash, i);
+  }
+  return mem;
+}
+
+sc_chash_t         *
+sc_chash_new (sc_hash_function_t hash_fn, sc_equal_function_t equal_fn,
+              void *user_data, int num_shards)
+{
+  int                 i;
+  sc_chash_t         *chash;
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+  pthread_mutex_t    *locks;
+#endif
+
+  SC_ASSERT (num_shards >= 0);
+  if (num_shards == 0) {
+    num_shards = 1 << sc_chash_default_log;
+  }
+  else {
+    num_shards = 1 << SC_LOG2_32 (2 * num_shards - 1);
+  }
+
+  chash = SC_ALLOC (sc_chash_t, 1);
+  chash->num_shards = num_shards;
+  chash->shift = 64 - SC_LOG2_32 (num_shards);
+  chash->hash_fn = hash_fn;
+  chash->user_data = user_data;
+  chash->shards = SC_ALLOC (sc_hash_t *, num_shards);
+  for (i = 0; i < num_shards; ++i) {
+    chash->shards[i] = sc_hash_new (hash_fn, equal_fn, user_data, NULL);
+  }
+#ifdef SC_ENABLE_PTHREAD
+  chash->locks = locks = SC_ALLOC (pthread_mutex_t, num_shards);
+  for (i = 0; i < num_shards; ++i) {
+    pth = pthread_mutex_init (locks + i, NULL);
+    SC_CHECK_ABORT (pth == 0, "sc_chash_new");
+  }
+#else
+  chash->locks = NULL;
+#endif
+
+  return chash;
+}
+
+void
+sc_chash_destroy (sc_chash_t * chash)
+{
+  int                 i;
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+
+  for (i = 0; i < chash->num_shards; ++i) {
+    pth = pthread_mutex_destroy ((pthread_mutex_t *) chash->locks + i);
+    SC_CHECK_ABORT (pth == 0, "sc_chash_destroy");
+  }
+  SC_FREE (chash->locks);
+#endif
+  for (i = 0; i < chash->num_shards; ++i) {
+    sc_hash_destroy (chash->shards[i]);
+  }
+  SC_FREE (chash->shards);
+
+  SC_FREE (chash);
+}
+
+size_t
+sc_chash_elem_count (sc_chash_t * chash)
+{
+  int                 i;
+  size_t              count = 0;
+
+  for (i = 0; i < chash->num_shards; ++i) {
+    sc_chash_lock (chash, i);
+    count += chash->shards[i]->elem_count;
+    sc_chash_unlock (chash, i);
+  }
+  return count;
+}
+
+int
+sc_chash_lookup (sc_chash_t * chash, void *v, void **found)
+{
+  int                 shard, result;
+  unsigned            hraw;
+  void              **f;
+
+  hraw = chash->hash_fn (v, chash->user_data);
+  shard = sc_chash_shard (chash, hraw);
+
+  sc_chash_lock (chash, shard);
+  result = sc_hash_lookup_hashed (chash->shards[shard], v, hraw, &f);
+  if (result && found != NULL) {
+    *found = *f;
+  }
+  sc_chash_unlock (chash, shard);
+
+  return result;
+}
+
+int
+sc_chash_insert_unique (sc_chash_t * chash, void *v, void **found)
+{
+  int                 shard, result;
+  unsigned            hraw;
+  void              **f;
+
+  hraw = chash->hash_fn (v, chash->user_data);
+  shard = sc_chash_shard (chash, hraw);
+
+  sc_chash_lock (chash, shard);
+  result = sc_hash_insert_unique_hashed (chash->shards[shard], v, hraw, &f);
+  if (found != NULL) {
+    *found = *f;
+  }
+  sc_chash_unlock (chash, shard);
+
+  return result;
+}
+
+int
+sc_chash_remove (sc_chash_t * chash, void *v, void **found)
+{
+  int                 shard, result;
+  unsigned            hraw;
+
+  hraw = chash->hash_fn (v, chash->user_data);
+  shard = sc_chash_shard (chash, hraw);
+
+  sc_chash_lock (chash, shard);
+  result = sc_hash_remove_hashed (chash->shards[shard], v, hraw, found);
+  sc_chash_unlock (chash, shard);
+
+  return result;
+}
+
+/** Iterate over one shard while holding its lock.
+ * \return False if the callback asked to stop.
+ */
+static int
+sc_chash_foreach_shard_ext (sc_chash_t * chash, int shard,
+                            sc_hash_foreach_t fn)
+{
+  size_t              slot;
+  sc_list_t          *list;
+  sc_link_t          *lynk;
+  sc_hash_t          *hash = chash->shards[shard];
+
+  sc_chash_lock (chash, shard);
+  for (slot = 0; slot < hash->slots->elem_count; ++slot) {
+    list = (sc_list_t *) sc_array_index (hash->slots, slot);
+    for (lynk = list->first; lynk != NULL; lynk = lynk->next) {
+      if (!fn (&lynk->data, hash->user_data)) {
+        sc_chash_unlock (chash, shard);
+        return 0;
+      }
+    }
+  }
+  sc_chash_unlock (chash, shard);
+
+  return 1;
+}
+
+void
+sc_chash_foreach_shard (sc_chash_t * chash, int shard, sc_hash_foreach_t fn)
+{
+  SC_ASSERT (0 <= shard && shard < chash->num_shards);
+
+  (void) sc_chash_foreach_shard_ext (chash, shard, fn);
+}
+
+void
+sc_chash_foreach (sc_chash_t * chash, sc_hash_foreach_t fn)
+{
+  int                 i;
+
+  for (i = 0; i < chash->num_shards; ++i) {
+    if (!sc_chash_foreach_shard_ext (chash, i, fn)) {
+      return;
+    }
+  }
+}
+
+#ifdef SC_ENABLE_PTHREAD
+
+typedef struct sc_chash_foreach_data
+{
+  pthread_t           thread;
+  int                 first, last;
+  sc_chash_t         *chash;
+  sc_hash_foreach_t   fn;
+}
+sc_chash_foreach_data_t;
+
+static void        *
+sc_chash_foreach_thread (void *v)
+{
+  int                 i;
+  sc_chash_foreach_data_t *td = (sc_chash_foreach_data_t *) v;
+
+  for (i = td->first; i < td->last; ++i) {
+    if (!sc_chash_foreach_shard_ext (td->chash, i, td->fn)) {
+      break;
+    }
+  }
+  return v;
+}
+
+#endif /* SC_ENABLE_PTHREAD */
+
+void
+sc_chash_foreach_parallel (sc_chash_t * chash, sc_hash_foreach_t fn,
+                           int num_threads)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 i, pth;
+  void               *exitval;
+  sc_chash_foreach_data_t *td;
+
+  SC_ASSERT (num_threads >= 0);
+  num_threads = SC_MIN (num_threads, chash->num_shards);
+  if (num_threads <= 1) {
+    sc_chash_foreach (chash, fn);
+    return;
+  }
+
+  /* thread i works on a contiguous range of shards */
+  td = SC_ALLOC (sc_chash_foreach_data_t, num_threads);
+  for (i = 0; i < num_threads; ++i) {
+    td[i].first = (int) (((long) chash->num_shards * i) / num_threads);
+    td[i].last = (int) (((long) chash->num_shards * (i + 1)) / num_threads);
+    td[i].chash = chash;
+    td[i].fn = fn;
+    pth = pthread_create (&td[i].thread, NULL, sc_chash_foreach_thread,
+                          &td[i]);
+    SC_CHECK_ABORTF (pth == 0, "pthread_create error %d", pth);
+  }
+  for (i = 0; i < num_threads; ++i) {
+    pth = pthread_join (td[i].thread, &exitval);
+    SC_CHECK_ABORT (pth == 0, "Fail in pthread_join");
+    SC_ASSERT (exitval == &td[i]);
+  }
+  SC_FREE (td);
+#else
+  sc_chash_foreach (chash, fn);
+#endif
+}
+
+/* flat hash table routines */
+
+static const int    sc_fhash_minimal_log = 8;
+
+/** Map a hash value to its home slot by Fibonacci hashing.
+ * This spreads weak hash functions across the power-of-two table.
+ */
+static inline size_t
+sc_fhash_home (const sc_fhash_t * hash, unsigned hval)
+{
+  return (size_t) (((uint64_t) hval * 0x9E3779B97F4A7C15ULL) >> hash->shift);
+}
+
+static void
+sc_fhash_alloc_slots (sc_fhash_t * hash, int log_size)
+{
+  const size_t        new_size = (size_t) 1 << log_size;
+
+  sc_array_resize (hash->slots, new_size);
+  memset (hash->slots->array, 0, new_size * sizeof (sc_fhash_slot_t));
+  hash->mask = new_size - 1;
+  hash->shift = 64 - log_size;
+}
+
+/** Place an object known not to be contained by Robin Hood insertion.
+ * \return The slot that now holds the object.
+ */
+static sc_fhash_slot_t *
+sc_fhash_place (sc_fhash_t * hash, size_t pos, unsigned psl,
+                void *v, unsigned hval)
+{
+  sc_fhash_slot_t    *slots = (sc_fhash_slot_t *) hash->slots->array;
+  sc_fhash_slot_t    *s, *result = NULL;
+  sc_fhash_slot_t     carry, temp;
+
+  carry.data = v;
+  carry.hash = hval;
+  carry.psl = psl;
+  for (;;) {
+    s = slots + pos;
+    if (s->psl == 0) {
+      *s = carry;
+      return result != NULL ? result : s;
+    }
+    if (s->psl < carry.psl) {
+      /* the resident is closer to its home slot: take its place */
+      temp = *s;
+      *s = carry;
+      carry = temp;
+      if (result == NULL) {
+        result = s;
+      }
+    }
+    pos = (pos + 1) & hash->mask;
+    ++carry.psl;
+  }
+}
+
+static void
+sc_fhash_resize (sc_fhash_t * hash, int log_size)
+{
+  size_t              zz, old_size;
+  sc_fhash_slot_t    *s;
+  sc_array_t         *old_slots = hash->slots;
+
+  ++hash->resize_actions;
+
+  hash->slots = sc_array_new (sizeof (sc_fhash_slot_t));
+  sc_fhash_alloc_slots (hash, log_size);
+
+  /* reinsert with the cached hash values: no user callbacks needed */
+  old_size = old_slots->elem_count;
+  for (zz = 0; zz < old_size; ++zz) {
+    s = (sc_fhash_slot_t *) old_slots->array + zz;
+    if (s->psl > 0) {
+      (void) sc_fhash_place (hash, sc_fhash_home (hash, s->hash), 1,
+                             s->data, s->hash);
+    }
+  }
+  sc_array_destroy (old_slots);
+}
+
+size_t
+sc_fhash_memory_used (sc_fhash_t * hash)
+{
+  return sizeof (sc_fhash_t) + sc_array_memory_used (hash->slots, 1);
+}
+
+sc_fhash_t         *
+sc_fhash_new (sc_hash_function_t hash_fn, sc_equal_function_t equal_fn,
+              void *user_data)
+{
+  sc_fhash_t         *hash;
+
+  hash = SC_ALLOC (sc_fhash_t, 1);
+
+  hash->elem_count = 0;
+  hash->resize_checks = 0;
+  hash->resize_actions = 0;
+  hash->hash_fn = hash_fn;
+  hash->equal_fn = equal_fn;
+  hash->user_data = user_data;
+
+  hash->slots = sc_array_new (sizeof (sc_fhash_slot_t));
+  sc_fhash_alloc_slots (hash, sc_fhash_minimal_log);
+
+  return hash;
+}
+
+void
+sc_fhash_destroy (sc_fhash_t * hash)
+{
+  sc_array_destroy (hash->slots);
+
+  SC_FREE (hash);
+}
+
+void
+sc_fhash_truncate (sc_fhash_t * hash)
+{
+  sc_array_reset (hash->slots);
+  sc_fhash_alloc_slots (hash, sc_fhash_minimal_log);
+  hash->elem_count = 0;
+}
+
+/** Probe for an object.
+ * \param [out] pos     The slot of the object if found, otherwise the slot
+ *                      where it would be placed.
+ * \param [out] psl     The probe sequence length plus one at \a pos.
+ * \return              True if found.
+ */
+static int
+sc_fhash_probe (sc_fhash_t * hash, void *v, unsigned hval,
+                size_t * pos, unsigned *psl)
+{
+  size_t              p;
+  unsigned            d;
+  sc_fhash_slot_t    *s;
+  sc_fhash_slot_t    *slots = (sc_fhash_slot_t *) hash->slots->array;
+
+  p = sc_fhash_home (hash, hval);
+  for (d = 1;; ++d) {
+    s = slots + p;
+    if (s->psl < d) {
+      /* empty slot or a resident closer to home: v cannot be further on */
+      *pos = p;
+      *psl = d;
+      return 0;
+    }
+    if (s->hash == hval && hash->equal_fn (s->data, v, hash->user_data)) {
+      *pos = p;
+      *psl = d;
+      return 1;
+    }
+    p = (p + 1) & hash->mask;
+  }
+}
+
+int
+sc_fhash_lookup (sc_fhash_t * hash, void *v, void ***found)
+{
+  size_t              pos;
+  unsigned            psl;
+  unsigned            hval;
+
+  hval = hash->hash_fn (v, hash->user_data);
+  if (sc_fhash_probe (hash, v, hval, &pos, &psl)) {
+    if (found != NULL) {
+      *found = &((sc_fhash_slot_t *) hash->slots->array)[pos].data;
+    }
+    return 1;
+  }
+  return 0;
+}
+
+int
+sc_fhash_insert_unique (sc_fhash_t * hash, void *v, void ***found)
+{
+  size_t              pos;
+  unsigned            psl;
+  unsigned            hval;
+  sc_fhash_slot_t    *s;
+
+  hval = hash->hash_fn (v, hash->user_data);
+  if (sc_fhash_probe (hash, v, hval, &pos, &psl)) {
+    if (found != NULL) {
+      *found = &((sc_fhash_slot_t *) hash->slots->array)[pos].data;
+    }
+    return 0;
+  }
+
+  /* grow at a load factor of 7/8 and probe again in the new table */
+  ++hash->resize_checks;
+  if (8 * (hash->elem_count + 1) > 7 * hash->slots->elem_count) {
+    sc_fhash_resize (hash, 65 - hash->shift);
+    SC_EXECUTE_ASSERT_FALSE (sc_fhash_probe (hash, v, hval, &pos, &psl));
+  }
+
+  s = sc_fhash_place (hash, pos, psl, v, hval);
+  if (found != NULL) {
+    *found = &s->data;
+  }
+  ++hash->elem_count;
+
+  return 1;
+}
+
+int
+sc_fhash_remove (sc_fhash_t * hash, void *v, void **found)
+{
+  size_t              pos, next;
+  unsigned            psl;
+  unsigned            hval;
+  sc_fhash_slot_t    *slots = (sc_fhash_slot_t *) hash->slots->array;
+
+  hval = hash->hash_fn (v, hash->user_data);
+  if (!sc_fhash_probe (hash, v, hval, &pos, &psl)) {
+    return 0;
+  }
+  if (found != NULL) {
+    *found = slots[pos].data;
+  }
+
+  /* backward shift deletion leaves no tombstones */
+  for (;;) {
+    next = (pos + 1) & hash->mask;
+    if (slots[next].psl <= 1) {
+      break;
+    }
+    slots[pos] = slots[next];
+    --slots[pos].psl;
+    pos = next;
+  }
+  slots[pos].data = NULL;
+  slots[pos].hash = 0;
+  slots[pos].psl = 0;
+  --hash->elem_count;
+
+  /* shrink with hysteresis when the load drops below 1/8 */
+  if (hash->shift < 64 - sc_fhash_minimal_log &&
+      8 * hash->elem_count < hash->slots->elem_count) {
+    ++hash->resize_checks;
+    sc_fhash_resize (hash, 63 - hash->shift);
+  }
+
+  return 1;
+}
+
+void
+sc_fhash_foreach (sc_fhash_t * hash, sc_hash_foreach_t fn)
+{
+  size_t              zz;
+  sc_fhash_slot_t    *s;
+
+  for (zz = 0; zz < hash->slots->elem_count; ++zz) {
+    s = (sc_fhash_slot_t *) hash->slots->array + zz;
+    if (s->psl > 0 && !fn (&s->data, hash->user_data)) {
+      return;
+    }
+  }
+}
+
+void
+sc_fhash_print_statistics (int package_id, int log_priority,
+                           sc_fhash_t * hash)
+{
+  size_t              zz, count;
+  unsigned            maxpsl;
+  double              a, sum, squaresum;
+  double              avg, sqr, std;
+  sc_fhash_slot_t    *s;
+
+  count = 0;
+  maxpsl = 0;
+  sum = 0.;
+  squaresum = 0.;
+  for (zz = 0; zz < hash->slots->elem_count; ++zz) {
+    s = (sc_fhash_slot_t *) hash->slots->array + zz;
+    if (s->psl > 0) {
+      ++count;
+      maxpsl = SC_MAX (maxpsl, s->psl);
+      a = (double) (s->psl - 1);
+      sum += a;
+      squaresum += a * a;
+    }
+  }
+  SC_ASSERT (count == hash->elem_count);
+
+  avg = count > 0 ? sum / (double) count : 0.;
+  sqr = count > 0 ? squaresum / (double) count - avg * avg : 0.;
+  std = sqrt (sqr);
+  SC_GEN_LOGF (package_id, SC_LC_NORMAL, log_priority,
+               "Flat hash size %lu load %.3g probe avg %.3g std %.3g"
+               " max %u checks %lu %lu\n",
+               (unsigned long) hash->slots->elem_count,
+               (double) count / (double) hash->slots->elem_count, avg, std,
+               maxpsl > 0 ? maxpsl - 1 : 0,
+               (unsigned long) hash->resize_checks,
+               (unsigned long) hash->resize_actions);
+}
+
 /* hash array routines */
 
 size_t
@@ -1491,6 +3721,297 @@ sc_hash_array_rip (sc_hash_array_t * hash_array, sc_array_t * rip)
   SC_FREE (hash_array);
 }
 
+/* flat hash array routines */
+
+#if defined (__AVX2__)
+#define SC_FHASH_ARRAY_GROUP 8
+#else
+#define SC_FHASH_ARRAY_GROUP 4
+#endif
+
+static const int    sc_fhash_array_minimal_log = 6;
+
+/** Compare a group of stored hash values against one value.
+ * \param [out] match   Bit i is set if hashes[i] == hval.
+ * \param [out] empty   Bit i is set if slot i is empty.
+ */
+static inline void
+sc_fhash_array_group (const unsigned *hashes, unsigned hval,
+                      unsigned *match, unsigned *empty)
+{
+#if defined (__AVX2__)
+  const __m256i       group = _mm256_loadu_si256 ((const __m256i *) hashes);
+
+  *match = (unsigned) _mm256_movemask_ps
+    (_mm256_castsi256_ps (_mm256_cmpeq_epi32
+                          (group, _mm256_set1_epi32 ((int) hval))));
+  *empty = (unsigned) _mm256_movemask_ps
+    (_mm256_castsi256_ps (_mm256_cmpeq_epi32
+                          (group, _mm256_setzero_si256 ())));
+#elif defined (__SSE2__)
+  const __m128i       group = _mm_loadu_si128 ((const __m128i *) hashes);
+
+  *match = (unsigned) _mm_movemask_ps
+    (_mm_castsi128_ps (_mm_cmpeq_epi32 (group, _mm_set1_epi32 ((int) hval))));
+  *empty = (unsigned) _mm_movemask_ps
+    (_mm_castsi128_ps (_mm_cmpeq_epi32 (group, _mm_setzero_si128 ())));
+#else
+  int                 i;
+
+  *match = *empty = 0;
+  for (i = 0; i < SC_FHASH_ARRAY_GROUP; ++i) {
+    *match |= (unsigned) (hashes[i] == hval) << i;
+    *empty |= (unsigned) (hashes[i] == 0) << i;
+  }
+#endif
+}
+
+/** Return the index of the lowest bit set in a nonzero mask. */
+static inline int
+sc_fhash_array_lowbit (unsigned mask)
+{
+#if defined (__GNUC__)
+  return __builtin_ctz (mask);
+#else
+  int                 i;
+
+  SC_ASSERT (mask != 0);
+  for (i = 0; !(mask & 1U); ++i) {
+    mask >>= 1;
+  }
+  return i;
+#endif
+}
+
+static inline unsigned
+sc_fhash_array_hash (sc_fhash_array_t * fa, void *v)
+{
+  const unsigned      hval = fa->hash_fn (v, fa->user_data);
+
+  /* the value 0 is reserved for empty slots */
+  return hval != 0 ? hval : 1;
+}
+
+static inline size_t
+sc_fhash_array_home (const sc_fhash_array_t * fa, unsigned hval)
+{
+  return (size_t) (((uint64_t) hval * 0x9E3779B97F4A7C15ULL) >> fa->shift);
+}
+
+/** Probe for an object in groups of stored hash values.
+ * \param [out] slot    The slot of the object if found, otherwise the first
+ *                      free slot in its probe sequence.
+ * \return              True if found.
+ */
+static int
+sc_fhash_array_probe (sc_fhash_array_t * fa, void *v, unsigned hval,
+                      size_t * slot)
+{
+  int                 lane;
+  unsigned            match, empty, lanes;
+  size_t              home, g;
+  size_t              index;
+  const unsigned     *hashes = (const unsigned *) fa->hashes.array;
+  const size_t       *indices = (const size_t *) fa->indices.array;
+
+  home = sc_fhash_array_home (fa, hval);
+  g = home & ~(size_t) (SC_FHASH_ARRAY_GROUP - 1);
+
+  /* ignore the slots before home in the first group */
+  lanes = ~0U << (home - g);
+  for (;;) {
+    sc_fhash_array_group (hashes + g, hval, &match, &empty);
+    match &= lanes;
+    empty &= lanes;
+    if (empty) {
+      /* objects are never stored beyond the first empty slot */
+      match &= (1U << sc_fhash_array_lowbit (empty)) - 1;
+    }
+    while (match) {
+      lane = sc_fhash_array_lowbit (match);
+      index = indices[g + lane];
+      if (fa->equal_fn (sc_array_index (&fa->a, index), v, fa->user_data)) {
+        *slot = g + lane;
+        return 1;
+      }
+      match &= match - 1;
+    }
+    if (empty) {
+      *slot = g + sc_fhash_array_lowbit (empty);
+      return 0;
+    }
+    g = (g + SC_FHASH_ARRAY_GROUP) & fa->mask;
+    lanes = ~0U;
+  }
+}
+
+static void
+sc_fhash_array_alloc_slots (sc_fhash_array_t * fa, int log_size)
+{
+  const size_t        new_size = (size_t) 1 << log_size;
+
+  SC_ASSERT (new_size >= SC_FHASH_ARRAY_GROUP);
+  sc_array_resize (&fa->hashes, new_size);
+  sc_array_resize (&fa->indices, new_size);
+  memset (fa->hashes.array, 0, new_size * sizeof (unsigned));
+  fa->mask = new_size - 1;
+  fa->shift = 64 - log_size;
+}
+
+static void
+sc_fhash_array_resize (sc_fhash_array_t * fa, int log_size)
+{
+  size_t              zz, slot;
+  unsigned            hval;
+  unsigned           *hashes;
+  size_t             *indices;
+  sc_array_t          old_hashes, old_indices;
+
+  old_hashes = fa->hashes;
+  old_indices = fa->indices;
+  sc_array_init (&fa->hashes, sizeof (unsigned));
+  sc_array_init (&fa->indices, sizeof (size_t));
+  sc_fhash_array_alloc_slots (fa, log_size);
+  hashes = (unsigned *) fa->hashes.array;
+  indices = (size_t *) fa->indices.array;
+
+  /* all objects are distinct: place them without calling equal_fn */
+  for (zz = 0; zz < old_hashes.elem_count; ++zz) {
+    hval = ((unsigned *) old_hashes.array)[zz];
+    if (hval != 0) {
+      slot = sc_fhash_array_home (fa, hval);
+      while (hashes[slot] != 0) {
+        slot = (slot + 1) & fa->mask;
+      }
+      hashes[slot] = hval;
+      indices[slot] = ((size_t *) old_indices.array)[zz];
+    }
+  }
+  sc_array_reset (&old_hashes);
+  sc_array_reset (&old_indices);
+}
+
+size_t
+sc_fhash_array_memory_used (sc_fhash_array_t * fa)
+{
+  return sizeof (sc_fhash_array_t) + sc_array_memory_used (&fa->a, 0) +
+    sc_array_memory_used (&fa->hashes, 0) +
+    sc_array_memory_used (&fa->indices, 0);
+}
+
+sc_fhash_array_t   *
+sc_fhash_array_new (size_t elem_size, sc_hash_function_t hash_fn,
+                    sc_equal_function_t equal_fn, void *user_data)
+{
+  sc_fhash_array_t   *fhash_array;
+
+  fhash_array = SC_ALLOC (sc_fhash_array_t, 1);
+
+  sc_array_init (&fhash_array->a, elem_size);
+  sc_array_init (&fhash_array->hashes, sizeof (unsigned));
+  sc_array_init (&fhash_array->indices, sizeof (size_t));
+  fhash_array->hash_fn = hash_fn;
+  fhash_array->equal_fn = equal_fn;
+  fhash_array->user_data = user_data;
+  sc_fhash_array_alloc_slots (fhash_array, sc_fhash_array_minimal_log);
+
+  return fhash_array;
+}
+
+void
+sc_fhash_array_destroy (sc_fhash_array_t * fhash_array)
+{
+  sc_array_reset (&fhash_array->hashes);
+  sc_array_reset (&fhash_array->indices);
+  sc_array_reset (&fhash_array->a);
+
+  SC_FREE (fhash_array);
+}
+
+int
+sc_fhash_array_is_valid (sc_fhash_array_t * fhash_array)
+{
+  int                 found;
+  size_t              zz, position;
+  void               *v;
+
+  for (zz = 0; zz < fhash_array->a.elem_count; ++zz) {
+    v = sc_array_index (&fhash_array->a, zz);
+    found = sc_fhash_array_lookup (fhash_array, v, &position);
+    if (!found || position != zz) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+void
+sc_fhash_array_truncate (sc_fhash_array_t * fhash_array)
+{
+  sc_array_reset (&fhash_array->hashes);
+  sc_array_reset (&fhash_array->indices);
+  sc_array_reset (&fhash_array->a);
+  sc_fhash_array_alloc_slots (fhash_array, sc_fhash_array_minimal_log);
+}
+
+int
+sc_fhash_array_lookup (sc_fhash_array_t * fhash_array, void *v,
+                       size_t * position)
+{
+  size_t              slot;
+
+  if (sc_fhash_array_probe (fhash_array, v,
+                            sc_fhash_array_hash (fhash_array, v), &slot)) {
+    if (position != NULL) {
+      *position = ((size_t *) fhash_array->indices.array)[slot];
+    }
+    return 1;
+  }
+  return 0;
+}
+
+void               *
+sc_fhash_array_insert_unique (sc_fhash_array_t * fhash_array, void *v,
+                              size_t * position)
+{
+  size_t              slot;
+  unsigned            hval;
+  const size_t        count = fhash_array->a.elem_count;
+
+  hval = sc_fhash_array_hash (fhash_array, v);
+  if (sc_fhash_array_probe (fhash_array, v, hval, &slot)) {
+    if (position != NULL) {
+      *position = ((size_t *) fhash_array->indices.array)[slot];
+    }
+    return NULL;
+  }
+
+  /* linear probing is kept at a load factor of at most 3/4 */
+  if (4 * (count + 1) > 3 * fhash_array->hashes.elem_count) {
+    sc_fhash_array_resize (fhash_array, 65 - fhash_array->shift);
+    SC_EXECUTE_ASSERT_FALSE (sc_fhash_array_probe (fhash_array, v, hval,
+                                                   &slot));
+  }
+
+  ((unsigned *) fhash_array->hashes.array)[slot] = hval;
+  ((size_t *) fhash_array->indices.array)[slot] = count;
+  if (position != NULL) {
+    *position = count;
+  }
+  return sc_array_push (&fhash_array->a);
+}
+
+void
+sc_fhash_array_rip (sc_fhash_array_t * fhash_array, sc_array_t * rip)
+{
+  sc_array_reset (&fhash_array->hashes);
+  sc_array_reset (&fhash_array->indices);
+  memcpy (rip, &fhash_array->a, sizeof (sc_array_t));
+
+  SC_FREE (fhash_array);
+}
+
 void
 sc_recycle_array_init (sc_recycle_array_t * rec_array, size_t elem_size)
 {
@@ -81,6 +81,41 @@ typedef int         (*sc_equal_function_t) (const void *v1,
  */
 typedef int         (*sc_hash_foreach_t) (void **v, const void *u);
 
+/** The sc_arena object is defined below with its functions. */
+typedef struct sc_arena sc_arena_t;
+
+/** The rule by which an sc_array grows its allocation. */
+typedef enum sc_array_growth_type
+{
+  SC_ARRAY_GROWTH_POW2 = 0,     /**< Round up to a power of two bytes. */
+  SC_ARRAY_GROWTH_GEOMETRIC,    /**< Multiply the allocation by a factor. */
+  SC_ARRAY_GROWTH_CHUNK         /**< Round up to a multiple of a chunk. */
+}
+sc_array_growth_type_t;
+
+/** A growth policy that may be shared by any number of arrays.
+ * Without a policy, an array rounds its allocation up to a power of two
+ * and shrinks it as soon as half of it suffices, or frees it on zero count.
+ * With a policy, the shrink rule is controlled by its  shrink member.
+ */
+typedef struct sc_array_growth
+{
+  sc_array_growth_type_t type;  /**< How to grow the allocation. */
+  double              factor;   /**< SC_ARRAY_GROWTH_GEOMETRIC: the
+                                     allocation grows at least by this
+                                     factor, which must exceed 1. */
+  size_t              chunk;    /**< SC_ARRAY_GROWTH_CHUNK: the allocation
+                                     is a multiple of this many elements,
+                                     which must be positive. */
+  int                 shrink;   /**< If 0, never shrink the allocation,
+                                     not even on a zero element count.
+                                     Otherwise shrink when at most
+                                     1 / shrink of it is used.  The
+                                     default rule corresponds to 2,
+                                     larger values add hysteresis. */
+}
+sc_array_growth_t;
+
 /** The sc_array object provides a dynamic array of equal-size elements.
  * Elements are accessed by their 0-based index.  Their address may change.
  * The number of elements (== elem_count) of the array can be changed by 
@@ -102,6 +137,8 @@ typedef struct sc_array
                                            distinguishes an array of size 0
                                            from a view of size 0 */
   char               *array;    /**< linear array to store elements */
+  sc_arena_t         *arena;    /**< if not NULL, owns the array memory */
+  const sc_array_growth_t *growth;      /**< if not NULL, the growth policy */
 }
 sc_array_t;
 
@@ -115,7 +152,8 @@ sc_array_t;
  * \param [in] array       The array.
  * \param [in] is_dynamic  True if created with sc_array_new,
  *                         false if initialized with sc_array_init
- * \return                 Memory used in bytes.
+ * \return                 Memory used in bytes, which is zero for an
+ *                         array that uses an arena.
  */
 size_t              sc_array_memory_used (sc_array_t * array, int is_dynamic);
 
@@ -155,7 +193,22 @@ sc_array_t         *sc_array_new_view (sc_array_t * array,
 sc_array_t         *sc_array_new_data (void *base,
                                        size_t elem_size, size_t elem_count);
 
+/** Creates a new array structure that takes its memory from an arena.
+ * \param [in] elem_size    Size of one array element in bytes.
+ * \param [in] elem_count   Initial number of array elements.
+ * \param [in] arena        If NULL, this is equivalent to
+ *                          \ref sc_array_new_count.  Otherwise the
+ *                          structure and all elements are allocated in the
+ *                          arena and released with it; growing the array
+ *                          leaves the old elements in the arena until then.
+ * \return                  Return an array
+ *                          with allocated but uninitialized elements.
+ */
+sc_array_t         *sc_array_new_arena (size_t elem_size, size_t elem_count,
+                                        sc_arena_t * arena);
+
 /** Destroys an array structure.
+ * For an array created with an arena this does not free any memory.
  * \param [in] array    The array to be destroyed.
  */
 void                sc_array_destroy (sc_array_t * array);
@@ -175,6 +228,19 @@ void                sc_array_init (sc_array_t * array, size_t elem_size);
 void                sc_array_init_size (sc_array_t * array,
                                         size_t elem_size, size_t elem_count);
 
+/** Initializes an already allocated (or static) array structure
+ * whose elements are allocated in an arena.
+ * \param [in,out]  array       Array structure to be initialized.
+ * \param [in] elem_size        Size of one array element in bytes.
+ * \param [in] elem_count       Number of initial array elements.
+ * \param [in] arena            If NULL, this is equivalent to
+ *                              \ref sc_array_init_size.  Otherwise
+ *                              sc_array_reset is not required.
+ */
+void                sc_array_init_arena (sc_array_t * array,
+                                         size_t elem_size, size_t elem_count,
+                                         sc_arena_t * arena);
+
 /** Initializes an already allocated (or static) view from existing sc_array_t.
  * The array view returned does not require sc_array_reset (doesn't hurt though).
  * \param [in,out] view  Array structure to be initialized.
@@ -200,6 +266,29 @@ void                sc_array_init_view (sc_array_t * view, sc_array_t * array,
 void                sc_array_init_data (sc_array_t * view, void *base,
                                         size_t elem_size, size_t elem_count);
 
+/** Set the growth policy of an array that is not a view.
+ * \param [in,out] array    Its future reallocations follow the policy.
+ * \param [in] growth       The policy is referenced, not copied, and must
+ *                          stay valid as long as the array is resized.
+ *                          If NULL, the default policy is restored.
+ */
+void                sc_array_set_growth (sc_array_t * array,
+                                         const sc_array_growth_t * growth);
+
+/** Make sure an array can hold a number of elements without reallocation.
+ * The element count is not changed.  Not allowed for views.
+ * \param [in,out] array    If its allocation is less than \a elem_count
+ *                          elements, it is reallocated to exactly this.
+ * \param [in] elem_count   Number of elements to reserve memory for.
+ */
+void                sc_array_reserve (sc_array_t * array, size_t elem_count);
+
+/** Reduce the allocation of an array to its current element count.
+ * Not allowed for views.  Does nothing for arrays that use an arena.
+ * \param [in,out] array    If its count is zero, its memory is freed.
+ */
+void                sc_array_shrink_to_fit (sc_array_t * array);
+
 /** Sets the array count to zero and frees all elements.
  * This function turns a view into a newly initialized array.
  * \param [in,out]  array       Array structure to be reset.
@@ -226,7 +315,8 @@ void                sc_array_truncate (sc_array_t * array);
  *                          If it is less, the number of elements in the
  *                          array is reduced without reallocating memory.
  *                          The exception is a \b new_count of zero
- *                          specified for an array that is not a view:
+ *                          specified for an array that is not a view
+ *                          and has no growth policy:
  *                          In this case \ref sc_array_reset is equivalent.
  */
 void                sc_array_rewind (sc_array_t * array, size_t new_count);
@@ -239,7 +329,8 @@ void                sc_array_rewind (sc_array_t * array, size_t new_count);
  * \param [in,out] array    The element count and address is modified.
  * \param [in] new_count    New element count of the array.
  *                          If it is zero and the array is not a view,
- *                          the effect equals \ref sc_array_reset.
+ *                          the effect equals \ref sc_array_reset unless
+ *                          the growth policy of the array says otherwise.
  */
 void                sc_array_resize (sc_array_t * array, size_t new_count);
 
@@ -250,6 +341,63 @@ void                sc_array_resize (sc_array_t * array, size_t new_count);
  */
 void                sc_array_copy (sc_array_t * dest, sc_array_t * src);
 
+/** Append elements stored contiguously in memory to an array.
+ * The array is resized only once.
+ * \param [in,out] array    The elements are added at its end.
+ * \param [in] data         Elements of the array's size; they may be
+ *                          part of the array itself.
+ * \param [in] count        Number of elements to append.
+ * \return                  Pointer to the first appended element.
+ */
+void               *sc_array_append_data (sc_array_t * array,
+                                          const void *data, size_t count);
+
+/** Append all elements of one array to another.
+ * Both arrays must have equal element sizes and may be the same.
+ * \param [in,out] dest     The elements are added at its end.
+ * \param [in] src          Array whose elements are appended.
+ * \return                  Pointer to the first appended element.
+ */
+void               *sc_array_append (sc_array_t * dest, sc_array_t * src);
+
+/** Insert a range of elements into an array.
+ * The elements behind the position are moved back by one memmove.
+ * \param [in,out] array    The array is resized only once.
+ * \param [in] position     Index of the first inserted element,
+ *                          at most the element count of the array.
+ * \param [in] count        Number of elements to insert.
+ * \param [in] data         If not NULL, \a count elements are copied from
+ *                          here; they must not be part of the array.
+ *                          If NULL, the inserted elements are undefined.
+ * \return                  Pointer to the first inserted element.
+ */
+void               *sc_array_insert_range (sc_array_t * array,
+                                           size_t position, size_t count,
+                                           const void *data);
+
+/** Remove a range of elements from an array.
+ * The elements behind the range are moved forward by one memmove.
+ * \param [in,out] array    The array is resized only once.
+ * \param [in] position     Index of the first removed element.
+ * \param [in] count        Number of elements to remove.  The range must
+ *                          lie within the array.
+ */
+void                sc_array_erase_range (sc_array_t * array,
+                                          size_t position, size_t count);
+
+/** Remove all elements of an array that satisfy a predicate.
+ * The remaining elements keep their order.  Each run of them is moved
+ * by one memmove and the array is resized only once.
+ * \param [in,out] array    The array to compact.
+ * \param [in] predicate    Returns true for an element to remove.
+ * \param [in] user         Passed to the predicate unchanged.
+ * \return                  Number of removed elements.
+ */
+size_t              sc_array_erase_if (sc_array_t * array,
+                                       int (*predicate) (const void *elem,
+                                                         void *user),
+                                       void *user);
+
 /** Sorts the array in ascending order wrt. the comparison function.
  * \param [in] array    The array to sort.
  * \param [in] compar   The comparison function to be used.
@@ -258,6 +406,32 @@ void                sc_array_sort (sc_array_t * array,
                                    int (*compar) (const void *,
                                                   const void *));
 
+/** Sort an array by an integer key stored in each element.
+ * This is a stable LSD radix sort that calls no comparison function.
+ * For signed keys, the result is ordered as with sc_int8_compare,
+ * sc_int16_compare, sc_int32_compare, or sc_int64_compare applied to the
+ * key; unsigned keys are ordered by their unsigned value.
+ * \param [in,out] array    The array to sort, may be a view.
+ * \param [in] key_offset   Byte offset of the key within each element.
+ * \param [in] key_size     Size of the key in bytes: 1, 2, 4, or 8.
+ * \param [in] is_signed    True if the key is a signed integer.
+ */
+void                sc_array_sort_radix (sc_array_t * array,
+                                         size_t key_offset, size_t key_size,
+                                         int is_signed);
+
+/** Sort an array by an integer key and apply the same reordering to a
+ * payload array.  See sc_array_sort_radix for the parameters.
+ * \param [in,out] payload  Array with the same element count as \a array.
+ *                          Its element i moves together with element i
+ *                          of \a array.  May be NULL.
+ */
+void                sc_array_sort_radix_payload (sc_array_t * array,
+                                                 size_t key_offset,
+                                                 size_t key_size,
+                                                 int is_signed,
+                                                 sc_array_t * payload);
+
 /** Check whether the array is sorted wrt. the comparison function.
  * \param [in] array    The array to check.
  * \param [in] compar   The comparison function to be used.
@@ -285,6 +459,46 @@ void                sc_array_uniq (sc_array_t * array,
                                    int (*compar) (const void *,
                                                   const void *));
 
+/** Sort an array in parallel using several threads.
+ * Each thread sorts one chunk with qsort, then the chunks are merged
+ * stably in rounds, where all threads share the work of every round.
+ * The result is the same as with sc_array_sort whenever elements that
+ * compare equal are identical, and it only depends on num_threads.
+ * If configured without --enable-pthread, OpenMP is used if enabled.
+ * Otherwise the chunks are processed one after the other.
+ * \param [in,out] array    The array to sort, may be a view.
+ * \param [in] compar       The comparison function, must be thread safe.
+ * \param [in] num_threads  Number of threads to use, at least 1.
+ */
+void                sc_array_sort_threaded (sc_array_t * array,
+                                            int (*compar) (const void *,
+                                                           const void *),
+                                            int num_threads);
+
+/** Check in parallel whether the array is sorted.
+ * \param [in] array        The array to check.
+ * \param [in] compar       The comparison function, must be thread safe.
+ * \param [in] num_threads  Number of threads to use, at least 1.
+ * \return                  True if array is sorted, false otherwise.
+ */
+int                 sc_array_is_sorted_threaded (sc_array_t * array,
+                                                 int (*compar) (const void *,
+                                                                const void
+                                                                *),
+                                                 int num_threads);
+
+/** Remove duplicate entries from a sorted array in parallel.
+ * Keeps the same elements as sc_array_uniq.
+ * This function is not allowed for views.
+ * \param [in,out] array    The array size will be reduced as necessary.
+ * \param [in] compar       The comparison function, must be thread safe.
+ * \param [in] num_threads  Number of threads to use, at least 1.
+ */
+void                sc_array_uniq_threaded (sc_array_t * array,
+                                            int (*compar) (const void *,
+                                                           const void *),
+                                            int num_threads);
+
 /** Performs a binary search on an array. The array must be sorted.
  * \param [in] array   A sorted array to search in.
  * \param [in] key     An element to be searched for.
@@ -324,6 +538,34 @@ void                sc_array_split (sc_array_t * array, sc_array_t * offsets,
                                     size_t num_types, sc_array_type_t type_fn,
                                     void *data);
 
+/** Group the elements of an array by type in parallel and compute the
+ * offsets of the groups.  The array need not be sorted by type: the types
+ * are counted per thread, and a prefix sum over the counts yields where
+ * each thread scatters its elements.  The order within a type is kept.
+ * If the array is sorted by type, it is not changed, and the result is
+ * the same as with \ref sc_array_split.
+ * If configured without --enable-pthread, OpenMP is used if enabled.
+ * \param [in,out] array     Array whose elements are grouped by type.
+ *                           If k indexes \a array, then
+ *                           0 <= \a type_fn (\a array, k, \a data) <
+ *                           \a num_types.  Must not be a view if it is
+ *                           not sorted by type.
+ * \param [in,out] offsets   An initialized array of type size_t that is
+ *                           resized to \a num_types + 1 entries, as in
+ *                           \ref sc_array_split.
+ * \param [in] num_types     The number of possible types of objects.
+ * \param [in] type_fn       Returns the type of an object in the array.
+ *                           It must be thread safe and is called twice
+ *                           for every element of an unsorted array.
+ * \param [in] data          Arbitrary user data passed to \a type_fn.
+ * \param [in] num_threads   Number of threads to use, at least 1.
+ */
+void                sc_array_split_threaded (sc_array_t * array,
+                                             sc_array_t * offsets,
+                                             size_t num_types,
+                                             sc_array_type_t type_fn,
+                                             void *data, int num_threads);
+
 /** Determine whether \a array is an array of size_t's whose entries include
  * every integer 0 <= i < array->elem_count.
  * \param [in] array         An array.
@@ -347,6 +589,28 @@ int                 sc_array_is_permutation (sc_array_t * array);
 void                sc_array_permute (sc_array_t * array,
                                       sc_array_t * newindices, int keepperm);
 
+/** Permute an array out of place in parallel.
+ * Each thread copies a block of elements to their new positions in a
+ * scratch buffer, which is then copied back in parallel.
+ * The single-threaded \ref sc_array_permute needs less memory.
+ * If configured without --enable-pthread, OpenMP is used if enabled.
+ * \param [in,out] array      An array.  The data that on input is contained
+ *                            in \a array[i] will be contained in
+ *                            \a array[newindices[i]] on output.
+ * \param [in] newindices     Permutation array (see sc_array_is_permutation).
+ *                            It is not changed.
+ * \param [in,out] scratch    If not NULL, an array of the same element size
+ *                            that is resized and used as the buffer, so it
+ *                            can be reused between calls.  Its contents on
+ *                            output are undefined.  If NULL, a buffer is
+ *                            allocated internally.
+ * \param [in] num_threads    Number of threads to use, at least 1.
+ */
+void                sc_array_permute_threaded (sc_array_t * array,
+                                               sc_array_t * newindices,
+                                               sc_array_t * scratch,
+                                               int num_threads);
+
 /** Computes the adler32 checksum of array data (see zlib documentation).
  * This is a faster checksum than crc32, and it works with zeros as data.
  */
@@ -512,6 +776,125 @@ sc_array_push (sc_array_t * array)
   return sc_array_push_count (array, 1);
 }
 
+/** Handle returned for elements of a priority queue without index. */
+#define SC_PQUEUE_NO_HANDLE ((size_t) -1)
+
+/** The sc_pqueue object is a d-ary heap of equal-size elements.
+ * The smallest element with respect to the comparison function is on top.
+ * A larger arity makes the heap shallower and lets the children of a node
+ * share cache lines; 4 is a good choice for small elements.
+ * Optionally, the queue keeps an index that maps a handle for each element
+ * to its position in the heap.  This enables \ref sc_pqueue_update and
+ * \ref sc_pqueue_remove in O(log n).
+ * Elements move through a hole instead of being swapped, and popping sinks
+ * the hole to a leaf first, which saves one comparison per level.
+ */
+typedef struct sc_pqueue
+{
+  /* interface variables */
+  sc_array_t          heap;     /**< the elements in heap order */
+
+  /* implementation variables */
+  int                 arity;    /**< number of children of a node */
+  int                 indexed;  /**< boolean: keep handles and positions */
+  int                 (*compar) (const void *, const void *);
+  sc_array_t          handles;  /**< if indexed, handle of each position */
+  sc_array_t          positions;        /**< if indexed, position of each
+                                             handle or SC_PQUEUE_NO_HANDLE */
+  sc_array_t          free_handles;     /**< handles available for reuse */
+  char               *temp;     /**< one element of scratch memory */
+}
+sc_pqueue_t;
+
+/** Calculate the memory used by a priority queue.
+ * \param [in] pqueue      The priority queue.
+ * \return                 Memory used in bytes.
+ */
+size_t              sc_pqueue_memory_used (sc_pqueue_t * pqueue);
+
+/** Creates a new, empty priority queue.
+ * \param [in] elem_size    Size of one element in bytes.
+ * \param [in] arity        Number of children of each node, at least 2.
+ * \param [in] compar       The comparison function to be used.
+ * \param [in] indexed      If true, elements get handles that can be
+ *                          passed to \ref sc_pqueue_update and
+ *                          \ref sc_pqueue_remove.
+ * \return                  Returns an allocated priority queue.
+ */
+sc_pqueue_t        *sc_pqueue_new (size_t elem_size, int arity,
+                                   int (*compar) (const void *,
+                                                  const void *),
+                                   int indexed);
+
+/** Destroys a priority queue and all its elements.
+ * \param [in] pqueue       This priority queue is invalid afterwards.
+ */
+void                sc_pqueue_destroy (sc_pqueue_t * pqueue);
+
+/** Adds an element to a priority queue in O(log n).
+ * \param [in,out] pqueue   The priority queue.
+ * \param [in] elem         The element is copied into the queue.
+ * \return                  The handle of the element if the queue is
+ *                          indexed, otherwise SC_PQUEUE_NO_HANDLE.
+ *                          A handle stays valid until its element leaves
+ *                          the queue; then it may be reused.
+ */
+size_t              sc_pqueue_push (sc_pqueue_t * pqueue, const void *elem);
+
+/** Adds many elements to a priority queue at once.
+ * If their number is not small compared to the queue, the heap is rebuilt
+ * bottom-up in O(n) instead of adding them one by one.
+ * \param [in,out] pqueue   The priority queue.
+ * \param [in] elems        Elements stored contiguously in memory.
+ * \param [in] count        Number of elements.
+ * \param [out] handles     If not NULL, receives \a count handles as
+ *                          returned by \ref sc_pqueue_push.
+ */
+void                sc_pqueue_push_batch (sc_pqueue_t * pqueue,
+                                          const void *elems, size_t count,
+                                          size_t * handles);
+
+/** Returns the smallest element of a priority queue.
+ * \param [in] pqueue       The priority queue.
+ * \return                  Pointer to the top element, or NULL if empty.
+ *                          It must not be modified through the pointer.
+ */
+void               *sc_pqueue_top (sc_pqueue_t * pqueue);
+
+/** Removes the smallest element from a priority queue in O(log n).
+ * \param [in,out] pqueue   The priority queue.
+ * \param [out] result      If not NULL, receives the smallest element.
+ * \return                  True if an element was removed, false if the
+ *                          queue was empty.
+ */
+int                 sc_pqueue_pop (sc_pqueue_t * pqueue, void *result);
+
+/** Returns the element that belongs to a handle.
+ * \param [in] pqueue       An indexed priority queue.
+ * \param [in] handle       A handle returned when adding an element.
+ * \return                  Pointer to the element, or NULL if it is no
+ *                          longer in the queue.  It must not be modified
+ *                          through the pointer; use sc_pqueue_update.
+ */
+void               *sc_pqueue_lookup (sc_pqueue_t * pqueue, size_t handle);
+
+/** Changes an element and restores the heap order in O(log n).
+ * This implements decrease-key as well as increase-key.
+ * \param [in,out] pqueue   An indexed priority queue.
+ * \param [in] handle       Handle of an element in the queue.
+ * \param [in] elem         The new value is copied into the queue.
+ */
+void                sc_pqueue_update (sc_pqueue_t * pqueue, size_t handle,
+                                      const void *elem);
+
+/** Removes any element from a priority queue in O(log n).
+ * \param [in,out] pqueue   An indexed priority queue.
+ * \param [in] handle       Handle of an element in the queue.
+ * \param [out] result      If not NULL, receives the removed element.
+ */
+void                sc_pqueue_remove (sc_pqueue_t * pqueue, size_t handle,
+                                      void *result);
+
 /** The sc_mempool object provides a large pool of equal-size elements.
  * The pool grows dynamically for element allocation.
  * Elements are referenced by their address which never changes.
@@ -625,6 +1008,58 @@ sc_mempool_free (sc_mempool_t * mempool, void *elem)
   *(void **) sc_array_push (freed) = elem;
 }
 
+/** The sc_arena object provides memory of varying size from large chunks.
+ * Memory is not returned piece by piece.  Instead, \ref sc_arena_mark
+ * records the current position and \ref sc_arena_rewind releases all memory
+ * allocated since in one step.  Containers created with an arena take all
+ * their memory from it and need not be destroyed individually.
+ */
+struct sc_arena
+{
+  /* implementation variables */
+  struct obstack      obstack;  /**< holds the allocated memory */
+  void               *start;    /**< the position of an empty arena */
+};
+
+/** Calculate the memory used by an arena.
+ * \param [in] arena       The arena.
+ * \return                 Memory used in bytes.
+ */
+size_t              sc_arena_memory_used (sc_arena_t * arena);
+
+/** Creates a new, empty arena.
+ * \return Returns an allocated and initialized arena.
+ */
+sc_arena_t         *sc_arena_new (void);
+
+/** Destroys an arena and invalidates all memory allocated in it. */
+void                sc_arena_destroy (sc_arena_t * arena);
+
+/** Allocate memory in an arena.
+ * \param [in] size     Number of bytes.  Aborts if it exceeds INT_MAX.
+ * \return              Memory aligned suitably for any basic type.
+ */
+void               *sc_arena_alloc (sc_arena_t * arena, size_t size);
+
+/** Allocate memory with a given alignment in an arena.
+ * \param [in] size        Number of bytes.
+ * \param [in] alignment   A power of two.
+ * \return                 Memory whose address is a multiple of alignment.
+ */
+void               *sc_arena_alloc_aligned (sc_arena_t * arena, size_t size,
+                                            size_t alignment);
+
+/** Record the current position of an arena.
+ * \return Returns a mark to be passed to \ref sc_arena_rewind.
+ */
+void               *sc_arena_mark (sc_arena_t * arena);
+
+/** Release all memory allocated in an arena after a mark was taken.
+ * This invalidates all marks taken after \a mark.
+ * \param [in] mark     A mark of this arena, or NULL to empty the arena.
+ */
+void                sc_arena_rewind (sc_arena_t * arena, void *mark);
+
 /** The sc_link structure is one link of a linked list.
  */
 typedef struct sc_link
@@ -646,6 +1081,7 @@ typedef struct sc_list
   /* implementation variables */
   int                 allocator_owned;
   sc_mempool_t       *allocator;        /* must allocate sc_link_t */
+  sc_arena_t         *arena;    /* if not NULL, used instead of allocator */
 }
 sc_list_t;
 
@@ -664,6 +1100,15 @@ size_t              sc_list_memory_used (sc_list_t * list, int is_dynamic);
  */
 sc_list_t          *sc_list_new (sc_mempool_t * allocator);
 
+/** Allocate a new, empty linked list in an arena.
+ * \param [in] arena        If NULL, this is equivalent to sc_list_new (NULL).
+ *                          Otherwise the list and its links are allocated in
+ *                          the arena.  Removed links are not reused, and the
+ *                          list is released with the arena.
+ * \return                  Pointer to a new, empty list object.
+ */
+sc_list_t          *sc_list_new_arena (sc_arena_t * arena);
+
 /** Destroy a linked list structure in O(N).
  * \param [in,out] list     All memory allocated for this list is freed.
  * \note If allocator was provided in sc_list_new, it will not be destroyed.
@@ -819,6 +1264,33 @@ int                 sc_hash_lookup (sc_hash_t * hash, void *v, void ***found);
 int                 sc_hash_insert_unique (sc_hash_t * hash, void *v,
                                            void ***found);
 
+/** Check a batch of objects for being contained in the hash table.
+ * All hash values of a group of keys are computed first and their slots
+ * are prefetched before the keys are resolved one by one.
+ * \param [in]  keys   Array of void * pointers to the objects to look up.
+ * \param [out] found  If found != NULL, it must have elem_size
+ *                     sizeof (void **) and is resized to the number of keys.
+ *                     Entry i is set as in sc_hash_lookup for key i,
+ *                     or to NULL if key i is not found.
+ * \return Returns the number of keys found.
+ */
+size_t              sc_hash_lookup_batch (sc_hash_t * hash,
+                                          sc_array_t * keys,
+                                          sc_array_t * found);
+
+/** Insert a batch of objects into a hash table if not contained already.
+ * Keys are processed in order, so duplicates within the batch are only
+ * inserted once.  Hash values are computed and slots prefetched per group.
+ * \param [in]  keys   Array of void * pointers to the objects to insert.
+ * \param [out] found  If found != NULL, it must have elem_size
+ *                     sizeof (void **) and is resized to the number of keys.
+ *                     Entry i is set as in sc_hash_insert_unique for key i.
+ * \return Returns the number of objects added.
+ */
+size_t              sc_hash_insert_unique_batch (sc_hash_t * hash,
+                                                 sc_array_t * keys,
+                                                 sc_array_t * found);
+
 /** Remove an object from a hash table.
  * \param [in]  v      The object to be removed.
  * \param [out] found  If found != NULL, *found is set to the object
@@ -838,6 +1310,208 @@ void                sc_hash_print_statistics (int package_id,
                                               int log_priority,
                                               sc_hash_t * hash);
 
+/** The sc_chash implements a hash table that is safe to use from threads.
+ * The objects are distributed over a power-of-two number of shards by the
+ * high bits of their hash value.  Each shard is an sc_hash_t guarded by its
+ * own pthread mutex, so threads only contend when they access the same
+ * shard.  If configured without --enable-pthread, no locking is done.
+ * Since objects may move within a shard, the functions below return the
+ * contained object itself instead of the address of its pointer.
+ */
+typedef struct sc_chash
+{
+  /* implementation variables */
+  int                 num_shards;       /**< always a power of two */
+  int                 shift;    /**< 64 minus the logarithm of num_shards */
+  sc_hash_t         **shards;
+  void               *locks;    /**< one pthread mutex per shard */
+  sc_hash_function_t  hash_fn;
+  void               *user_data;        /**< user data passed to hash function */
+}
+sc_chash_t;
+
+/** Calculate the memory used by a concurrent hash table.
+ * \param [in] chash       The hash table.
+ * \return                 Memory used in bytes.
+ */
+size_t              sc_chash_memory_used (sc_chash_t * chash);
+
+/** Create a new concurrent hash table.
+ * The hash and equality functions must be safe to call from threads.
+ * \param [in] hash_fn     Function to compute the hash value.
+ * \param [in] equal_fn    Function to test two objects for equality.
+ * \param [in] user_data   User data passed through to the hash function.
+ * \param [in] num_shards  Number of independently locked shards, rounded up
+ *                         to a power of two.  If 0, a default is used.
+ */
+sc_chash_t         *sc_chash_new (sc_hash_function_t hash_fn,
+                                  sc_equal_function_t equal_fn,
+                                  void *user_data, int num_shards);
+
+/** Destroy a concurrent hash table.
+ * This function is not thread safe.
+ */
+void                sc_chash_destroy (sc_chash_t * chash);
+
+/** Return the total number of objects in a concurrent hash table.
+ * The shards are locked one after the other, so the result is only exact
+ * if no other thread modifies the table at the same time.
+ */
+size_t              sc_chash_elem_count (sc_chash_t * chash);
+
+/** Check if an object is contained in the concurrent hash table.
+ * \param [in]  v      The object to be looked up.
+ * \param [out] found  If found != NULL, *found is set to the contained
+ *                     object if the object is found.
+ * \return Returns true if object is found, false otherwise.
+ */
+int                 sc_chash_lookup (sc_chash_t * chash, void *v,
+                                     void **found);
+
+/** Insert an object into a concurrent hash table if not contained already.
+ * \param [in]  v      The object to be inserted.
+ * \param [out] found  If found != NULL, *found is set to the already
+ *                     contained object, or if not present, to \a v.
+ * \return Returns true if object is added, false if it is already contained.
+ */
+int                 sc_chash_insert_unique (sc_chash_t * chash, void *v,
+                                            void **found);
+
+/** Remove an object from a concurrent hash table.
+ * \param [in]  v      The object to be removed.
+ * \param [out] found  If found != NULL, *found is set to the object
+                       that is removed if that exists.
+ * \return Returns true if object is found, false if is not contained.
+ */
+int                 sc_chash_remove (sc_chash_t * chash, void *v,
+                                     void **found);
+
+/** Invoke a callback for every member of one shard while it is locked.
+ * Together with chash->num_shards, this allows for a parallel loop over
+ * the shards, for example with OpenMP.  The callback must not access the
+ * same table except through the pointer it is passed.
+ * \param [in] shard   Number of the shard between 0 and num_shards - 1.
+ */
+void                sc_chash_foreach_shard (sc_chash_t * chash, int shard,
+                                            sc_hash_foreach_t fn);
+
+/** Invoke a callback for every member of the concurrent hash table.
+ * The shards are locked one after the other.
+ */
+void                sc_chash_foreach (sc_chash_t * chash,
+                                      sc_hash_foreach_t fn);
+
+/** Invoke a callback for every member using several threads.
+ * Each thread visits a contiguous range of shards, so the callback must
+ * be thread safe.  If the callback returns false, only the thread calling
+ * it stops.  Without --enable-pthread this is the same as sc_chash_foreach.
+ * \param [in] num_threads  Number of threads to start.
+ */
+void                sc_chash_foreach_parallel (sc_chash_t * chash,
+                                               sc_hash_foreach_t fn,
+                                               int num_threads);
+
+/** One slot of the open addressing table in sc_fhash_t.
+ * The member psl is the probe sequence length plus one, or 0 if empty.
+ */
+typedef struct sc_fhash_slot
+{
+  void               *data;
+  unsigned            hash;     /**< cached result of the hash function */
+  unsigned            psl;
+}
+sc_fhash_slot_t;
+
+/** The sc_fhash implements a flat hash table with open addressing.
+ * It uses linear probing with Robin Hood displacement over one contiguous
+ * slot array and caches the hash value of every object.  There is no
+ * allocation per object and equal_fn is only called on matching hashes.
+ * It follows the same callback contract as sc_hash_t.
+ * Any pointer into the table returned by the functions below is only valid
+ * until the next insertion or removal.
+ */
+typedef struct sc_fhash
+{
+  /* interface variables */
+  size_t              elem_count;       /**< total number of objects contained */
+
+  /* implementation variables */
+  sc_array_t         *slots;    /**< power of two, elements of sc_fhash_slot_t */
+  size_t              mask;     /**< the slot count minus one */
+  int                 shift;    /**< 64 minus the logarithm of the slot count */
+  void               *user_data;        /**< user data passed to hash function */
+  sc_hash_function_t  hash_fn;
+  sc_equal_function_t equal_fn;
+  size_t              resize_checks, resize_actions;
+}
+sc_fhash_t;
+
+/** Calculate the memory used by a flat hash table.
+ * \param [in] hash        The hash table.
+ * \return                 Memory used in bytes.
+ */
+size_t              sc_fhash_memory_used (sc_fhash_t * hash);
+
+/** Create a new flat hash table.
+ * The number of hash slots is chosen dynamically.
+ * \param [in] hash_fn     Function to compute the hash value.
+ * \param [in] equal_fn    Function to test two objects for equality.
+ * \param [in] user_data   User data passed through to the hash function.
+ */
+sc_fhash_t         *sc_fhash_new (sc_hash_function_t hash_fn,
+                                  sc_equal_function_t equal_fn,
+                                  void *user_data);
+
+/** Destroy a flat hash table in O(1).
+ * The objects referenced by the table are not touched.
+ */
+void                sc_fhash_destroy (sc_fhash_t * hash);
+
+/** Remove all entries from a flat hash table and shrink it to minimal size.
+ */
+void                sc_fhash_truncate (sc_fhash_t * hash);
+
+/** Check if an object is contained in the flat hash table.
+ * \param [in]  v      The object to be looked up.
+ * \param [out] found  If found != NULL, *found is set to the address of the
+ *                     pointer to the already contained object if the object
+ *                     is found.  You can assign to **found to override.
+ * \return Returns true if object is found, false otherwise.
+ */
+int                 sc_fhash_lookup (sc_fhash_t * hash, void *v,
+                                     void ***found);
+
+/** Insert an object into a flat hash table if it is not contained already.
+ * \param [in]  v      The object to be inserted.
+ * \param [out] found  If found != NULL, *found is set to the address of the
+ *                     pointer to the already contained, or if not present,
+ *                     the new object.  You can assign to **found to override.
+ * \return Returns true if object is added, false if it is already contained.
+ */
+int                 sc_fhash_insert_unique (sc_fhash_t * hash, void *v,
+                                            void ***found);
+
+/** Remove an object from a flat hash table.
+ * \param [in]  v      The object to be removed.
+ * \param [out] found  If found != NULL, *found is set to the object
+                       that is removed if that exists.
+ * \return Returns true if object is found, false if is not contained.
+ */
+int                 sc_fhash_remove (sc_fhash_t * hash, void *v,
+                                     void **found);
+
+/** Invoke a callback for every member of the flat hash table.
+ * The functions hash_fn and equal_fn are not called by this function.
+ * The callback must not insert into or remove from the table.
+ */
+void                sc_fhash_foreach (sc_fhash_t * hash, sc_hash_foreach_t fn);
+
+/** Compute and print statistical information about the probe lengths.
+ */
+void                sc_fhash_print_statistics (int package_id,
+                                               int log_priority,
+                                               sc_fhash_t * hash);
+
 typedef struct sc_hash_array_data
 {
   sc_array_t         *pa;
@@ -923,6 +1597,93 @@ void               *sc_hash_array_insert_unique (sc_hash_array_t * hash_array,
 void                sc_hash_array_rip (sc_hash_array_t * hash_array,
                                        sc_array_t * rip);
 
+/** The sc_fhash_array is a drop-in variant of sc_hash_array.
+ * Instead of an sc_hash_t, it keeps a flat linear probing table that stores
+ * the hash value next to the array index of each element.  Probing compares
+ * several stored hash values at once (using SSE2 or AVX2 if the compiler
+ * targets them) and calls equal_fn only when a stored hash value matches.
+ * Resizing reuses the stored hash values and does not call hash_fn.
+ */
+typedef struct sc_fhash_array
+{
+  /* implementation variables */
+  sc_array_t          a;
+  sc_array_t          hashes;   /**< stored hash values, 0 marks empty */
+  sc_array_t          indices;  /**< array position for each slot */
+  size_t              mask;     /**< the slot count minus one */
+  int                 shift;    /**< 64 minus the logarithm of the slot count */
+  sc_hash_function_t  hash_fn;
+  sc_equal_function_t equal_fn;
+  void               *user_data;
+}
+sc_fhash_array_t;
+
+/** Calculate the memory used by a flat hash array.
+ * \param [in] fa          The hash array.
+ * \return                 Memory used in bytes.
+ */
+size_t              sc_fhash_array_memory_used (sc_fhash_array_t * fa);
+
+/** Create a new flat hash array.
+ * \param [in] elem_size   Size of one array element in bytes.
+ * \param [in] hash_fn     Function to compute the hash value.
+ * \param [in] equal_fn    Function to test two objects for equality.
+ */
+sc_fhash_array_t   *sc_fhash_array_new (size_t elem_size,
+                                        sc_hash_function_t hash_fn,
+                                        sc_equal_function_t equal_fn,
+                                        void *user_data);
+
+/** Destroy a flat hash array.
+ */
+void                sc_fhash_array_destroy (sc_fhash_array_t * fhash_array);
+
+/** Check the internal consistency of a flat hash array.
+ */
+int                 sc_fhash_array_is_valid (sc_fhash_array_t *
+                                             fhash_array);
+
+/** Remove all elements from the flat hash array.
+ * \param [in,out] fhash_array  Hash array to truncate.
+ */
+void                sc_fhash_array_truncate (sc_fhash_array_t *
+                                             fhash_array);
+
+/** Check if an object is contained in a flat hash array.
+ *
+ * \param [in]  v          A pointer to the object.
+ * \param [out] position   If position != NULL, *position is set to the
+ *                         array position of the already contained object
+ *                         if found.
+ * \return                 Returns true if object is found, false otherwise.
+ */
+int                 sc_fhash_array_lookup (sc_fhash_array_t * fhash_array,
+                                           void *v, size_t * position);
+
+/** Insert an object into a flat hash array if it is not contained already.
+ * The object is not copied into the array.  Use the return value for that.
+ * New objects are guaranteed to be added at the end of the array.
+ *
+ * \param [in]  v          A pointer to the object.  Used for search only.
+ * \param [out] position   If position != NULL, *position is set to the
+ *                         array position of the already contained, or if
+ *                         not present, the new object.
+ * \return                 Returns NULL if the object is already contained.
+ *                         Otherwise returns its new address in the array.
+ */
+void               *sc_fhash_array_insert_unique (sc_fhash_array_t *
+                                                  fhash_array, void *v,
+                                                  size_t * position);
+
+/** Extract the array data from a flat hash array and destroy everything else.
+ * \param [in] fhash_array  The hash array is destroyed after extraction.
+ * \param [in] rip          Array structure that will be overwritten.
+ *                          All previous array data (if any) will be leaked.
+ *                          The filled array can be freed with sc_array_reset.
+ */
+void                sc_fhash_array_rip (sc_fhash_array_t * fhash_array,
+                                        sc_array_t * rip);
+
 /** The sc_recycle_array object provides an array of slots that can be reused.
  *
  * It keeps a list of free slots in the array which will be used for insertion
@@ -74,7 +74,13 @@ sc_dmatrix_new_e (sc_dmatrix_t * rdm, sc_bint_t m, sc_bint_t n, double *data)
   SC_ASSERT (m >= 0 && n >= 0);
   SC_ASSERT (rdm != NULL);
 
-  rdm->e = SC_ALLOC (double *, m + 1);
+  if (rdm->arena != NULL) {
+    rdm->e = (double **) sc_arena_alloc (rdm->arena,
+                                         (m + 1) * sizeof (double *));
+  }
+  else {
+    rdm->e = SC_ALLOC (double *, m + 1);
+  }
   rdm->e[0] = data;
 
   if (m > 0) {
@@ -88,6 +94,26 @@ sc_dmatrix_new_e (sc_dmatrix_t * rdm, sc_bint_t m, sc_bint_t n, double *data)
   rdm->n = n;
 }
 
+/** Allocate entries of a matrix, taking the arena into account. */
+static double      *
+sc_dmatrix_alloc_data (const sc_dmatrix_t * dmatrix, size_t size)
+{
+  if (dmatrix->arena != NULL) {
+    return (double *) sc_arena_alloc (dmatrix->arena,
+                                      size * sizeof (double));
+  }
+  return SC_ALLOC (double, size);
+}
+
+/** Free memory of a matrix unless it lives in an arena. */
+static void
+sc_dmatrix_free_memory (const sc_dmatrix_t * dmatrix, void *ptr)
+{
+  if (dmatrix->arena == NULL) {
+    SC_FREE (ptr);
+  }
+}
+
 static sc_dmatrix_t *
 sc_dmatrix_new_internal (sc_bint_t m, sc_bint_t n, int init_zero)
 {
@@ -103,6 +129,7 @@ sc_dmatrix_new_internal (sc_bint_t m, sc_bint_t n, int init_zero)
   SC_ASSERT (m >= 0 && n >= 0);
 
   rdm = SC_ALLOC (sc_dmatrix_t, 1);
+  rdm->arena = NULL;
 
   if (init_zero) {
     data = SC_ALLOC_ZERO (double, size);
@@ -135,6 +162,24 @@ sc_dmatrix_new_zero (sc_bint_t m, sc_bint_t n)
   return sc_dmatrix_new_internal (m, n, 1);
 }
 
+sc_dmatrix_t       *
+sc_dmatrix_new_arena (sc_bint_t m, sc_bint_t n, sc_arena_t * arena)
+{
+  sc_dmatrix_t       *rdm;
+
+  SC_ASSERT (m >= 0 && n >= 0);
+
+  if (arena == NULL) {
+    return sc_dmatrix_new (m, n);
+  }
+  rdm = (sc_dmatrix_t *) sc_arena_alloc (arena, sizeof (sc_dmatrix_t));
+  rdm->arena = arena;
+  sc_dmatrix_new_e (rdm, m, n, sc_dmatrix_alloc_data (rdm, (size_t) (m * n)));
+  rdm->view = 0;
+
+  return rdm;
+}
+
 sc_dmatrix_t       *
 sc_dmatrix_new_data (sc_bint_t m, sc_bint_t n, double *data)
 {
@@ -143,6 +188,7 @@ sc_dmatrix_new_data (sc_bint_t m, sc_bint_t n, double *data)
   SC_ASSERT (m >= 0 && n >= 0);
 
   rdm = SC_ALLOC (sc_dmatrix_t, 1);
+  rdm->arena = NULL;
   sc_dmatrix_new_e (rdm, m, n, data);
   rdm->view = 1;
 
@@ -165,6 +211,7 @@ sc_dmatrix_new_view_offset (sc_bint_t o, sc_bint_t m, sc_bint_t n,
   SC_ASSERT ((o + m) * n <= orig->m * orig->n);
 
   rdm = SC_ALLOC (sc_dmatrix_t, 1);
+  rdm->arena = NULL;
   sc_dmatrix_new_e (rdm, m, n, orig->e[0] + o * n);
   rdm->view = 1;
 
@@ -180,6 +227,7 @@ sc_dmatrix_new_view_column (sc_dmatrix_t * orig, sc_bint_t j)
   SC_ASSERT (0 <= j && j < orig->n);
 
   rdm = SC_ALLOC (sc_dmatrix_t, 1);
+  rdm->arena = NULL;
   sc_dmatrix_new_e (rdm, orig->m, orig->n, orig->e[0] + j);
   rdm->n = 1;
   rdm->view = 1;
@@ -249,7 +297,7 @@ sc_dmatrix_reshape (sc_dmatrix_t * dmatrix, sc_bint_t m, sc_bint_t n)
   SC_ASSERT (dmatrix->m * dmatrix->n == m * n);
 
   data = dmatrix->e[0];
-  SC_FREE (dmatrix->e);
+  sc_dmatrix_free_memory (dmatrix, dmatrix->e);
   sc_dmatrix_new_e (dmatrix, m, n, data);
 }
 
@@ -266,20 +314,27 @@ sc_dmatrix_resize (sc_dmatrix_t * dmatrix, sc_bint_t m, sc_bint_t n)
   newsize = m * n;
 
   if (!dmatrix->view && size != newsize) {
+    if (dmatrix->arena != NULL) {
+      data = sc_dmatrix_alloc_data (dmatrix, (size_t) newsize);
+      memcpy (data, dmatrix->e[0],
+              (size_t) SC_MIN (newsize, size) * sizeof (double));
+    }
+    else {
 #ifdef SC_ENABLE_USE_REALLOC
-    data = SC_REALLOC (dmatrix->e[0], double, newsize);
+      data = SC_REALLOC (dmatrix->e[0], double, newsize);
 #else
-    data = SC_ALLOC (double, newsize);
-    memcpy (data, dmatrix->e[0],
-            (size_t) SC_MIN (newsize, size) * sizeof (double));
-    SC_FREE (dmatrix->e[0]);
+      data = SC_ALLOC (double, newsize);
+      memcpy (data, dmatrix->e[0],
+              (size_t) SC_MIN (newsize, size) * sizeof (double));
+      SC_FREE (dmatrix->e[0]);
 #endif
+    }
   }
   else {
     /* for views you must know that data is large enough */
     data = dmatrix->e[0];
   }
-  SC_FREE (dmatrix->e);
+  sc_dmatrix_free_memory (dmatrix, dmatrix->e);
   sc_dmatrix_new_e (dmatrix, m, n, data);
 }
 
@@ -305,27 +360,38 @@ sc_dmatrix_resize_in_place (sc_dmatrix_t * dmatrix, sc_bint_t m, sc_bint_t n)
     }
   }
   if (newsize != size) {
+    if (dmatrix->arena != NULL) {
+      data = sc_dmatrix_alloc_data (dmatrix, (size_t) newsize);
+      memcpy (data, dmatrix->e[0],
+              (size_t) SC_MIN (newsize, size) * sizeof (double));
+    }
+    else {
 #ifdef SC_ENABLE_USE_REALLOC
-    data = SC_REALLOC (dmatrix->e[0], double, newsize);
+      data = SC_REALLOC (dmatrix->e[0], double, newsize);
 #else
-    data = SC_ALLOC (double, newsize);
-    memcpy (data, dmatrix->e[0],
-            (size_t) SC_MIN (newsize, size) * sizeof (double));
-    SC_FREE (dmatrix->e[0]);
+      data = SC_ALLOC (double, newsize);
+      memcpy (data, dmatrix->e[0],
+              (size_t) SC_MIN (newsize, size) * sizeof (double));
+      SC_FREE (dmatrix->e[0]);
 #endif
+    }
   }
   if (n > old_n) {
     for (i = min_m - 1; i > 0; i--) {
       memmove (data + i * n, data + i * old_n, old_n * sizeof (double));
     }
   }
-  SC_FREE (dmatrix->e);
+  sc_dmatrix_free_memory (dmatrix, dmatrix->e);
   sc_dmatrix_new_e (dmatrix, m, n, data);
 }
 
 void
 sc_dmatrix_destroy (sc_dmatrix_t * dmatrix)
 {
+  if (dmatrix->arena != NULL) {
+    /* the memory is released with the arena */
+    return;
+  }
   if (!dmatrix->view) {
     SC_FREE (dmatrix->e[0]);
   }
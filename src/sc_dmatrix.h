@@ -41,6 +41,7 @@ typedef struct sc_dmatrix
   sc_bint_t           m;        /**< Number of rows in this matrix. */
   sc_bint_t           n;        /**< Number of columns in this matrix. */
   int                 view;     /**< Boolean to indicate this is a view. */
+  sc_arena_t         *arena;    /**< If not NULL, holds all memory. */
 }
 sc_dmatrix_t;
 
@@ -83,6 +84,17 @@ sc_dmatrix_t       *sc_dmatrix_new (sc_bint_t m, sc_bint_t n);
  */
 sc_dmatrix_t       *sc_dmatrix_new_zero (sc_bint_t m, sc_bint_t n);
 
+/** Create a new matrix object whose memory is allocated in an arena.
+ * The matrix is released with the arena and need not be destroyed.
+ * Resizing it leaves the old entries in the arena.
+ * \param [in] m            Number of rows.
+ * \param [in] n            Number of columns.
+ * \param [in] arena        If NULL, this is equivalent to sc_dmatrix_new.
+ * \return                  A valid dmatrix object with undefined entries.
+ */
+sc_dmatrix_t       *sc_dmatrix_new_arena (sc_bint_t m, sc_bint_t n,
+                                          sc_arena_t * arena);
+
 /** Create a new matrix object with the same size and entries as another.
  * This function aborts on memory allocation errors.
  * \param [in] dmatrix      A valid dmatrix or view.
@@ -179,7 +191,8 @@ void                sc_dmatrix_resize (sc_dmatrix_t * dmatrix,
 void                sc_dmatrix_resize_in_place (sc_dmatrix_t * dmatrix,
                                                 sc_bint_t m, sc_bint_t n);
 
-/** Destroy a dmatrix and all allocated memory. */
+/** Destroy a dmatrix and all allocated memory.
+ * For a dmatrix created with an arena this does not free any memory. */
 void                sc_dmatrix_destroy (sc_dmatrix_t * dmatrix);
 
 /** Check whether a dmatrix is free of NaN entries.
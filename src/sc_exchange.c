@@ -0,0 +1,470 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+
+#include <sc_exchange.h>
+#include <sc_notify.h>
+
+/** A message received by sc_exchange_messages. */
+typedef struct sc_exchange_message
+{
+  int                 source;
+  sc_array_t          data;
+}
+sc_exchange_message_t;
+
+static int
+sc_exchange_message_compare (const void *v1, const void *v2)
+{
+  return sc_int_compare (&((const sc_exchange_message_t *) v1)->source,
+                         &((const sc_exchange_message_t *) v2)->source);
+}
+
+/** Receive a message whose envelope has been probed. */
+static void
+sc_exchange_receive (sc_MPI_Status * status, int tag, size_t elem_size,
+                     sc_array_t * messages, sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 bytes;
+  sc_exchange_message_t *msg;
+
+  mpiret = sc_MPI_Get_count (status, sc_MPI_BYTE, &bytes);
+  SC_CHECK_MPI (mpiret);
+  SC_ASSERT (bytes % (int) elem_size == 0);
+
+  msg = (sc_exchange_message_t *) sc_array_push (messages);
+  msg->source = status->MPI_SOURCE;
+  sc_array_init_size (&msg->data, elem_size, (size_t) bytes / elem_size);
+  mpiret = sc_MPI_Recv (msg->data.array, bytes, sc_MPI_BYTE,
+                        msg->source, tag, mpicomm, sc_MPI_STATUS_IGNORE);
+  SC_CHECK_MPI (mpiret);
+}
+
+/** Send the messages and collect all messages sent to us.
+ * \param [out] messages    Array of sc_exchange_message_t sorted by source.
+ */
+static void
+sc_exchange_messages (int num_receivers, const int *receivers,
+                      const int *send_counts, const char **send_data,
+                      size_t elem_size, sc_array_t * messages,
+                      sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  int                 i, tag;
+  sc_exchange_message_t *msg;
+  sc_MPI_Request     *requests;
+  sc_MPI_Status       status;
+#ifdef SC_ENABLE_MPINBC
+  int                 flag, barrier_active;
+  sc_MPI_Request      barrier;
+#else
+  int                 num_peers, num_senders;
+  int                *peers, *senders;
+#endif
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* a message to ourselves is copied, which is all we do without MPI */
+  for (i = 0; i < num_receivers; ++i) {
+    SC_ASSERT (0 <= receivers[i] && receivers[i] < mpisize);
+    if (receivers[i] == mpirank) {
+      msg = (sc_exchange_message_t *) sc_array_push (messages);
+      msg->source = mpirank;
+      sc_array_init_size (&msg->data, elem_size, (size_t) send_counts[i]);
+      memcpy (msg->data.array, send_data[i], send_counts[i] * elem_size);
+    }
+  }
+  if (mpisize == 1) {
+    return;
+  }
+
+  /* the tag separates this exchange from any exchange started later */
+  tag = sc_mpi_comm_get_nbc_tag (mpicomm);
+  requests = SC_ALLOC (sc_MPI_Request, num_receivers);
+  for (i = 0; i < num_receivers; ++i) {
+    requests[i] = sc_MPI_REQUEST_NULL;
+    if (receivers[i] == mpirank) {
+      continue;
+    }
+#ifdef SC_ENABLE_MPINBC
+    /* a synchronous send completes once it is being received */
+    mpiret = MPI_Issend ((void *) send_data[i],
+                         (int) (send_counts[i] * elem_size), sc_MPI_BYTE,
+                         receivers[i], tag, mpicomm, requests + i);
+#else
+    mpiret = sc_MPI_Isend ((void *) send_data[i],
+                           (int) (send_counts[i] * elem_size), sc_MPI_BYTE,
+                           receivers[i], tag, mpicomm, requests + i);
+#endif
+    SC_CHECK_MPI (mpiret);
+  }
+
+#ifdef SC_ENABLE_MPINBC
+  /* receive until all processes have had all their sends matched */
+  barrier_active = 0;
+  for (;;) {
+    mpiret = sc_MPI_Iprobe (sc_MPI_ANY_SOURCE, tag, mpicomm, &flag, &status);
+    SC_CHECK_MPI (mpiret);
+    if (flag) {
+      sc_exchange_receive (&status, tag, elem_size, messages, mpicomm);
+    }
+    if (!barrier_active) {
+      mpiret = sc_MPI_Testall (num_receivers, requests, &flag,
+                               sc_MPI_STATUSES_IGNORE);
+      SC_CHECK_MPI (mpiret);
+      if (flag) {
+        mpiret = MPI_Ibarrier (mpicomm, &barrier);
+        SC_CHECK_MPI (mpiret);
+        barrier_active = 1;
+      }
+    }
+    else {
+      mpiret = sc_MPI_Test (&barrier, &flag, sc_MPI_STATUS_IGNORE);
+      SC_CHECK_MPI (mpiret);
+      if (flag) {
+        break;
+      }
+    }
+  }
+#else
+  /* without a nonblocking barrier, the senders are found by sc_notify */
+  peers = SC_ALLOC (int, num_receivers);
+  for (num_peers = 0, i = 0; i < num_receivers; ++i) {
+    if (receivers[i] != mpirank) {
+      peers[num_peers++] = receivers[i];
+    }
+  }
+  qsort (peers, (size_t) num_peers, sizeof (int), sc_int_compare);
+  senders = SC_ALLOC (int, mpisize);
+  mpiret = sc_notify (peers, num_peers, senders, &num_senders, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  for (i = 0; i < num_senders; ++i) {
+    mpiret = sc_MPI_Probe (senders[i], tag, mpicomm, &status);
+    SC_CHECK_MPI (mpiret);
+    sc_exchange_receive (&status, tag, elem_size, messages, mpicomm);
+  }
+  mpiret = sc_MPI_Waitall (num_receivers, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  SC_FREE (senders);
+  SC_FREE (peers);
+#endif
+  SC_FREE (requests);
+
+  sc_array_sort (messages, sc_exchange_message_compare);
+}
+
+int
+sc_exchange (int num_receivers, const int *receivers,
+             const int *send_counts, const void *send_buffer,
+             size_t elem_size, sc_array_t * senders,
+             sc_array_t * recv_counts, sc_array_t * recv_buffer,
+             sc_MPI_Comm mpicomm)
+{
+  int                 i;
+  size_t              zz, offset;
+  const char        **send_data;
+  sc_array_t          messages;
+  sc_exchange_message_t *msg;
+
+  SC_ASSERT (senders != NULL && senders->elem_size == sizeof (int));
+  SC_ASSERT (recv_counts != NULL && recv_counts->elem_size == sizeof (int));
+  SC_ASSERT (recv_buffer != NULL && recv_buffer->elem_size == elem_size);
+
+  /* locate the message for every receiver */
+  send_data = SC_ALLOC (const char *, num_receivers);
+  for (offset = 0, i = 0; i < num_receivers; ++i) {
+    send_data[i] = (const char *) send_buffer + offset * elem_size;
+    offset += (size_t) send_counts[i];
+  }
+  sc_array_init (&messages, sizeof (sc_exchange_message_t));
+  sc_exchange_messages (num_receivers, receivers, send_counts, send_data,
+                        elem_size, &messages, mpicomm);
+  SC_FREE (send_data);
+
+  /* concatenate the received messages */
+  sc_array_resize (senders, messages.elem_count);
+  sc_array_resize (recv_counts, messages.elem_count);
+  for (offset = 0, zz = 0; zz < messages.elem_count; ++zz) {
+    msg = (sc_exchange_message_t *) sc_array_index (&messages, zz);
+    *(int *) sc_array_index (senders, zz) = msg->source;
+    *(int *) sc_array_index (recv_counts, zz) = (int) msg->data.elem_count;
+    offset += msg->data.elem_count;
+  }
+  sc_array_resize (recv_buffer, offset);
+  for (offset = 0, zz = 0; zz < messages.elem_count; ++zz) {
+    msg = (sc_exchange_message_t *) sc_array_index (&messages, zz);
+    if (msg->data.elem_count > 0) {
+      memcpy (sc_array_index (recv_buffer, offset), msg->data.array,
+              msg->data.elem_count * elem_size);
+      offset += msg->data.elem_count;
+    }
+    sc_array_reset (&msg->data);
+  }
+  sc_array_reset (&messages);
+
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_exchange_arrays (sc_array_t * receivers, sc_array_t * send_arrays,
+                    size_t elem_size, sc_array_t * senders,
+                    sc_array_t * recv_arrays, sc_MPI_Comm mpicomm)
+{
+  int                 num_receivers;
+  int                *send_counts;
+  size_t              zz;
+  const char        **send_data;
+  sc_array_t          messages;
+  sc_array_t         *arr;
+  sc_exchange_message_t *msg;
+
+  SC_ASSERT (receivers != NULL && receivers->elem_size == sizeof (int));
+  SC_ASSERT (send_arrays != NULL &&
+             send_arrays->elem_size == sizeof (sc_array_t));
+  SC_ASSERT (receivers->elem_count == send_arrays->elem_count);
+  SC_ASSERT (senders != NULL && senders->elem_size == sizeof (int));
+  SC_ASSERT (recv_arrays != NULL &&
+             recv_arrays->elem_size == sizeof (sc_array_t));
+
+  num_receivers = (int) receivers->elem_count;
+  send_counts = SC_ALLOC (int, num_receivers);
+  send_data = SC_ALLOC (const char *, num_receivers);
+  for (zz = 0; zz < receivers->elem_count; ++zz) {
+    arr = (sc_array_t *) sc_array_index (send_arrays, zz);
+    SC_ASSERT (arr->elem_size == elem_size);
+    send_counts[zz] = (int) arr->elem_count;
+    send_data[zz] = arr->array;
+  }
+  sc_array_init (&messages, sizeof (sc_exchange_message_t));
+  sc_exchange_messages (num_receivers, (const int *) receivers->array,
+                        send_counts, send_data, elem_size, &messages,
+                        mpicomm);
+  SC_FREE (send_data);
+  SC_FREE (send_counts);
+
+  /* the received arrays are handed over to the caller */
+  sc_array_resize (senders, messages.elem_count);
+  sc_array_resize (recv_arrays, messages.elem_count);
+  for (zz = 0; zz < messages.elem_count; ++zz) {
+    msg = (sc_exchange_message_t *) sc_array_index (&messages, zz);
+    *(int *) sc_array_index (senders, zz) = msg->source;
+    *(sc_array_t *) sc_array_index (recv_arrays, zz) = msg->data;
+  }
+  sc_array_reset (&messages);
+
+  return sc_MPI_SUCCESS;
+}
+
+sc_comm_plan_t     *
+sc_comm_plan_new (int num_receivers, const int *receivers,
+                  const int *send_counts, size_t elem_size,
+                  sc_MPI_Comm mpicomm)
+{
+  int                 i;
+  int                 mpiret;
+  int                *ones;
+  sc_array_t         *senders, *recv_counts, *recv_buffer;
+  sc_comm_plan_t     *plan;
+
+  plan = SC_ALLOC_ZERO (sc_comm_plan_t, 1);
+  plan->mpicomm = mpicomm;
+  plan->elem_size = elem_size;
+  mpiret = sc_MPI_Comm_rank (mpicomm, &plan->mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* store the send pattern */
+  plan->num_receivers = num_receivers;
+  plan->receivers = SC_ALLOC (int, num_receivers);
+  plan->send_counts = SC_ALLOC (int, num_receivers);
+  plan->send_offsets = SC_ALLOC (size_t, num_receivers + 1);
+  plan->send_offsets[0] = 0;
+  ones = SC_ALLOC (int, num_receivers);
+  for (i = 0; i < num_receivers; ++i) {
+    ones[i] = 1;
+    plan->receivers[i] = receivers[i];
+    plan->send_counts[i] = send_counts[i];
+    plan->send_offsets[i + 1] = plan->send_offsets[i] + send_counts[i];
+  }
+
+  /* every receiver learns about us and the size of our message */
+  senders = sc_array_new (sizeof (int));
+  recv_counts = sc_array_new (sizeof (int));
+  recv_buffer = sc_array_new (sizeof (int));
+  mpiret = sc_exchange (num_receivers, receivers, ones, plan->send_counts,
+                        sizeof (int), senders, recv_counts, recv_buffer,
+                        mpicomm);
+  SC_CHECK_MPI (mpiret);
+  SC_FREE (ones);
+  SC_ASSERT (senders->elem_count == recv_buffer->elem_count);
+  plan->num_senders = (int) senders->elem_count;
+  plan->senders = SC_ALLOC (int, plan->num_senders);
+  plan->recv_counts = SC_ALLOC (int, plan->num_senders);
+  plan->recv_offsets = SC_ALLOC (size_t, plan->num_senders + 1);
+  plan->recv_offsets[0] = 0;
+  for (i = 0; i < plan->num_senders; ++i) {
+    plan->senders[i] = *(int *) sc_array_index_int (senders, i);
+    plan->recv_counts[i] = *(int *) sc_array_index_int (recv_buffer, i);
+    plan->recv_offsets[i + 1] = plan->recv_offsets[i] + plan->recv_counts[i];
+  }
+  sc_array_destroy (senders);
+  sc_array_destroy (recv_counts);
+  sc_array_destroy (recv_buffer);
+
+  /* requests are allocated once and created when buffers are bound */
+  /* a plan lives arbitrarily long and must not take a cycled tag */
+  plan->tag = SC_TAG_COMM_PLAN;
+  plan->requests = SC_ALLOC (sc_MPI_Request,
+                             plan->num_receivers + plan->num_senders);
+
+  return plan;
+}
+
+/** Free the persistent requests of a plan. */
+static void
+sc_comm_plan_free_requests (sc_comm_plan_t * plan)
+{
+  int                 i;
+  int                 mpiret;
+
+  for (i = 0; i < plan->num_requests; ++i) {
+    mpiret = sc_MPI_Request_free (plan->requests + i);
+    SC_CHECK_MPI (mpiret);
+  }
+  plan->num_requests = 0;
+}
+
+void
+sc_comm_plan_destroy (sc_comm_plan_t * plan)
+{
+  SC_ASSERT (!plan->active);
+
+  sc_comm_plan_free_requests (plan);
+  SC_FREE (plan->requests);
+  SC_FREE (plan->receivers);
+  SC_FREE (plan->send_counts);
+  SC_FREE (plan->send_offsets);
+  SC_FREE (plan->senders);
+  SC_FREE (plan->recv_counts);
+  SC_FREE (plan->recv_offsets);
+  SC_FREE (plan);
+}
+
+void
+sc_comm_plan_bind (sc_comm_plan_t * plan, const void *send_buffer,
+                   void *recv_buffer)
+{
+  int                 i;
+  int                 mpiret;
+  const size_t        es = plan->elem_size;
+
+  SC_ASSERT (!plan->active);
+  if (plan->num_requests > 0 && send_buffer == plan->send_buffer &&
+      recv_buffer == plan->recv_buffer) {
+    return;
+  }
+  sc_comm_plan_free_requests (plan);
+  plan->send_buffer = send_buffer;
+  plan->recv_buffer = recv_buffer;
+
+  /* messages to ourselves are copied when the plan is started */
+  for (i = 0; i < plan->num_senders; ++i) {
+    if (plan->senders[i] == plan->mpirank) {
+      continue;
+    }
+    mpiret = sc_MPI_Recv_init ((char *) recv_buffer +
+                               plan->recv_offsets[i] * es,
+                               (int) (plan->recv_counts[i] * es),
+                               sc_MPI_BYTE, plan->senders[i], plan->tag,
+                               plan->mpicomm,
+                               plan->requests + plan->num_requests++);
+    SC_CHECK_MPI (mpiret);
+  }
+  for (i = 0; i < plan->num_receivers; ++i) {
+    if (plan->receivers[i] == plan->mpirank) {
+      continue;
+    }
+    mpiret = sc_MPI_Send_init ((char *) send_buffer +
+                               plan->send_offsets[i] * es,
+                               (int) (plan->send_counts[i] * es),
+                               sc_MPI_BYTE, plan->receivers[i], plan->tag,
+                               plan->mpicomm,
+                               plan->requests + plan->num_requests++);
+    SC_CHECK_MPI (mpiret);
+  }
+}
+
+void
+sc_comm_plan_start (sc_comm_plan_t * plan)
+{
+  int                 i, j;
+  int                 mpiret;
+  const size_t        es = plan->elem_size;
+
+  SC_ASSERT (!plan->active);
+  mpiret = sc_MPI_Startall (plan->num_requests, plan->requests);
+  SC_CHECK_MPI (mpiret);
+  plan->active = 1;
+
+  /* copy a message to ourselves while the others are in flight */
+  for (i = 0; i < plan->num_receivers; ++i) {
+    if (plan->receivers[i] == plan->mpirank) {
+      for (j = 0; j < plan->num_senders; ++j) {
+        if (plan->senders[j] == plan->mpirank) {
+          SC_ASSERT (plan->recv_counts[j] == plan->send_counts[i]);
+          memcpy ((char *) plan->recv_buffer + plan->recv_offsets[j] * es,
+                  (const char *) plan->send_buffer +
+                  plan->send_offsets[i] * es, plan->send_counts[i] * es);
+          break;
+        }
+      }
+      SC_ASSERT (j < plan->num_senders);
+      break;
+    }
+  }
+}
+
+void
+sc_comm_plan_wait (sc_comm_plan_t * plan)
+{
+  int                 mpiret;
+
+  SC_ASSERT (plan->active);
+  mpiret = sc_MPI_Waitall (plan->num_requests, plan->requests,
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  plan->active = 0;
+}
+
+void
+sc_comm_plan_execute (sc_comm_plan_t * plan, const void *send_buffer,
+                      void *recv_buffer)
+{
+  sc_comm_plan_bind (plan, send_buffer, recv_buffer);
+  sc_comm_plan_start (plan);
+  sc_comm_plan_wait (plan);
+}
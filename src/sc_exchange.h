@@ -0,0 +1,170 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+
+#ifndef SC_EXCHANGE_H
+#define SC_EXCHANGE_H
+
+#include <sc_containers.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** Collective call to send variable sized messages to a sparse set of
+ * receivers and to obtain the messages sent to the current rank.
+ * The senders need not be known in advance.  With MPI nonblocking
+ * collectives, the payload is sent by synchronous sends and completion is
+ * detected by a nonblocking barrier (NBX), so notification and payload
+ * travel together.  Otherwise, sc_notify determines the senders.
+ * A message to the current rank is copied without communication, which
+ * makes this function work without MPI.
+ * \param [in] num_receivers    Number of ranks to send to.
+ * \param [in] receivers        Unique ranks to send to, in any order.
+ * \param [in] send_counts      Number of elements for each receiver.
+ * \param [in] send_buffer      The messages stored back to back in the
+ *                              order of \a receivers.
+ * \param [in] elem_size        Size in bytes of one element.
+ * \param [out] senders         Array of int, resized to the number of
+ *                              ranks that sent to us, in ascending order.
+ * \param [out] recv_counts     Array of int, resized to the number of
+ *                              senders, holds the element counts received.
+ * \param [out] recv_buffer     Array with element size \a elem_size,
+ *                              resized to hold the received messages back
+ *                              to back in the order of \a senders.
+ * \param [in] mpicomm          MPI communicator to use.
+ * \return                      Aborts on MPI error or returns sc_MPI_SUCCESS.
+ */
+int                 sc_exchange (int num_receivers, const int *receivers,
+                                 const int *send_counts,
+                                 const void *send_buffer, size_t elem_size,
+                                 sc_array_t * senders,
+                                 sc_array_t * recv_counts,
+                                 sc_array_t * recv_buffer,
+                                 sc_MPI_Comm mpicomm);
+
+/** Collective call to exchange one array per receiver.
+ * This is equivalent to sc_exchange but keeps every message in an array.
+ * \param [in] receivers        Array of int holding unique ranks to send to.
+ * \param [in] send_arrays      Array of sc_array_t, one per receiver, whose
+ *                              element size must equal \a elem_size.
+ * \param [in] elem_size        Size in bytes of one element.
+ * \param [out] senders         Array of int, resized to the number of
+ *                              ranks that sent to us, in ascending order.
+ * \param [out] recv_arrays     Array of sc_array_t, resized to the number of
+ *                              senders.  Every entry is initialized with
+ *                              the received message and must be reset
+ *                              by the caller.
+ * \param [in] mpicomm          MPI communicator to use.
+ * \return                      Aborts on MPI error or returns sc_MPI_SUCCESS.
+ */
+int                 sc_exchange_arrays (sc_array_t * receivers,
+                                        sc_array_t * send_arrays,
+                                        size_t elem_size,
+                                        sc_array_t * senders,
+                                        sc_array_t * recv_arrays,
+                                        sc_MPI_Comm mpicomm);
+
+/** A persistent communication plan for a repeated sparse exchange.
+ * The plan records the receivers, senders and message sizes once.  Every
+ * execution then starts persistent requests on the bound buffers and
+ * does not allocate memory.  All members are read-only for the user.
+ * All plans use the tag SC_TAG_COMM_PLAN.  Plans on the same communicator
+ * that are active at the same time must be started in the same order on
+ * all processes.
+ */
+typedef struct sc_comm_plan
+{
+  sc_MPI_Comm         mpicomm;          /**< The communicator of the plan. */
+  int                 mpirank;          /**< Our rank in the communicator. */
+  int                 tag;              /**< Tag of all plan messages. */
+  size_t              elem_size;        /**< Byte size of one element. */
+  int                 num_receivers;    /**< Number of ranks we send to. */
+  int                *receivers;        /**< The ranks we send to. */
+  int                *send_counts;      /**< Elements sent to each. */
+  size_t             *send_offsets;     /**< Element offsets into the send
+                                             buffer, num_receivers + 1. */
+  int                 num_senders;      /**< Number of ranks we receive
+                                             from. */
+  int                *senders;          /**< Ascending ranks we receive from. */
+  int                *recv_counts;      /**< Elements received from each. */
+  size_t             *recv_offsets;     /**< Element offsets into the receive
+                                             buffer, num_senders + 1. */
+  const void         *send_buffer;      /**< Buffer bound for sending. */
+  void               *recv_buffer;      /**< Buffer bound for receiving. */
+  int                 num_requests;     /**< Number of persistent requests. */
+  sc_MPI_Request     *requests;         /**< The persistent requests. */
+  int                 active;           /**< True between start and wait. */
+}
+sc_comm_plan_t;
+
+/** Collective call to create a communication plan.
+ * The senders and the receive counts are found once by sc_exchange.
+ * Each process must create its plans on a communicator in the same order.
+ * \param [in] num_receivers    Number of ranks to send to.
+ * \param [in] receivers        Unique ranks to send to, in any order.
+ * \param [in] send_counts      Number of elements for each receiver.
+ * \param [in] elem_size        Size in bytes of one element.
+ * \param [in] mpicomm          MPI communicator to use.
+ * \return                      A plan with no buffers bound yet.
+ *                              The receive buffer needs to hold
+ *                              recv_offsets[num_senders] elements.
+ */
+sc_comm_plan_t     *sc_comm_plan_new (int num_receivers, const int *receivers,
+                                      const int *send_counts,
+                                      size_t elem_size, sc_MPI_Comm mpicomm);
+
+/** Free a plan and its persistent requests.
+ * \param [in,out] plan     Must not be active.
+ */
+void                sc_comm_plan_destroy (sc_comm_plan_t * plan);
+
+/** Bind send and receive buffers to a plan.
+ * Persistent requests are created only if a buffer differs from the one
+ * bound before, so rebinding the same buffers every time is cheap.
+ * \param [in,out] plan     Must not be active.
+ * \param [in] send_buffer  Messages back to back in the order of the
+ *                          receivers, send_offsets[num_receivers] elements.
+ * \param [out] recv_buffer Receives the messages back to back in the order
+ *                          of the senders, recv_offsets[num_senders]
+ *                          elements.
+ */
+void                sc_comm_plan_bind (sc_comm_plan_t * plan,
+                                       const void *send_buffer,
+                                       void *recv_buffer);
+
+/** Start the exchange on the bound buffers.
+ * The send buffer must not be modified and the receive buffer must not be
+ * accessed until sc_comm_plan_wait returns.
+ */
+void                sc_comm_plan_start (sc_comm_plan_t * plan);
+
+/** Complete the exchange started by sc_comm_plan_start. */
+void                sc_comm_plan_wait (sc_comm_plan_t * plan);
+
+/** Bind the buffers, then start and complete the exchange. */
+void                sc_comm_plan_execute (sc_comm_plan_t * plan,
+                                          const void *send_buffer,
+                                          void *recv_buffer);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_EXCHANGE_H */
@@ -432,6 +432,23 @@ sc_MPI_Isend (void *buf, int count, sc_MPI_Datatype datatype, int dest,
   return sc_MPI_SUCCESS;
 }
 
+int
+sc_MPI_Send_init (void *buf, int count, sc_MPI_Datatype datatype, int dest,
+                  int tag, sc_MPI_Comm comm, sc_MPI_Request * request)
+{
+  SC_ABORT ("non-MPI MPI_Send_init is not implemented");
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_MPI_Recv_init (void *buf, int count, sc_MPI_Datatype datatype,
+                  int source, int tag, sc_MPI_Comm comm,
+                  sc_MPI_Request * request)
+{
+  SC_ABORT ("non-MPI MPI_Recv_init is not implemented");
+  return sc_MPI_SUCCESS;
+}
+
 int
 sc_MPI_Probe (int source, int tag, sc_MPI_Comm comm, sc_MPI_Status * status)
 {
@@ -492,6 +509,49 @@ sc_MPI_Waitall (int count, sc_MPI_Request * array_of_requests,
   return sc_MPI_SUCCESS;
 }
 
+int
+sc_MPI_Test (sc_MPI_Request * request, int *flag, sc_MPI_Status * status)
+{
+  SC_CHECK_ABORT (*request == sc_MPI_REQUEST_NULL,
+                  "non-MPI MPI_Test handles NULL request only");
+  *flag = 1;
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_MPI_Testall (int count, sc_MPI_Request * array_of_requests, int *flag,
+                sc_MPI_Status * array_of_statuses)
+{
+  int                 i;
+
+  for (i = 0; i < count; ++i) {
+    SC_CHECK_ABORT (array_of_requests[i] == sc_MPI_REQUEST_NULL,
+                    "non-MPI MPI_Testall handles NULL requests only");
+  }
+  *flag = 1;
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_MPI_Startall (int count, sc_MPI_Request * array_of_requests)
+{
+  int                 i;
+
+  for (i = 0; i < count; ++i) {
+    SC_CHECK_ABORT (array_of_requests[i] == sc_MPI_REQUEST_NULL,
+                    "non-MPI MPI_Startall handles NULL requests only");
+  }
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_MPI_Request_free (sc_MPI_Request * request)
+{
+  SC_CHECK_ABORT (*request == sc_MPI_REQUEST_NULL,
+                  "non-MPI MPI_Request_free handles NULL request only");
+  return sc_MPI_SUCCESS;
+}
+
 double
 sc_MPI_Wtime (void)
 {
@@ -552,19 +612,31 @@ sc_mpi_sizeof (sc_MPI_Datatype t)
 
 /* these should be initialized in sc_init() */
 static int          sc_mpi_node_comm_keyval = MPI_KEYVAL_INVALID;
+static int          sc_mpi_nbc_tag_keyval = MPI_KEYVAL_INVALID;
+
+/** The attribute that holds the node communicators. */
+typedef struct sc_mpi_node_comms
+{
+  MPI_Comm            intranode;
+  MPI_Comm            internode;
+  int                 contiguous;       /**< boolean: node i consists of
+                                             the ranks i * intrasize to
+                                             (i + 1) * intrasize - 1 */
+}
+sc_mpi_node_comms_t;
 
 static int
 sc_mpi_node_comms_destroy (MPI_Comm comm, int comm_keyval,
                            void *attribute_val, void *extra_state)
 {
   int                 mpiret;
-  MPI_Comm           *node_comms = (MPI_Comm *) attribute_val;
+  sc_mpi_node_comms_t *node_comms = (sc_mpi_node_comms_t *) attribute_val;
 
-  mpiret = MPI_Comm_free (&node_comms[0]);
+  mpiret = MPI_Comm_free (&node_comms->intranode);
   if (mpiret != MPI_SUCCESS) {
     return mpiret;
   }
-  mpiret = MPI_Comm_free (&node_comms[1]);
+  mpiret = MPI_Comm_free (&node_comms->internode);
   if (mpiret != MPI_SUCCESS) {
     return mpiret;
   }
@@ -579,28 +651,32 @@ sc_mpi_node_comms_copy (MPI_Comm oldcomm, int comm_keyval,
                         void *attribute_val_in,
                         void *attribute_val_out, int *flag)
 {
-  MPI_Comm           *node_comms_in = (MPI_Comm *) attribute_val_in;
-  MPI_Comm           *node_comms_out;
+  sc_mpi_node_comms_t *node_comms_in =
+    (sc_mpi_node_comms_t *) attribute_val_in;
+  sc_mpi_node_comms_t *node_comms_out;
   int                 mpiret;
 
   /* We can't used SC_ALLOC because these might be destroyed after
    * sc finalizes */
-  mpiret =
-    MPI_Alloc_mem (2 * sizeof (MPI_Comm), MPI_INFO_NULL, &node_comms_out);
+  mpiret = MPI_Alloc_mem (sizeof (sc_mpi_node_comms_t), MPI_INFO_NULL,
+                          &node_comms_out);
   if (mpiret != MPI_SUCCESS) {
     return mpiret;
   }
 
-  mpiret = MPI_Comm_dup (node_comms_in[0], &node_comms_out[0]);
+  mpiret = MPI_Comm_dup (node_comms_in->intranode,
+                         &node_comms_out->intranode);
   if (mpiret != MPI_SUCCESS) {
     return mpiret;
   }
-  mpiret = MPI_Comm_dup (node_comms_in[1], &node_comms_out[1]);
+  mpiret = MPI_Comm_dup (node_comms_in->internode,
+                         &node_comms_out->internode);
   if (mpiret != MPI_SUCCESS) {
     return mpiret;
   }
+  node_comms_out->contiguous = node_comms_in->contiguous;
 
-  *((MPI_Comm **) attribute_val_out) = node_comms_out;
+  *((sc_mpi_node_comms_t **) attribute_val_out) = node_comms_out;
   *flag = 1;
 
   return MPI_SUCCESS;
@@ -612,8 +688,9 @@ void
 sc_mpi_comm_attach_node_comms (sc_MPI_Comm comm, int processes_per_node)
 {
 #if defined(SC_ENABLE_MPI)
-  int                 mpiret, rank, size;
-  MPI_Comm           *node_comms, internode, intranode;
+  int                 mpiret, rank, size, contiguous;
+  sc_mpi_node_comms_t *node_comms;
+  MPI_Comm            internode, intranode;
 
   if (sc_mpi_node_comm_keyval == MPI_KEYVAL_INVALID) {
     /* register the node comm attachment with MPI */
@@ -667,6 +744,21 @@ sc_mpi_comm_attach_node_comms (sc_MPI_Comm comm, int processes_per_node)
 
     mpiret = MPI_Comm_split (comm, intrarank, rank, &internode);
     SC_CHECK_MPI (mpiret);
+
+    /* the shared memory nodes need not be blocks of consecutive ranks */
+    {
+      int                 interrank, local;
+
+      mpiret = MPI_Comm_rank (internode, &interrank);
+      SC_CHECK_MPI (mpiret);
+      local = (rank == interrank * intrasize + intrarank);
+      mpiret = MPI_Allreduce (&local, &contiguous, 1, MPI_INT, MPI_LAND,
+                              comm);
+      SC_CHECK_MPI (mpiret);
+    }
+    if (!contiguous) {
+      SC_GLOBAL_LDEBUG ("node communicators are not contiguous\n");
+    }
 #endif
   }
   else {
@@ -682,14 +774,19 @@ sc_mpi_comm_attach_node_comms (sc_MPI_Comm comm, int processes_per_node)
 
     mpiret = MPI_Comm_split (comm, offset, node, &internode);
     SC_CHECK_MPI (mpiret);
+
+    /* contiguous by construction */
+    contiguous = 1;
   }
 
   /* We can't used SC_ALLOC because these might be destroyed after
    * sc finalizes */
-  mpiret = MPI_Alloc_mem (2 * sizeof (MPI_Comm), MPI_INFO_NULL, &node_comms);
+  mpiret = MPI_Alloc_mem (sizeof (sc_mpi_node_comms_t), MPI_INFO_NULL,
+                          &node_comms);
   SC_CHECK_MPI (mpiret);
-  node_comms[0] = intranode;
-  node_comms[1] = internode;
+  node_comms->intranode = intranode;
+  node_comms->internode = internode;
+  node_comms->contiguous = contiguous;
 
   mpiret = MPI_Comm_set_attr (comm, sc_mpi_node_comm_keyval, node_comms);
   SC_CHECK_MPI (mpiret);
@@ -715,7 +812,7 @@ sc_mpi_comm_get_node_comms (sc_MPI_Comm comm,
 {
 #ifdef SC_ENABLE_MPI
   int                 mpiret, flag;
-  sc_MPI_Comm        *node_comms;
+  sc_mpi_node_comms_t *node_comms;
 #endif
 
   *intranode = sc_MPI_COMM_NULL;
@@ -730,8 +827,70 @@ sc_mpi_comm_get_node_comms (sc_MPI_Comm comm,
     MPI_Comm_get_attr (comm, sc_mpi_node_comm_keyval, &node_comms, &flag);
   SC_CHECK_MPI (mpiret);
   if (flag && node_comms) {
-    *intranode = (MPI_Comm) node_comms[0];
-    *internode = (MPI_Comm) node_comms[1];
+    *intranode = node_comms->intranode;
+    *internode = node_comms->internode;
+  }
+#endif
+}
+
+int
+sc_mpi_comm_node_comms_contiguous (sc_MPI_Comm comm)
+{
+#ifdef SC_ENABLE_MPI
+  int                 mpiret, flag;
+  sc_mpi_node_comms_t *node_comms;
+
+  if (sc_mpi_node_comm_keyval == MPI_KEYVAL_INVALID) {
+    return 0;
+  }
+  mpiret =
+    MPI_Comm_get_attr (comm, sc_mpi_node_comm_keyval, &node_comms, &flag);
+  SC_CHECK_MPI (mpiret);
+  return flag && node_comms != NULL && node_comms->contiguous;
+#else
+  return 0;
+#endif
+}
+
+int
+sc_mpi_comm_get_nbc_tag (sc_MPI_Comm comm)
+{
+#ifdef SC_ENABLE_MPI
+  int                 mpiret, flag;
+  void               *attr;
+  intptr_t            count;
+
+  if (sc_mpi_nbc_tag_keyval == MPI_KEYVAL_INVALID) {
+    /* the counter is stored as the attribute value itself */
+    mpiret = MPI_Comm_create_keyval (MPI_COMM_NULL_COPY_FN,
+                                     MPI_COMM_NULL_DELETE_FN,
+                                     &sc_mpi_nbc_tag_keyval, NULL);
+    SC_CHECK_MPI (mpiret);
+  }
+  mpiret = MPI_Comm_get_attr (comm, sc_mpi_nbc_tag_keyval, &attr, &flag);
+  SC_CHECK_MPI (mpiret);
+  count = flag ? (intptr_t) attr : 0;
+  mpiret = MPI_Comm_set_attr (comm, sc_mpi_nbc_tag_keyval,
+                              (void *) (count + 1));
+  SC_CHECK_MPI (mpiret);
+
+  return SC_TAG_NBC + (int) (count % (SC_TAG_NBC_LAST - SC_TAG_NBC + 1));
+#else
+  return SC_TAG_NBC;
+#endif
+}
+
+void
+sc_mpi_free_nbc_tags (void)
+{
+#ifdef SC_ENABLE_MPI
+  int                 mpiret;
+
+  /* communicators that still carry the attribute keep their counters */
+  if (sc_mpi_nbc_tag_keyval != MPI_KEYVAL_INVALID) {
+    mpiret = MPI_Comm_free_keyval (&sc_mpi_nbc_tag_keyval);
+    SC_CHECK_MPI (mpiret);
+    SC_ASSERT (sc_mpi_nbc_tag_keyval == MPI_KEYVAL_INVALID);
   }
 #endif
 }
@@ -61,6 +61,12 @@ typedef enum
   SC_TAG_REDUCE = SC_TAG_NOTIFY_RECURSIVE + 32,
   SC_TAG_PSORT_LO,
   SC_TAG_PSORT_HI,
+  SC_TAG_PSORT_SAMPLE_BUCKET,
+  SC_TAG_PSORT_SAMPLE_PARTITION,
+  SC_TAG_COMM_PLAN,             /**< Messages of persistent plans. */
+  SC_TAG_NBC,                   /**< First of a range of tags cycled through
+                                     by nonblocking collectives. */
+  SC_TAG_NBC_LAST = SC_TAG_NBC + 63,
   SC_TAG_LAST
 }
 sc_tag_t;
@@ -182,6 +188,12 @@ sc_tag_t;
 #define sc_MPI_Wait                MPI_Wait
 #define sc_MPI_Waitsome            MPI_Waitsome
 #define sc_MPI_Waitall             MPI_Waitall
+#define sc_MPI_Test                MPI_Test
+#define sc_MPI_Testall             MPI_Testall
+#define sc_MPI_Send_init           MPI_Send_init
+#define sc_MPI_Recv_init           MPI_Recv_init
+#define sc_MPI_Startall            MPI_Startall
+#define sc_MPI_Request_free        MPI_Request_free
 
 #else /* !SC_ENABLE_MPI */
 
@@ -336,6 +348,10 @@ int                 sc_MPI_Send (void *, int, sc_MPI_Datatype, int, int,
                                  sc_MPI_Comm);
 int                 sc_MPI_Isend (void *, int, sc_MPI_Datatype, int, int,
                                   sc_MPI_Comm, sc_MPI_Request *);
+int                 sc_MPI_Send_init (void *, int, sc_MPI_Datatype, int, int,
+                                      sc_MPI_Comm, sc_MPI_Request *);
+int                 sc_MPI_Recv_init (void *, int, sc_MPI_Datatype, int, int,
+                                      sc_MPI_Comm, sc_MPI_Request *);
 int                 sc_MPI_Probe (int, int, sc_MPI_Comm, sc_MPI_Status *);
 int                 sc_MPI_Iprobe (int, int, sc_MPI_Comm, int *,
                                    sc_MPI_Status *);
@@ -348,6 +364,11 @@ int                 sc_MPI_Wait (sc_MPI_Request *, sc_MPI_Status *);
 int                 sc_MPI_Waitsome (int, sc_MPI_Request *,
                                      int *, int *, sc_MPI_Status *);
 int                 sc_MPI_Waitall (int, sc_MPI_Request *, sc_MPI_Status *);
+int                 sc_MPI_Test (sc_MPI_Request *, int *, sc_MPI_Status *);
+int                 sc_MPI_Testall (int, sc_MPI_Request *, int *,
+                                    sc_MPI_Status *);
+int                 sc_MPI_Startall (int, sc_MPI_Request *);
+int                 sc_MPI_Request_free (sc_MPI_Request *);
 
 #endif /* !SC_ENABLE_MPI */
 
@@ -411,6 +432,34 @@ void                sc_mpi_comm_get_node_comms (sc_MPI_Comm comm,
                                                 sc_MPI_Comm * intranode,
                                                 sc_MPI_Comm * internode);
 
+/** Query whether the node communicators attached to a communicator
+ * partition it into blocks of consecutive ranks.  This is always true if
+ * \a processes_per_node was passed to sc_mpi_comm_attach_node_comms(),
+ * but not necessarily for shared memory nodes, depending on the mapping
+ * of the ranks to the nodes.
+ * \param [in] comm           Super communicator
+ * \return                    True if node communicators are attached and
+ *                            node i consists of the ranks i * intrasize
+ *                            to (i + 1) * intrasize - 1.
+ */
+int                 sc_mpi_comm_node_comms_contiguous (sc_MPI_Comm comm);
+
+/** Return the tag for the next nonblocking collective on a communicator.
+ * The tags cycle through the range from SC_TAG_NBC to SC_TAG_NBC_LAST.
+ * Since collectives are started in the same order on all processes of a
+ * communicator, every process obtains the same tag for the same operation,
+ * and different operations that are in flight simultaneously do not mix.
+ * \param [in] comm          The communicator of the collective.
+ * \return                   A tag between SC_TAG_NBC and SC_TAG_NBC_LAST.
+ */
+int                 sc_mpi_comm_get_nbc_tag (sc_MPI_Comm comm);
+
+/** Free the attribute key of the tag counters of sc_mpi_comm_get_nbc_tag.
+ * This is called by sc_finalize.  The counters restart from SC_TAG_NBC on
+ * the next call to sc_mpi_comm_get_nbc_tag.
+ */
+void                sc_mpi_free_nbc_tags (void);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_MPI_H */
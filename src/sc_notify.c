@@ -24,6 +24,86 @@
 #include <sc_containers.h>
 #include <sc_notify.h>
 
+const char         *sc_notify_type_to_string[SC_NOTIFY_NUM_TYPES] = {
+  "default",
+  "allgather",
+  "binary",
+  "nbx"
+};
+
+sc_notify_type_t    sc_notify_default_type = SC_NOTIFY_BINARY;
+
+#ifdef SC_ENABLE_MPI
+static int          sc_notify_keyval = MPI_KEYVAL_INVALID;
+
+/* the attribute points into this array */
+static sc_notify_type_t sc_notify_types[SC_NOTIFY_NUM_TYPES] = {
+  SC_NOTIFY_DEFAULT,
+  SC_NOTIFY_ALLGATHER,
+  SC_NOTIFY_BINARY,
+  SC_NOTIFY_NBX
+};
+#endif
+
+void
+sc_notify_set_type (sc_MPI_Comm mpicomm, sc_notify_type_t type)
+{
+#ifdef SC_ENABLE_MPI
+  int                 mpiret;
+
+  SC_ASSERT (0 <= type && type < SC_NOTIFY_NUM_TYPES);
+  if (sc_notify_keyval == MPI_KEYVAL_INVALID) {
+    mpiret = MPI_Comm_create_keyval (MPI_COMM_DUP_FN,
+                                     MPI_COMM_NULL_DELETE_FN,
+                                     &sc_notify_keyval, NULL);
+    SC_CHECK_MPI (mpiret);
+  }
+  if (type == SC_NOTIFY_DEFAULT) {
+    mpiret = MPI_Comm_delete_attr (mpicomm, sc_notify_keyval);
+  }
+  else {
+    mpiret = MPI_Comm_set_attr (mpicomm, sc_notify_keyval,
+                                &sc_notify_types[type]);
+  }
+  SC_CHECK_MPI (mpiret);
+#endif
+}
+
+sc_notify_type_t
+sc_notify_get_type (sc_MPI_Comm mpicomm)
+{
+#ifdef SC_ENABLE_MPI
+  int                 mpiret, flag;
+  sc_notify_type_t   *type;
+
+  if (sc_notify_keyval != MPI_KEYVAL_INVALID) {
+    mpiret = MPI_Comm_get_attr (mpicomm, sc_notify_keyval, &type, &flag);
+    SC_CHECK_MPI (mpiret);
+    if (flag) {
+      return *type;
+    }
+  }
+#endif
+  SC_CHECK_ABORT (0 < sc_notify_default_type &&
+                  sc_notify_default_type < SC_NOTIFY_NUM_TYPES,
+                  "sc_notify_default_type must name an algorithm");
+  return sc_notify_default_type;
+}
+
+void
+sc_notify_free_types (void)
+{
+#ifdef SC_ENABLE_MPI
+  int                 mpiret;
+
+  if (sc_notify_keyval != MPI_KEYVAL_INVALID) {
+    mpiret = MPI_Comm_free_keyval (&sc_notify_keyval);
+    SC_CHECK_MPI (mpiret);
+    SC_ASSERT (sc_notify_keyval == MPI_KEYVAL_INVALID);
+  }
+#endif
+}
+
 int
 sc_notify_allgather (int *receivers, int num_receivers,
                      int *senders, int *num_senders, sc_MPI_Comm mpicomm)
@@ -375,9 +455,9 @@ sc_notify_recursive (sc_MPI_Comm mpicomm, int start, int me, int length,
 #endif
 }
 
-int
-sc_notify (int *receivers, int num_receivers,
-           int *senders, int *num_senders, sc_MPI_Comm mpicomm)
+static int
+sc_notify_binary (int *receivers, int num_receivers,
+                  int *senders, int *num_senders, sc_MPI_Comm mpicomm)
 {
   int                 i;
   int                 mpiret;
@@ -432,3 +512,122 @@ sc_notify (int *receivers, int num_receivers,
 
   return sc_MPI_SUCCESS;
 }
+
+int
+sc_notify_nbx (int *receivers, int num_receivers,
+               int *senders, int *num_senders, sc_MPI_Comm mpicomm)
+{
+#ifdef SC_ENABLE_MPINBC
+  int                 i;
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  int                 tag, flag;
+  int                 found_num_senders, barrier_active;
+  sc_MPI_Request     *requests, barrier;
+  sc_MPI_Status       status;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  SC_ASSERT (num_receivers >= 0);
+  SC_ASSERT (senders != NULL && num_senders != NULL);
+
+  /* a synchronous send completes once it is being received */
+  found_num_senders = 0;
+  tag = sc_mpi_comm_get_nbc_tag (mpicomm);
+  requests = SC_ALLOC (sc_MPI_Request, num_receivers);
+  for (i = 0; i < num_receivers; ++i) {
+    SC_ASSERT (0 <= receivers[i] && receivers[i] < mpisize);
+    requests[i] = sc_MPI_REQUEST_NULL;
+    if (receivers[i] == mpirank) {
+      senders[found_num_senders++] = mpirank;
+      continue;
+    }
+    mpiret = MPI_Issend (NULL, 0, sc_MPI_BYTE, receivers[i], tag, mpicomm,
+                         requests + i);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* receive until all processes have had all their sends matched */
+  barrier_active = 0;
+  for (;;) {
+    mpiret = sc_MPI_Iprobe (sc_MPI_ANY_SOURCE, tag, mpicomm, &flag, &status);
+    SC_CHECK_MPI (mpiret);
+    if (flag) {
+      SC_ASSERT (found_num_senders < mpisize);
+      senders[found_num_senders++] = status.MPI_SOURCE;
+      mpiret = sc_MPI_Recv (NULL, 0, sc_MPI_BYTE, status.MPI_SOURCE, tag,
+                            mpicomm, sc_MPI_STATUS_IGNORE);
+      SC_CHECK_MPI (mpiret);
+    }
+    if (!barrier_active) {
+      mpiret = sc_MPI_Testall (num_receivers, requests, &flag,
+                               sc_MPI_STATUSES_IGNORE);
+      SC_CHECK_MPI (mpiret);
+      if (flag) {
+        mpiret = MPI_Ibarrier (mpicomm, &barrier);
+        SC_CHECK_MPI (mpiret);
+        barrier_active = 1;
+      }
+    }
+    else {
+      mpiret = sc_MPI_Test (&barrier, &flag, sc_MPI_STATUS_IGNORE);
+      SC_CHECK_MPI (mpiret);
+      if (flag) {
+        break;
+      }
+    }
+  }
+  SC_FREE (requests);
+
+  qsort (senders, (size_t) found_num_senders, sizeof (int), sc_int_compare);
+  *num_senders = found_num_senders;
+
+  return sc_MPI_SUCCESS;
+#else
+  int                *sorted;
+  int                 mpiret;
+
+  sorted = SC_ALLOC (int, num_receivers);
+  memcpy (sorted, receivers, num_receivers * sizeof (int));
+  qsort (sorted, (size_t) num_receivers, sizeof (int), sc_int_compare);
+  mpiret = sc_notify_binary (sorted, num_receivers, senders, num_senders,
+                             mpicomm);
+  SC_FREE (sorted);
+
+  return mpiret;
+#endif
+}
+
+int
+sc_notify_ext (int *receivers, int num_receivers,
+               int *senders, int *num_senders, sc_MPI_Comm mpicomm,
+               sc_notify_type_t type)
+{
+  if (type == SC_NOTIFY_DEFAULT) {
+    type = sc_notify_get_type (mpicomm);
+  }
+  switch (type) {
+  case SC_NOTIFY_ALLGATHER:
+    return sc_notify_allgather (receivers, num_receivers, senders,
+                                num_senders, mpicomm);
+  case SC_NOTIFY_BINARY:
+    return sc_notify_binary (receivers, num_receivers, senders,
+                             num_senders, mpicomm);
+  case SC_NOTIFY_NBX:
+    return sc_notify_nbx (receivers, num_receivers, senders,
+                          num_senders, mpicomm);
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+}
+
+int
+sc_notify (int *receivers, int num_receivers,
+           int *senders, int *num_senders, sc_MPI_Comm mpicomm)
+{
+  return sc_notify_ext (receivers, num_receivers, senders, num_senders,
+                        mpicomm, SC_NOTIFY_DEFAULT);
+}
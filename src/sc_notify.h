@@ -28,6 +28,41 @@
 
 SC_EXTERN_C_BEGIN;
 
+/** Algorithms to compute the senders from the receivers. */
+typedef enum
+{
+  SC_NOTIFY_DEFAULT,            /**< Use the communicator's setting. */
+  SC_NOTIFY_ALLGATHER,          /**< Use sc_notify_allgather. */
+  SC_NOTIFY_BINARY,             /**< Use the recursive binary merge. */
+  SC_NOTIFY_NBX,                /**< Use sc_notify_nbx. */
+  SC_NOTIFY_NUM_TYPES
+}
+sc_notify_type_t;
+
+extern const char  *sc_notify_type_to_string[SC_NOTIFY_NUM_TYPES];
+
+/** The algorithm used on communicators without a setting of their own. */
+extern sc_notify_type_t sc_notify_default_type;
+
+/** Set the notify algorithm used on a communicator.
+ * \param [in] mpicomm          MPI communicator, attribute is attached.
+ * \param [in] type             Algorithm; SC_NOTIFY_DEFAULT removes the
+ *                              setting and thus selects the global default.
+ */
+void                sc_notify_set_type (sc_MPI_Comm mpicomm,
+                                        sc_notify_type_t type);
+
+/** Return the notify algorithm used on a communicator.
+ * \return                      Never SC_NOTIFY_DEFAULT.
+ */
+sc_notify_type_t    sc_notify_get_type (sc_MPI_Comm mpicomm);
+
+/** Free the attribute key of the settings of sc_notify_set_type.
+ * This is called by sc_finalize.  Afterwards all communicators use
+ * sc_notify_default_type until sc_notify_set_type is called again.
+ */
+void                sc_notify_free_types (void);
+
 /** Collective call to notify a set of receiver ranks of current rank.
  * This version uses one call to sc_MPI_Allgather and one to sc_MPI_Allgatherv.
  * \see sc_notify
@@ -44,6 +79,42 @@ int                 sc_notify_allgather (int *receivers, int num_receivers,
                                          sc_MPI_Comm mpicomm);
 
 /** Collective call to notify a set of receiver ranks of current rank.
+ * This version sends a synchronous empty message to every receiver and
+ * detects global completion by a nonblocking barrier (the NBX algorithm).
+ * Its cost depends on the number of receivers and senders, not on the size
+ * of the communicator.  Without MPI nonblocking collectives, this function
+ * falls back to the binary algorithm of sc_notify.
+ * \see sc_notify
+ * \param [in] receivers        Array of unique MPI ranks to inform.
+ * \param [in] num_receivers    Count of ranks contained in receivers.
+ * \param [in,out] senders      Array of at least size sc_MPI_Comm_size.
+ *                              On output it contains the notifying ranks
+ *                              in ascending order.
+ * \param [out] num_senders     On output the number of notifying ranks.
+ * \param [in] mpicomm          MPI communicator to use.
+ * \return                      Aborts on MPI error or returns sc_MPI_SUCCESS.
+ */
+int                 sc_notify_nbx (int *receivers, int num_receivers,
+                                   int *senders, int *num_senders,
+                                   sc_MPI_Comm mpicomm);
+
+/** Collective call to notify a set of receiver ranks of current rank.
+ * \param [in] receivers        Sorted and unique array of MPI ranks to inform.
+ * \param [in] num_receivers    Count of ranks contained in receivers.
+ * \param [in,out] senders      Array of at least size sc_MPI_Comm_size.
+ *                              On output it contains the notifying ranks.
+ * \param [out] num_senders     On output the number of notifying ranks.
+ * \param [in] mpicomm          MPI communicator to use.
+ * \param [in] type             The algorithm to use.
+ * \return                      Aborts on MPI error or returns sc_MPI_SUCCESS.
+ */
+int                 sc_notify_ext (int *receivers, int num_receivers,
+                                   int *senders, int *num_senders,
+                                   sc_MPI_Comm mpicomm,
+                                   sc_notify_type_t type);
+
+/** Collective call to notify a set of receiver ranks of current rank.
+ * The algorithm is chosen by sc_notify_get_type.
  * \param [in] receivers        Sorted and unique array of MPI ranks to inform.
  * \param [in] num_receivers    Count of ranks contained in receivers.
  * \param [in,out] senders      Array of at least size sc_MPI_Comm_size.
@@ -24,6 +24,8 @@
 #include <sc_reduce.h>
 #include <sc_search.h>
 
+int                 sc_reduce_use_node_comms = 1;
+
 static void
 sc_reduce_alltoall (sc_MPI_Comm mpicomm,
                     void *data, int count, sc_MPI_Datatype datatype,
@@ -473,6 +475,87 @@ sc_reduce_sum (void *sendbuf, void *recvbuf,
   }
 }
 
+/** Reduce within a communicator by the binary tree over its ranks.
+ * \param [in,out] data    Local contribution on input, result on output
+ *                         on the target or on all ranks if target is -1.
+ */
+static void
+sc_reduce_tree (sc_MPI_Comm mpicomm, void *data, int count,
+                sc_MPI_Datatype datatype, sc_reduce_t reduce_fn, int target)
+{
+  int                 mpiret;
+  int                 mpisize;
+  int                 mpirank;
+  int                 maxlevel;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  SC_ASSERT (-1 <= target && target < mpisize);
+
+  maxlevel = SC_LOG2_32 (mpisize - 1) + 1;
+  sc_reduce_recursive (mpicomm, data, count, datatype, mpisize,
+                       target, maxlevel, maxlevel, mpirank, reduce_fn);
+}
+
+/** Reduce in two levels: first on every node, then between node roots.
+ * The node root of lowest rank obtains the result and forwards it to the
+ * target, or the node roots broadcast it on their nodes for allreduce.
+ */
+static void
+sc_reduce_node (sc_MPI_Comm mpicomm, void *data, int count,
+                sc_MPI_Datatype datatype, sc_reduce_t reduce_fn, int target,
+                sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  int                 mpiret;
+  int                 mpirank;
+  int                 intrarank, interrank;
+  int                 is_first;
+  size_t              datasize;
+  sc_MPI_Status       rstatus;
+
+  SC_ASSERT (sc_mpi_comm_node_comms_contiguous (mpicomm));
+
+  /* *INDENT-OFF* HORRIBLE indent bug */
+  datasize = (size_t) count * sc_mpi_sizeof (datatype);
+  /* *INDENT-ON* */
+
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+
+  /* reduce on the node to its root, then between the node roots */
+  sc_reduce_tree (intranode, data, count, datatype, reduce_fn, 0);
+  is_first = 0;
+  if (intrarank == 0) {
+    mpiret = sc_MPI_Comm_rank (internode, &interrank);
+    SC_CHECK_MPI (mpiret);
+    sc_reduce_tree (internode, data, count, datatype, reduce_fn,
+                    target == -1 ? -1 : 0);
+    is_first = (interrank == 0);
+  }
+
+  if (target == -1) {
+    /* every node root holds the result and shares it on the node */
+    mpiret = sc_MPI_Bcast (data, (int) datasize, sc_MPI_BYTE, 0, intranode);
+    SC_CHECK_MPI (mpiret);
+  }
+  else if (is_first && mpirank != target) {
+    mpiret = sc_MPI_Send (data, (int) datasize, sc_MPI_BYTE,
+                          target, SC_TAG_REDUCE, mpicomm);
+    SC_CHECK_MPI (mpiret);
+  }
+  else if (!is_first && mpirank == target) {
+    /* the first node root is rank 0 since the nodes are contiguous */
+    mpiret = sc_MPI_Recv (data, (int) datasize, sc_MPI_BYTE,
+                          0, SC_TAG_REDUCE, mpicomm, &rstatus);
+    SC_CHECK_MPI (mpiret);
+  }
+}
+
 static int
 sc_reduce_custom_dispatch (void *sendbuf, void *recvbuf, int sendcount,
                            sc_MPI_Datatype sendtype, sc_reduce_t reduce_fn,
@@ -480,9 +563,9 @@ sc_reduce_custom_dispatch (void *sendbuf, void *recvbuf, int sendcount,
 {
   int                 mpiret;
   int                 mpisize;
-  int                 mpirank;
-  int                 maxlevel;
+  int                 intrasize;
   size_t              datasize;
+  sc_MPI_Comm         intranode, internode;
 
   SC_ASSERT (sendcount >= 0);
 
@@ -491,16 +574,25 @@ sc_reduce_custom_dispatch (void *sendbuf, void *recvbuf, int sendcount,
   /* *INDENT-ON* */
   memcpy (recvbuf, sendbuf, datasize);
 
-  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
-  SC_CHECK_MPI (mpiret);
-  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
-  SC_CHECK_MPI (mpiret);
-
-  SC_ASSERT (-1 <= target && target < mpisize);
+  /* use two levels if there are several nodes of several processes;
+     the order of the operands is kept only for contiguous nodes */
+  if (sc_reduce_use_node_comms) {
+    sc_mpi_comm_get_node_comms (mpicomm, &intranode, &internode);
+    if (intranode != sc_MPI_COMM_NULL && internode != sc_MPI_COMM_NULL &&
+        sc_mpi_comm_node_comms_contiguous (mpicomm)) {
+      mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+      SC_CHECK_MPI (mpiret);
+      mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+      SC_CHECK_MPI (mpiret);
+      if (intrasize > 1 && intrasize < mpisize) {
+        sc_reduce_node (mpicomm, recvbuf, sendcount, sendtype, reduce_fn,
+                        target, intranode, internode);
+        return sc_MPI_SUCCESS;
+      }
+    }
+  }
 
-  maxlevel = SC_LOG2_32 (mpisize - 1) + 1;
-  sc_reduce_recursive (mpicomm, recvbuf, sendcount, sendtype, mpisize,
-                       target, maxlevel, maxlevel, mpirank, reduce_fn);
+  sc_reduce_tree (mpicomm, recvbuf, sendcount, sendtype, reduce_fn, target);
 
   return sc_MPI_SUCCESS;
 }
@@ -526,6 +618,19 @@ sc_reduce_custom (void *sendbuf, void *recvbuf, int sendcount,
                                     sendtype, reduce_fn, target, mpicomm);
 }
 
+static              sc_reduce_t
+sc_reduce_operation (sc_MPI_Op operation)
+{
+  if (operation == sc_MPI_MAX)
+    return sc_reduce_max;
+  else if (operation == sc_MPI_MIN)
+    return sc_reduce_min;
+  else if (operation == sc_MPI_SUM)
+    return sc_reduce_sum;
+  else
+    SC_ABORT ("Unsupported operation in sc_allreduce or sc_reduce");
+}
+
 static int
 sc_reduce_dispatch (void *sendbuf, void *recvbuf, int sendcount,
                     sc_MPI_Datatype sendtype, sc_MPI_Op operation,
@@ -533,14 +638,7 @@ sc_reduce_dispatch (void *sendbuf, void *recvbuf, int sendcount,
 {
   sc_reduce_t         reduce_fn;
 
-  if (operation == sc_MPI_MAX)
-    reduce_fn = sc_reduce_max;
-  else if (operation == sc_MPI_MIN)
-    reduce_fn = sc_reduce_min;
-  else if (operation == sc_MPI_SUM)
-    reduce_fn = sc_reduce_sum;
-  else
-    SC_ABORT ("Unsupported operation in sc_allreduce or sc_reduce");
+  reduce_fn = sc_reduce_operation (operation);
 
   return sc_reduce_custom_dispatch (sendbuf, recvbuf, sendcount,
                                     sendtype, reduce_fn, target, mpicomm);
@@ -565,3 +663,255 @@ sc_reduce (void *sendbuf, void *recvbuf, int sendcount,
   return sc_reduce_dispatch (sendbuf, recvbuf, sendcount,
                              sendtype, operation, target, mpicomm);
 }
+
+/** Stages of the recursive doubling in a nonblocking allreduce. */
+typedef enum
+{
+  SC_IREDUCE_EXTRA,             /* surplus rank waits for the result */
+  SC_IREDUCE_PRE,               /* receive from the surplus partner */
+  SC_IREDUCE_ROUND,             /* exchange with the round partner */
+  SC_IREDUCE_POST,              /* send the result to surplus partner */
+  SC_IREDUCE_DONE
+}
+sc_ireduce_stage_t;
+
+struct sc_reduce_request
+{
+  int                 native;
+  sc_MPI_Comm         mpicomm;
+  int                 tag, rank, size, pof2;
+  int                 mask;
+  sc_ireduce_stage_t  stage;
+  int                 count;
+  sc_MPI_Datatype     datatype;
+  size_t              datasize;
+  sc_reduce_t         reduce_fn;
+  char               *data, *peerdata;
+  sc_MPI_Request      requests[2];
+};
+
+/** Post the messages of the current round of recursive doubling. */
+static void
+sc_iallreduce_post_round (sc_reduce_request_t * req)
+{
+  int                 mpiret;
+  int                 peer = req->rank ^ req->mask;
+
+  mpiret = sc_MPI_Irecv (req->peerdata, (int) req->datasize, sc_MPI_BYTE,
+                         peer, req->tag, req->mpicomm, req->requests + 0);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Isend (req->data, (int) req->datasize, sc_MPI_BYTE,
+                         peer, req->tag, req->mpicomm, req->requests + 1);
+  SC_CHECK_MPI (mpiret);
+  req->stage = SC_IREDUCE_ROUND;
+}
+
+/** Combine the received data with the local data.
+ * The data of the lower rank is always the second argument of the reduction
+ * function such that both partners compute the identical result.
+ */
+static void
+sc_iallreduce_combine (sc_reduce_request_t * req, int peer_is_higher)
+{
+  char               *scratch = req->peerdata + req->datasize;
+
+  if (!peer_is_higher) {
+    memcpy (scratch, req->data, req->datasize);
+    memcpy (req->data, req->peerdata, req->datasize);
+    memcpy (req->peerdata, scratch, req->datasize);
+  }
+  req->reduce_fn (req->peerdata, req->data, req->count, req->datatype);
+}
+
+/** Advance the state machine after all posted messages have completed. */
+static void
+sc_iallreduce_advance (sc_reduce_request_t * req)
+{
+  int                 mpiret;
+  int                 rem = req->size - req->pof2;
+
+  switch (req->stage) {
+  case SC_IREDUCE_PRE:
+    sc_iallreduce_combine (req, 1);
+    /* fall through */
+  case SC_IREDUCE_ROUND:
+    if (req->stage == SC_IREDUCE_ROUND) {
+      sc_iallreduce_combine (req, (req->rank ^ req->mask) > req->rank);
+      req->mask <<= 1;
+    }
+    if (req->mask < req->pof2) {
+      sc_iallreduce_post_round (req);
+    }
+    else if (req->rank < rem) {
+      mpiret = sc_MPI_Isend (req->data, (int) req->datasize, sc_MPI_BYTE,
+                             req->rank + req->pof2, req->tag, req->mpicomm,
+                             req->requests + 0);
+      SC_CHECK_MPI (mpiret);
+      req->stage = SC_IREDUCE_POST;
+    }
+    else {
+      req->stage = SC_IREDUCE_DONE;
+    }
+    break;
+  case SC_IREDUCE_EXTRA:
+  case SC_IREDUCE_POST:
+    req->stage = SC_IREDUCE_DONE;
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+}
+
+/** Progress a request and free it on completion.
+ * \return True if the request has completed.
+ */
+static int
+sc_iallreduce_progress (sc_reduce_request_t ** request, int block)
+{
+  int                 mpiret;
+  int                 flag;
+  sc_reduce_request_t *req = *request;
+
+  SC_ASSERT (req != NULL);
+  if (req->native) {
+    if (block) {
+      mpiret = sc_MPI_Wait (req->requests, sc_MPI_STATUS_IGNORE);
+      SC_CHECK_MPI (mpiret);
+    }
+    else {
+      mpiret = sc_MPI_Test (req->requests, &flag, sc_MPI_STATUS_IGNORE);
+      SC_CHECK_MPI (mpiret);
+      if (!flag) {
+        return 0;
+      }
+    }
+    req->stage = SC_IREDUCE_DONE;
+  }
+  while (req->stage != SC_IREDUCE_DONE) {
+    if (block) {
+      mpiret = sc_MPI_Waitall (2, req->requests, sc_MPI_STATUSES_IGNORE);
+      SC_CHECK_MPI (mpiret);
+    }
+    else {
+      mpiret = sc_MPI_Testall (2, req->requests, &flag,
+                               sc_MPI_STATUSES_IGNORE);
+      SC_CHECK_MPI (mpiret);
+      if (!flag) {
+        return 0;
+      }
+    }
+    sc_iallreduce_advance (req);
+  }
+
+  SC_FREE (req->peerdata);
+  SC_FREE (req);
+  *request = NULL;
+  return 1;
+}
+
+int
+sc_iallreduce_custom (void *sendbuf, void *recvbuf, int sendcount,
+                      sc_MPI_Datatype sendtype, sc_reduce_t reduce_fn,
+                      sc_MPI_Comm mpicomm, sc_reduce_request_t ** request)
+{
+  int                 mpiret;
+  int                 rem;
+  sc_reduce_request_t *req;
+
+  SC_ASSERT (sendcount >= 0);
+  SC_ASSERT (reduce_fn != NULL);
+  SC_ASSERT (request != NULL);
+
+  req = *request = SC_ALLOC_ZERO (sc_reduce_request_t, 1);
+  req->mpicomm = mpicomm;
+  req->count = sendcount;
+  req->datatype = sendtype;
+  req->reduce_fn = reduce_fn;
+  req->requests[0] = req->requests[1] = sc_MPI_REQUEST_NULL;
+
+  /* *INDENT-OFF* HORRIBLE indent bug */
+  req->datasize = (size_t) sendcount * sc_mpi_sizeof (sendtype);
+  /* *INDENT-ON* */
+  req->data = (char *) recvbuf;
+  memcpy (req->data, sendbuf, req->datasize);
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &req->size);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &req->rank);
+  SC_CHECK_MPI (mpiret);
+  if (req->size == 1) {
+    req->stage = SC_IREDUCE_DONE;
+    return sc_MPI_SUCCESS;
+  }
+
+  /* the surplus ranks beyond the largest power of two join through a
+     partner; the second half of peerdata is scratch space */
+  req->tag = sc_mpi_comm_get_nbc_tag (mpicomm);
+  req->pof2 = 1 << SC_LOG2_32 (req->size);
+  req->mask = 1;
+  req->peerdata = SC_ALLOC (char, 2 * req->datasize);
+  rem = req->size - req->pof2;
+  if (req->rank >= req->pof2) {
+    memcpy (req->peerdata, req->data, req->datasize);
+    mpiret = sc_MPI_Isend (req->peerdata, (int) req->datasize, sc_MPI_BYTE,
+                           req->rank - req->pof2, req->tag, mpicomm,
+                           req->requests + 0);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Irecv (req->data, (int) req->datasize, sc_MPI_BYTE,
+                           req->rank - req->pof2, req->tag, mpicomm,
+                           req->requests + 1);
+    SC_CHECK_MPI (mpiret);
+    req->stage = SC_IREDUCE_EXTRA;
+  }
+  else if (req->rank < rem) {
+    mpiret = sc_MPI_Irecv (req->peerdata, (int) req->datasize, sc_MPI_BYTE,
+                           req->rank + req->pof2, req->tag, mpicomm,
+                           req->requests + 0);
+    SC_CHECK_MPI (mpiret);
+    req->stage = SC_IREDUCE_PRE;
+  }
+  else {
+    sc_iallreduce_post_round (req);
+  }
+
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_iallreduce (void *sendbuf, void *recvbuf, int sendcount,
+               sc_MPI_Datatype sendtype, sc_MPI_Op operation,
+               sc_MPI_Comm mpicomm, sc_reduce_request_t ** request)
+{
+#ifdef SC_ENABLE_MPINBC
+  int                 mpiret;
+  sc_reduce_request_t *req;
+
+  req = *request = SC_ALLOC_ZERO (sc_reduce_request_t, 1);
+  req->native = 1;
+  mpiret = MPI_Iallreduce (sendbuf, recvbuf, sendcount, sendtype, operation,
+                           mpicomm, req->requests);
+  SC_CHECK_MPI (mpiret);
+
+  return sc_MPI_SUCCESS;
+#else
+  return sc_iallreduce_custom (sendbuf, recvbuf, sendcount, sendtype,
+                               sc_reduce_operation (operation), mpicomm,
+                               request);
+#endif
+}
+
+int
+sc_iallreduce_test (sc_reduce_request_t ** request, int *flag)
+{
+  *flag = sc_iallreduce_progress (request, 0);
+
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_iallreduce_wait (sc_reduce_request_t ** request)
+{
+  SC_EXECUTE_ASSERT_TRUE (sc_iallreduce_progress (request, 1));
+
+  return sc_MPI_SUCCESS;
+}
@@ -33,6 +33,15 @@
 
 SC_EXTERN_C_BEGIN;
 
+/** If true (the default), the reductions below run in two levels when
+ * node communicators are attached to the communicator by
+ * sc_mpi_comm_attach_node_comms: first on each node, then between nodes.
+ * This limits the internode messages to one per node.  Nodes that are not
+ * blocks of consecutive ranks use the flat algorithm, since the two-level
+ * one would reorder the operands of non-commutative reductions.
+ */
+extern int          sc_reduce_use_node_comms;
+
 typedef void        (*sc_reduce_t) (void *sendbuf, void *recvbuf,
                                     int sendcount, sc_MPI_Datatype sendtype);
 
@@ -65,6 +74,48 @@ int                 sc_reduce (void *sendbuf, void *recvbuf, int sendcount,
                                sc_MPI_Datatype sendtype, sc_MPI_Op operation,
                                int target, sc_MPI_Comm mpicomm);
 
+/** Opaque handle of a nonblocking allreduce. */
+typedef struct sc_reduce_request sc_reduce_request_t;
+
+/** Start a nonblocking custom allreduce.
+ * The operation proceeds by point-to-point messages in recursive doubling
+ * that advance on every call to sc_iallreduce_test or sc_iallreduce_wait.
+ * The reduction is applied in the same order on all processes, so every
+ * process obtains bitwise the same result.
+ * Nonblocking collectives must be started in the same order on all
+ * processes of the communicator.  The buffers must not be accessed until
+ * the request has completed.
+ * \param [out] request    Handle to be passed to sc_iallreduce_test or
+ *                         sc_iallreduce_wait.  Set to NULL on completion.
+ */
+int                 sc_iallreduce_custom (void *sendbuf, void *recvbuf,
+                                          int sendcount,
+                                          sc_MPI_Datatype sendtype,
+                                          sc_reduce_t reduce_fn,
+                                          sc_MPI_Comm mpicomm,
+                                          sc_reduce_request_t ** request);
+
+/** Start a nonblocking allreduce with MPI_MAX, MPI_MIN, or MPI_SUM.
+ * Maps to MPI_Iallreduce if MPI provides it and behaves like
+ * sc_iallreduce_custom otherwise.
+ */
+int                 sc_iallreduce (void *sendbuf, void *recvbuf,
+                                   int sendcount, sc_MPI_Datatype sendtype,
+                                   sc_MPI_Op operation, sc_MPI_Comm mpicomm,
+                                   sc_reduce_request_t ** request);
+
+/** Progress a nonblocking allreduce without blocking.
+ * \param [in,out] request On completion, the request is freed and NULL.
+ * \param [out] flag       True if the allreduce has completed.
+ */
+int                 sc_iallreduce_test (sc_reduce_request_t ** request,
+                                        int *flag);
+
+/** Complete a nonblocking allreduce.
+ * \param [in,out] request Freed and set to NULL.
+ */
+int                 sc_iallreduce_wait (sc_reduce_request_t ** request);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_REDUCE_H */
@@ -22,6 +22,11 @@
 */
 
 #include <sc_shmem.h>
+#if defined(SC_ENABLE_SHMPOSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #if defined(__bgq__)
 /** for sc_allgather_final_*_bgq routines to work on BG/Q, you must
@@ -38,6 +43,9 @@ const char         *sc_shmem_type_to_string[SC_SHMEM_NUM_TYPES] = {
 #if defined(SC_ENABLE_MPIWINSHARED)
   "window", "window_prescan",
 #endif
+#if defined(SC_ENABLE_SHMPOSIX)
+  "posix", "posix_prescan",
+#endif
 #if defined(__bgq__)
   "bgq", "bgq_prescan",
 #endif
@@ -181,10 +189,14 @@ static sc_shmem_type_t sc_shmem_types[SC_SHMEM_NUM_TYPES] = {
   SC_SHMEM_PRESCAN,
 #if defined(SC_ENABLE_MPIWINSHARED)
   SC_SHMEM_WINDOW,
-  SC_SHMEM_WINDOW_PRESCAN
+  SC_SHMEM_WINDOW_PRESCAN,
+#endif
+#if defined(SC_ENABLE_SHMPOSIX)
+  SC_SHMEM_POSIX,
+  SC_SHMEM_POSIX_PRESCAN,
 #endif
 #if defined(__bgq__)
-    SC_SHMEM_BGQ,
+  SC_SHMEM_BGQ,
   SC_SHMEM_BGQ_PRESCAN,
 #endif
 };
@@ -342,9 +354,10 @@ sc_shmem_prefix_prescan (void *sendbuf, void *recvbuf, int count,
   SC_FREE (sendscan);
 }
 
-/* common to SHARED and WINDOW */
+/* common to SHARED, WINDOW and POSIX */
 
-#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED)
+#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED) || \
+  defined(SC_ENABLE_SHMPOSIX)
 
 static void
 sc_shmem_memcpy_common (void *destarray, void *srcarray, size_t bytes,
@@ -357,6 +370,12 @@ sc_shmem_memcpy_common (void *destarray, void *srcarray, size_t bytes,
   sc_shmem_write_end (destarray, comm);
 }
 
+#endif
+
+/* common to SHARED and WINDOW */
+
+#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED)
+
 static void
 sc_shmem_allgather_common (void *sendbuf, int sendcount,
                            sc_MPI_Datatype sendtype, void *recvbuf,
@@ -665,6 +684,193 @@ sc_shmem_write_end_window (void *array, sc_MPI_Comm comm,
 }
 #endif /* SC_ENABLE_MPIWINSHARED */
 
+#if defined(SC_ENABLE_SHMPOSIX)
+/* POSIX shared memory implementation */
+
+/** The header in front of a POSIX array keeps the length of the mapping.
+ * Its size keeps the array aligned for any element type. */
+#define SC_SHMEM_POSIX_HEADER 64
+
+static void        *
+sc_shmem_malloc_posix (int package, size_t elem_size, size_t elem_count,
+                       sc_MPI_Comm comm, sc_MPI_Comm intranode,
+                       sc_MPI_Comm internode)
+{
+  static int          posix_count = 0;
+  char                name[64];
+  char               *array;
+  int                 mpiret, intrarank;
+  int                 fd = -1;
+  size_t              length;
+
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+  length = SC_SHMEM_POSIX_HEADER + elem_size * elem_count;
+
+  /* the node root creates the segment and broadcasts its name */
+  if (!intrarank) {
+    snprintf (name, sizeof (name), "/sc_shmem_%ld_%d", (long) getpid (),
+              posix_count++);
+    fd = shm_open (name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    SC_CHECK_ABORTF (fd >= 0, "shm_open create %s", name);
+    SC_CHECK_ABORT (ftruncate (fd, (off_t) length) == 0, "ftruncate");
+  }
+  mpiret = sc_MPI_Bcast (name, sizeof (name), sc_MPI_CHAR, 0, intranode);
+  SC_CHECK_MPI (mpiret);
+  if (intrarank) {
+    fd = shm_open (name, O_RDWR, 0600);
+    SC_CHECK_ABORTF (fd >= 0, "shm_open attach %s", name);
+  }
+  array = (char *) mmap (NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                         fd, 0);
+  SC_CHECK_ABORT (array != (char *) MAP_FAILED, "mmap");
+  SC_CHECK_ABORT (close (fd) == 0, "close");
+  if (!intrarank) {
+    *(size_t *) array = length;
+  }
+
+  /* the name is no longer needed once every process has mapped it */
+  mpiret = sc_MPI_Barrier (intranode);
+  SC_CHECK_MPI (mpiret);
+  if (!intrarank) {
+    SC_CHECK_ABORT (shm_unlink (name) == 0, "shm_unlink");
+  }
+
+  return array + SC_SHMEM_POSIX_HEADER;
+}
+
+static void
+sc_shmem_free_posix (int package, void *array, sc_MPI_Comm comm,
+                     sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  char               *base = (char *) array - SC_SHMEM_POSIX_HEADER;
+
+  SC_CHECK_ABORT (munmap (base, *(size_t *) base) == 0, "munmap");
+}
+
+static int
+sc_shmem_write_start_posix (void *array, sc_MPI_Comm comm,
+                            sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  int                 intrarank, mpiret;
+
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+
+  return !intrarank;
+}
+
+static void
+sc_shmem_write_end_posix (void *array, sc_MPI_Comm comm,
+                          sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  int                 mpiret;
+
+  /* the barrier orders the node root's writes before any later read */
+  mpiret = sc_MPI_Barrier (intranode);
+  SC_CHECK_MPI (mpiret);
+}
+
+/** Every process writes its block of \a count items directly into the
+ * shared \a recvchar at the position of its rank.  Then the node roots
+ * exchange whole node blocks in place and fence with a node barrier.
+ * Like the gather in sc_shmem_allgather_common this expects the ranks of
+ * a node to be contiguous in \a comm.
+ */
+static void
+sc_shmem_allgather_posix_inplace (void *sendbuf, int count,
+                                  sc_MPI_Datatype type, char *recvchar,
+                                  int *intrarank, sc_MPI_Comm comm,
+                                  sc_MPI_Comm intranode,
+                                  sc_MPI_Comm internode)
+{
+  size_t              bytes;
+  int                 mpiret, rank, intrasize;
+
+  bytes = count * sc_mpi_sizeof (type);
+  mpiret = sc_MPI_Comm_rank (comm, &rank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (intranode, intrarank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+  SC_CHECK_MPI (mpiret);
+#ifdef SC_ENABLE_DEBUG
+  {
+    int                 interrank;
+
+    mpiret = sc_MPI_Comm_rank (internode, &interrank);
+    SC_CHECK_MPI (mpiret);
+    SC_ASSERT (rank == interrank * intrasize + *intrarank);
+  }
+#endif
+
+  /* node peers may still read the previous contents of the array */
+  mpiret = sc_MPI_Barrier (intranode);
+  SC_CHECK_MPI (mpiret);
+  memcpy (recvchar + rank * bytes, sendbuf, bytes);
+  mpiret = sc_MPI_Barrier (intranode);
+  SC_CHECK_MPI (mpiret);
+
+  if (!*intrarank) {
+    mpiret = MPI_Allgather (MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, recvchar,
+                            count * intrasize, type, internode);
+    SC_CHECK_MPI (mpiret);
+  }
+}
+
+static void
+sc_shmem_allgather_posix (void *sendbuf, int sendcount,
+                          sc_MPI_Datatype sendtype, void *recvbuf,
+                          int recvcount, sc_MPI_Datatype recvtype,
+                          sc_MPI_Comm comm, sc_MPI_Comm intranode,
+                          sc_MPI_Comm internode)
+{
+  int                 intrarank;
+
+  SC_ASSERT (sendcount * sc_mpi_sizeof (sendtype) ==
+             recvcount * sc_mpi_sizeof (recvtype));
+  sc_shmem_allgather_posix_inplace (sendbuf, recvcount, recvtype,
+                                    (char *) recvbuf, &intrarank, comm,
+                                    intranode, internode);
+  sc_shmem_write_end_posix (recvbuf, comm, intranode, internode);
+}
+
+static void
+sc_shmem_prefix_posix (void *sendbuf, void *recvbuf, int count,
+                       sc_MPI_Datatype type, sc_MPI_Op op, int prescan,
+                       sc_MPI_Comm comm, sc_MPI_Comm intranode,
+                       sc_MPI_Comm internode)
+{
+  size_t              typesize;
+  int                 mpiret, intrarank, size;
+  char               *sendscan = NULL;
+
+  typesize = sc_mpi_sizeof (type);
+
+  if (prescan) {
+    sendscan = SC_ALLOC (char, typesize * count);
+    mpiret = sc_MPI_Scan (sendbuf, sendscan, count, type, op, comm);
+    SC_CHECK_MPI (mpiret);
+    sendbuf = sendscan;
+  }
+
+  /* slot zero stays reserved for the identity written by the root */
+  sc_shmem_allgather_posix_inplace (sendbuf, count, type,
+                                    (char *) recvbuf + count * typesize,
+                                    &intrarank, comm, intranode, internode);
+  if (!intrarank) {
+    memset (recvbuf, 0, count * typesize);
+    if (!prescan) {
+      mpiret = sc_MPI_Comm_size (comm, &size);
+      SC_CHECK_MPI (mpiret);
+      sc_scan_on_array (recvbuf, size, count, typesize, type, op);
+    }
+  }
+  sc_shmem_write_end_posix (recvbuf, comm, intranode, internode);
+  SC_FREE (sendscan);
+}
+#endif /* SC_ENABLE_SHMPOSIX */
+
 void               *
 sc_shmem_malloc (int package, size_t elem_size, size_t elem_count,
                  sc_MPI_Comm comm)
@@ -694,6 +900,12 @@ sc_shmem_malloc (int package, size_t elem_size, size_t elem_count,
   case SC_SHMEM_WINDOW_PRESCAN:
     return sc_shmem_malloc_window (package, elem_size, elem_count, comm,
                                    intranode, internode);
+#endif
+#if defined(SC_ENABLE_SHMPOSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
+    return sc_shmem_malloc_posix (package, elem_size, elem_count, comm,
+                                  intranode, internode);
 #endif
   default:
     SC_ABORT_NOT_REACHED ();
@@ -729,6 +941,12 @@ sc_shmem_free (int package, void *array, sc_MPI_Comm comm)
   case SC_SHMEM_WINDOW_PRESCAN:
     sc_shmem_free_window (package, array, comm, intranode, internode);
     break;
+#endif
+#if defined(SC_ENABLE_SHMPOSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
+    sc_shmem_free_posix (package, array, comm, intranode, internode);
+    break;
 #endif
   default:
     SC_ABORT_NOT_REACHED ();
@@ -760,6 +978,11 @@ sc_shmem_write_start (void *array, sc_MPI_Comm comm)
   case SC_SHMEM_WINDOW:
   case SC_SHMEM_WINDOW_PRESCAN:
     return sc_shmem_write_start_window (array, comm, intranode, internode);
+#endif
+#if defined(SC_ENABLE_SHMPOSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
+    return sc_shmem_write_start_posix (array, comm, intranode, internode);
 #endif
   default:
     SC_ABORT_NOT_REACHED ();
@@ -795,6 +1018,12 @@ sc_shmem_write_end (void *array, sc_MPI_Comm comm)
   case SC_SHMEM_WINDOW_PRESCAN:
     sc_shmem_write_end_window (array, comm, intranode, internode);
     break;
+#endif
+#if defined(SC_ENABLE_SHMPOSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
+    sc_shmem_write_end_posix (array, comm, intranode, internode);
+    break;
 #endif
   default:
     SC_ABORT_NOT_REACHED ();
@@ -820,7 +1049,8 @@ sc_shmem_memcpy (void *destarray, void *srcarray, size_t bytes,
     sc_shmem_memcpy_basic (destarray, srcarray, bytes, comm, intranode,
                            internode);
     break;
-#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED)
+#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED) || \
+  defined(SC_ENABLE_SHMPOSIX)
 #if defined(__bgq__)
   case SC_SHMEM_BGQ:
   case SC_SHMEM_BGQ_PRESCAN:
@@ -828,6 +1058,10 @@ sc_shmem_memcpy (void *destarray, void *srcarray, size_t bytes,
 #if defined(SC_ENABLE_MPIWINSHARED)
   case SC_SHMEM_WINDOW:
   case SC_SHMEM_WINDOW_PRESCAN:
+#endif
+#if defined(SC_ENABLE_SHMPOSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
 #endif
     sc_shmem_memcpy_common (destarray, srcarray, bytes, comm, intranode,
                             internode);
@@ -872,6 +1106,14 @@ sc_shmem_allgather (void *sendbuf, int sendcount,
                                recvcount, recvtype, comm, intranode,
                                internode);
     break;
+#endif
+#if defined(SC_ENABLE_SHMPOSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
+    sc_shmem_allgather_posix (sendbuf, sendcount, sendtype, recvbuf,
+                              recvcount, recvtype, comm, intranode,
+                              internode);
+    break;
 #endif
   default:
     SC_ABORT_NOT_REACHED ();
@@ -921,8 +1163,90 @@ sc_shmem_prefix (void *sendbuf, void *recvbuf, int count,
     sc_shmem_prefix_common_prescan (sendbuf, recvbuf, count, dtype, op,
                                     comm, intranode, internode);
     break;
+#endif
+#if defined(SC_ENABLE_SHMPOSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
+    sc_shmem_prefix_posix (sendbuf, recvbuf, count, dtype, op,
+                           type == SC_SHMEM_POSIX_PRESCAN, comm, intranode,
+                           internode);
+    break;
 #endif
   default:
     SC_ABORT_NOT_REACHED ();
   }
 }
+
+/** The element counts per process timed by sc_shmem_autotune. */
+#define SC_SHMEM_AUTOTUNE_NUM_COUNTS 3
+static const int    sc_shmem_autotune_counts[SC_SHMEM_AUTOTUNE_NUM_COUNTS] =
+  { 1, 16, 256 };
+
+/** Number of timed repetitions of each operation in sc_shmem_autotune. */
+#define SC_SHMEM_AUTOTUNE_REPEAT 4
+
+sc_shmem_type_t
+sc_shmem_autotune (sc_MPI_Comm comm)
+{
+  int                 mpiret, size;
+  int                 itype, icount, count, r;
+  double              elapsed, maxelapsed, best_elapsed = -1.;
+  long               *sendbuf, *recvbuf, *scanbuf;
+  sc_shmem_type_t     type, best_type = SC_SHMEM_BASIC;
+  sc_MPI_Comm         intranode = sc_MPI_COMM_NULL, internode =
+    sc_MPI_COMM_NULL;
+
+  /* without node communicators every type falls back to basic */
+  sc_mpi_comm_get_node_comms (comm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL) {
+    sc_shmem_set_type (comm, SC_SHMEM_BASIC);
+    return SC_SHMEM_BASIC;
+  }
+
+  mpiret = sc_MPI_Comm_size (comm, &size);
+  SC_CHECK_MPI (mpiret);
+  count = sc_shmem_autotune_counts[SC_SHMEM_AUTOTUNE_NUM_COUNTS - 1];
+  sendbuf = SC_ALLOC_ZERO (long, count);
+
+  for (itype = 0; itype < (int) SC_SHMEM_NUM_TYPES; ++itype) {
+    type = (sc_shmem_type_t) itype;
+    sc_shmem_set_type (comm, type);
+
+    /* allocation is not timed since arrays are usually long-lived */
+    elapsed = 0.;
+    for (icount = 0; icount < SC_SHMEM_AUTOTUNE_NUM_COUNTS; ++icount) {
+      count = sc_shmem_autotune_counts[icount];
+      recvbuf = SC_SHMEM_ALLOC (long, (size_t) count * size, comm);
+      scanbuf = SC_SHMEM_ALLOC (long, (size_t) count * (size + 1), comm);
+      mpiret = sc_MPI_Barrier (comm);
+      SC_CHECK_MPI (mpiret);
+      elapsed -= sc_MPI_Wtime ();
+      for (r = 0; r < SC_SHMEM_AUTOTUNE_REPEAT; ++r) {
+        sc_shmem_allgather (sendbuf, count, sc_MPI_LONG,
+                            recvbuf, count, sc_MPI_LONG, comm);
+        sc_shmem_prefix (sendbuf, scanbuf, count, sc_MPI_LONG, sc_MPI_SUM,
+                         comm);
+      }
+      elapsed += sc_MPI_Wtime ();
+      SC_SHMEM_FREE (scanbuf, comm);
+      SC_SHMEM_FREE (recvbuf, comm);
+    }
+
+    /* every process must arrive at the same choice */
+    mpiret = sc_MPI_Allreduce (&elapsed, &maxelapsed, 1, sc_MPI_DOUBLE,
+                               sc_MPI_MAX, comm);
+    SC_CHECK_MPI (mpiret);
+    SC_GLOBAL_LDEBUGF ("sc_shmem_autotune type %s took %g\n",
+                       sc_shmem_type_to_string[type], maxelapsed);
+    if (best_elapsed < 0. || maxelapsed < best_elapsed) {
+      best_elapsed = maxelapsed;
+      best_type = type;
+    }
+  }
+  SC_FREE (sendbuf);
+
+  sc_shmem_set_type (comm, best_type);
+  SC_GLOBAL_PRODUCTIONF ("sc_shmem_autotune chose type %s\n",
+                         sc_shmem_type_to_string[best_type]);
+  return best_type;
+}
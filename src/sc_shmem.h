@@ -42,6 +42,10 @@ typedef enum
   SC_SHMEM_WINDOW,         /**< MPI_Win (requires MPI 3) */
   SC_SHMEM_WINDOW_PRESCAN, /**< mpi_scan, then MPI_Win (requires MPI 3) */
 #endif
+#if defined(SC_ENABLE_SHMPOSIX)
+  SC_SHMEM_POSIX,          /**< shm_open and mmap, shared by a node */
+  SC_SHMEM_POSIX_PRESCAN,  /**< mpi_scan, then shm_open and mmap */
+#endif
 #if defined(__bgq__)
   SC_SHMEM_BGQ,            /**< raw pointer passing: only works for
                                 shared-heap environments */
@@ -76,6 +80,19 @@ void                sc_shmem_set_type (sc_MPI_Comm comm,
  */
 sc_shmem_type_t     sc_shmem_get_type (sc_MPI_Comm comm);
 
+/** Choose the fastest type of shared memory arrays for this communicator.
+ * Every available type is timed on sc_shmem_allgather and sc_shmem_prefix
+ * for a few array sizes.  The slowest process decides the time of a type.
+ * The fastest type is set on the communicator with sc_shmem_set_type and
+ * logged.  This function is collective and meant to be called once per
+ * communicator, since it allocates and frees several shmem arrays.
+ *
+ * \param[in,out] comm        the mpi communicator
+ *
+ * \return the type of shmem array chosen for this communicator.
+ */
+sc_shmem_type_t     sc_shmem_autotune (sc_MPI_Comm comm);
+
 /** Allocate a shmem array: an array that is redundant on every process.
  *
  * \param[in] package         package requesting memory
@@ -0,0 +1,222 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_soa.h>
+
+size_t
+sc_soa_memory_used (sc_soa_t * soa)
+{
+  int                 k;
+  size_t              mem = sizeof (sc_soa_t);
+
+  mem += soa->num_fields * (2 * sizeof (char *) + sizeof (size_t));
+  for (k = 0; k < soa->num_fields; ++k) {
+    mem += strlen (soa->names[k]) + 1;
+    mem += soa->elem_alloc * soa->field_sizes[k];
+  }
+  if (soa->block != NULL) {
+    mem += soa->num_fields * SC_SOA_ALIGN;
+  }
+
+  return mem;
+}
+
+sc_soa_t           *
+sc_soa_new (int num_fields, const char *const *names,
+            const size_t * field_sizes)
+{
+  int                 k;
+  sc_soa_t           *soa;
+
+  SC_ASSERT (num_fields >= 1);
+
+  soa = SC_ALLOC (sc_soa_t, 1);
+  soa->elem_count = 0;
+  soa->num_fields = 0;
+  soa->elem_alloc = 0;
+  soa->names = SC_ALLOC (char *, num_fields);
+  soa->field_sizes = SC_ALLOC (size_t, num_fields);
+  soa->columns = SC_ALLOC (char *, num_fields);
+  soa->block = NULL;
+  for (k = 0; k < num_fields; ++k) {
+    SC_ASSERT (field_sizes[k] > 0);
+    SC_ASSERT (sc_soa_field (soa, names[k]) == -1);
+    soa->names[k] = SC_STRDUP (names[k]);
+    soa->field_sizes[k] = field_sizes[k];
+    soa->columns[k] = NULL;
+    ++soa->num_fields;
+  }
+  SC_ASSERT (soa->num_fields == num_fields);
+
+  return soa;
+}
+
+void
+sc_soa_destroy (sc_soa_t * soa)
+{
+  int                 k;
+
+  for (k = 0; k < soa->num_fields; ++k) {
+    SC_FREE (soa->names[k]);
+  }
+  SC_FREE (soa->block);
+  SC_FREE (soa->columns);
+  SC_FREE (soa->field_sizes);
+  SC_FREE (soa->names);
+  SC_FREE (soa);
+}
+
+int
+sc_soa_field (sc_soa_t * soa, const char *name)
+{
+  int                 k;
+
+  for (k = 0; k < soa->num_fields; ++k) {
+    if (!strcmp (soa->names[k], name)) {
+      return k;
+    }
+  }
+  return -1;
+}
+
+void
+sc_soa_resize (sc_soa_t * soa, size_t new_count)
+{
+  int                 k;
+  size_t              new_alloc, bytes, min_count;
+  char               *block, *column;
+
+  if (new_count == 0) {
+    SC_FREE (soa->block);
+    soa->block = NULL;
+    for (k = 0; k < soa->num_fields; ++k) {
+      soa->columns[k] = NULL;
+    }
+    soa->elem_count = soa->elem_alloc = 0;
+    return;
+  }
+
+  /* grow and shrink the allocation by the same rule as sc_array */
+  new_alloc = (size_t) SC_ROUNDUP2_64 (new_count);
+  if (new_count <= soa->elem_alloc && new_alloc >= soa->elem_alloc) {
+    soa->elem_count = new_count;
+    return;
+  }
+
+  /* place the columns back to back, each starting aligned */
+  bytes = SC_SOA_ALIGN - 1;
+  for (k = 0; k < soa->num_fields; ++k) {
+    bytes += SC_ALIGN_UP (new_alloc * soa->field_sizes[k], SC_SOA_ALIGN);
+  }
+  block = SC_ALLOC (char, bytes);
+  column = (char *) SC_ALIGN_UP ((uintptr_t) block, SC_SOA_ALIGN);
+  min_count = SC_MIN (soa->elem_count, new_count);
+  for (k = 0; k < soa->num_fields; ++k) {
+    if (min_count > 0) {
+      memcpy (column, soa->columns[k], min_count * soa->field_sizes[k]);
+    }
+    soa->columns[k] = column;
+    column += SC_ALIGN_UP (new_alloc * soa->field_sizes[k], SC_SOA_ALIGN);
+  }
+  SC_ASSERT (column <= block + bytes);
+  SC_FREE (soa->block);
+  soa->block = block;
+  soa->elem_alloc = new_alloc;
+  soa->elem_count = new_count;
+}
+
+void
+sc_soa_column (sc_soa_t * soa, int field, sc_array_t * view)
+{
+  SC_ASSERT (0 <= field && field < soa->num_fields);
+
+  sc_array_init_data (view, soa->columns[field], soa->field_sizes[field],
+                      soa->elem_count);
+}
+
+void
+sc_soa_permute (sc_soa_t * soa, sc_array_t * newindices)
+{
+  int                 k;
+  sc_array_t          view;
+
+  SC_ASSERT (newindices->elem_count == soa->elem_count);
+
+  for (k = 0; k < soa->num_fields; ++k) {
+    sc_soa_column (soa, k, &view);
+    sc_array_permute (&view, newindices, 1);
+  }
+}
+
+void
+sc_soa_sort (sc_soa_t * soa, int field,
+             int (*compar) (const void *, const void *))
+{
+  const size_t        count = soa->elem_count;
+  const size_t        fs = soa->field_sizes[field];
+  size_t              rs, zz;
+  size_t             *newind;
+  char               *record;
+  sc_array_t          records, newindices;
+
+  SC_ASSERT (0 <= field && field < soa->num_fields);
+  if (count <= 1) {
+    return;
+  }
+
+  /* sort copies of the keys, each followed by its original index;
+     the key comes first so that compar can be applied to a record */
+  rs = SC_ALIGN_UP (fs, sizeof (size_t)) + sizeof (size_t);
+  sc_array_init_size (&records, rs, count);
+  for (zz = 0; zz < count; ++zz) {
+    record = (char *) sc_array_index (&records, zz);
+    memcpy (record, sc_soa_index (soa, field, zz), fs);
+    memcpy (record + rs - sizeof (size_t), &zz, sizeof (size_t));
+  }
+  sc_array_sort (&records, compar);
+
+  /* the record sorted to position zz tells where its element goes */
+  sc_array_init_size (&newindices, sizeof (size_t), count);
+  for (zz = 0; zz < count; ++zz) {
+    size_t              old;
+
+    record = (char *) sc_array_index (&records, zz);
+    memcpy (&old, record + rs - sizeof (size_t), sizeof (size_t));
+    newind = (size_t *) sc_array_index (&newindices, old);
+    *newind = zz;
+  }
+  sc_array_reset (&records);
+
+  sc_soa_permute (soa, &newindices);
+  sc_array_reset (&newindices);
+}
+
+void
+sc_soa_split (sc_soa_t * soa, int field, sc_array_t * offsets,
+              size_t num_types, sc_array_type_t type_fn, void *data)
+{
+  sc_array_t          view;
+
+  sc_soa_column (soa, field, &view);
+  sc_array_split (&view, offsets, num_types, type_fn, data);
+}
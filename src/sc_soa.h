@@ -0,0 +1,191 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#ifndef SC_SOA_H
+#define SC_SOA_H
+
+#include <sc_containers.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** \file sc_soa.h
+ * The sc_soa object stores elements of several named fields as a
+ * struct of arrays: every field is kept in a separate column, so a loop
+ * that reads one field streams only the memory of that column.
+ */
+
+/** Alignment in bytes of the start of each column. */
+#define SC_SOA_ALIGN 64
+
+/** The sc_soa object provides a dynamic array of multi-field elements.
+ * Elements are accessed by field and 0-based index.  All columns are
+ * resized together, and their addresses may change when they are.
+ */
+typedef struct sc_soa
+{
+  /* interface variables */
+  size_t              elem_count;       /**< number of valid elements */
+  int                 num_fields;       /**< number of columns */
+
+  /* implementation variables */
+  size_t              elem_alloc;       /**< number of allocated elements */
+  char              **names;    /**< name of each field */
+  size_t             *field_sizes;      /**< size of each field in bytes */
+  char              **columns;  /**< aligned start of each column */
+  char               *block;    /**< one allocation holding all columns */
+}
+sc_soa_t;
+
+/** Calculate the memory used by a struct of arrays.
+ * \param [in] soa         The struct of arrays.
+ * \return                 Memory used in bytes.
+ */
+size_t              sc_soa_memory_used (sc_soa_t * soa);
+
+/** Creates a new struct of arrays with 0 elements.
+ * \param [in] num_fields   Number of fields, at least 1.
+ * \param [in] names        Distinct name of each field; they are copied.
+ * \param [in] field_sizes  Size of each field in bytes, at least 1.
+ * \return                  Return an allocated struct of zero length.
+ */
+sc_soa_t           *sc_soa_new (int num_fields, const char *const *names,
+                                const size_t * field_sizes);
+
+/** Destroys a struct of arrays and all its memory.
+ * \param [in] soa          This struct of arrays is invalid afterwards.
+ */
+void                sc_soa_destroy (sc_soa_t * soa);
+
+/** Find a field by its name.
+ * \param [in] soa          The struct of arrays.
+ * \param [in] name         Name of the field.
+ * \return                  The index of the field, or -1 if not found.
+ */
+int                 sc_soa_field (sc_soa_t * soa, const char *name);
+
+/** Sets the element count of all columns to new_count.
+ * Reallocation takes place occasionally, as for \ref sc_array_resize.
+ * \param [in,out] soa      The element count and addresses are modified.
+ * \param [in] new_count    New element count.  If it is zero, all
+ *                          memory of the columns is freed.
+ */
+void                sc_soa_resize (sc_soa_t * soa, size_t new_count);
+
+/** Initialize an array view of one column.
+ * The view becomes invalid when the struct of arrays is resized.
+ * \param [in] soa          The struct of arrays.
+ * \param [in] field        Index of the field.
+ * \param [in,out] view     Array structure initialized as a view of the
+ *                          column with the field size as element size.
+ *                          It is not necessary to call sc_array_reset.
+ */
+void                sc_soa_column (sc_soa_t * soa, int field,
+                                   sc_array_t * view);
+
+/** Permute all columns in place.
+ * \param [in,out] soa      The data that on input is contained in element i
+ *                          is contained in element newindices[i] on output.
+ * \param [in] newindices   Permutation array (see sc_array_is_permutation).
+ *                          It is not changed.
+ */
+void                sc_soa_permute (sc_soa_t * soa, sc_array_t * newindices);
+
+/** Sort all columns in ascending order by the values of one field.
+ * Like sc_array_sort, the sort is not stable.
+ * \param [in,out] soa      The struct of arrays to sort.
+ * \param [in] field        Index of the field that holds the keys.
+ * \param [in] compar       The comparison function applied to pointers to
+ *                          two values of the field.
+ */
+void                sc_soa_sort (sc_soa_t * soa, int field,
+                                 int (*compar) (const void *,
+                                                const void *));
+
+/** Compute the offsets of groups of types in a struct of arrays.
+ * This calls \ref sc_array_split on a view of one column.
+ * \param [in] soa          Struct of arrays sorted in ascending order by
+ *                          type.
+ * \param [in] field        Index of the field passed to \a type_fn.
+ * \param [in,out] offsets  An initialized array of type size_t that is
+ *                          resized to \a num_types + 1 entries.
+ * \param [in] num_types    The number of possible types of elements.
+ * \param [in] type_fn      Returns the type of an element, called with the
+ *                          column view of \a field.
+ * \param [in] data         Arbitrary user data passed to \a type_fn.
+ */
+void                sc_soa_split (sc_soa_t * soa, int field,
+                                  sc_array_t * offsets, size_t num_types,
+                                  sc_array_type_t type_fn, void *data);
+
+/** Returns a pointer to a field of an element.
+ * \param [in] soa          The struct of arrays.
+ * \param [in] field        Index of the field.
+ * \param [in] iz           Index of the element, less than the count.
+ * \return                  Pointer into the column of the field.
+ */
+/*@unused@*/
+static inline void *
+sc_soa_index (sc_soa_t * soa, int field, size_t iz)
+{
+  SC_ASSERT (0 <= field && field < soa->num_fields);
+  SC_ASSERT (iz < soa->elem_count);
+
+  return (void *) (soa->columns[field] + soa->field_sizes[field] * iz);
+}
+
+/** Enlarge a struct of arrays by a number of elements.
+ * \param [in,out] soa      The element count is increased by add_count.
+ * \param [in] add_count    Number of elements to add.
+ * \return                  Index of the first new element.
+ */
+/*@unused@*/
+static inline       size_t
+sc_soa_push_count (sc_soa_t * soa, size_t add_count)
+{
+  const size_t        old_count = soa->elem_count;
+  const size_t        new_count = old_count + add_count;
+
+  if (new_count > soa->elem_alloc) {
+    sc_soa_resize (soa, new_count);
+  }
+  else {
+    soa->elem_count = new_count;
+  }
+
+  return old_count;
+}
+
+/** Enlarge a struct of arrays by one element.
+ * \param [in,out] soa      The element count is increased by one.
+ * \return                  Index of the new element.
+ */
+/*@unused@*/
+static inline       size_t
+sc_soa_push (sc_soa_t * soa)
+{
+  return sc_soa_push_count (soa, 1);
+}
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_SOA_H */
@@ -22,6 +22,7 @@
 */
 
 #include <sc_containers.h>
+#include <sc_notify.h>
 #include <sc_sort.h>
 
 typedef struct sc_psort_peer
@@ -449,3 +450,491 @@ sc_psort (sc_MPI_Comm mpicomm, void *base, size_t * nmemb, size_t size,
   sc_compare = NULL;
   SC_FREE (gmemb);
 }
+
+/** Number of regular samples each process contributes to splitter choice. */
+#define SC_PSORT_OVERSAMPLE 32
+
+/** Comparison state passed around explicitly to stay reentrant. */
+typedef struct sc_psort_cmp
+{
+  sc_psort_key_t      key_type;
+  size_t              key_offset, key_size;
+  int                 (*compar) (const void *, const void *);
+}
+sc_psort_cmp_t;
+
+/** Load an integer key of 1, 2, 4, or 8 bytes as order preserving uint64. */
+static inline       uint64_t
+sc_psort_key_load (const sc_psort_cmp_t * cmp, const char *p)
+{
+  uint64_t            u;
+
+  p += cmp->key_offset;
+  switch (cmp->key_size) {
+  case 1:
+    {
+      uint8_t             v;
+      memcpy (&v, p, 1);
+      u = v;
+      if (cmp->key_type == SC_PSORT_KEY_SIGNED) {
+        u ^= (uint64_t) 1 << 7;
+      }
+      return u;
+    }
+  case 2:
+    {
+      uint16_t            v;
+      memcpy (&v, p, 2);
+      u = v;
+      if (cmp->key_type == SC_PSORT_KEY_SIGNED) {
+        u ^= (uint64_t) 1 << 15;
+      }
+      return u;
+    }
+  case 4:
+    {
+      uint32_t            v;
+      memcpy (&v, p, 4);
+      u = v;
+      if (cmp->key_type == SC_PSORT_KEY_SIGNED) {
+        u ^= (uint64_t) 1 << 31;
+      }
+      return u;
+    }
+  default:
+    SC_ASSERT (cmp->key_size == 8);
+    memcpy (&u, p, 8);
+    if (cmp->key_type == SC_PSORT_KEY_SIGNED) {
+      u ^= (uint64_t) 1 << 63;
+    }
+    return u;
+  }
+}
+
+/** Compare two elements according to the comparison state. */
+static inline int
+sc_psort_cmp (const sc_psort_cmp_t * cmp, const void *v1, const void *v2)
+{
+  uint64_t            u1, u2;
+
+  switch (cmp->key_type) {
+  case SC_PSORT_KEY_UNSIGNED:
+  case SC_PSORT_KEY_SIGNED:
+    u1 = sc_psort_key_load (cmp, (const char *) v1);
+    u2 = sc_psort_key_load (cmp, (const char *) v2);
+    return u1 < u2 ? -1 : u1 > u2;
+  case SC_PSORT_KEY_BYTES:
+    return memcmp ((const char *) v1 + cmp->key_offset,
+                   (const char *) v2 + cmp->key_offset, cmp->key_size);
+  default:
+    SC_ASSERT (cmp->key_type == SC_PSORT_KEY_COMPAR);
+    return cmp->compar (v1, v2);
+  }
+}
+
+/** Compare two elements and break ties by their global indices. */
+static inline int
+sc_psort_cmp_index (const sc_psort_cmp_t * cmp, const void *v1, size_t i1,
+                    const void *v2, size_t i2)
+{
+  int                 c;
+
+  c = sc_psort_cmp (cmp, v1, v2);
+  return c != 0 ? c : i1 < i2 ? -1 : i1 > i2;
+}
+
+/** Merge two consecutive sorted runs stably into a destination. */
+static void
+sc_psort_merge (const sc_psort_cmp_t * cmp, char *dst, const char *src,
+                size_t lo, size_t mid, size_t hi, size_t size)
+{
+  size_t              i, j, k;
+
+  i = lo;
+  j = mid;
+  k = lo;
+  while (i < mid && j < hi) {
+    if (sc_psort_cmp (cmp, src + j * size, src + i * size) < 0) {
+      memcpy (dst + k++ * size, src + j++ * size, size);
+    }
+    else {
+      memcpy (dst + k++ * size, src + i++ * size, size);
+    }
+  }
+  memcpy (dst + k * size, src + i * size, (mid - i) * size);
+  k += mid - i;
+  memcpy (dst + k * size, src + j * size, (hi - j) * size);
+}
+
+/** Merge consecutive sorted runs in place by pairwise stable merging.
+ * \param [in,out] data     Runs stored back to back, sorted on output.
+ * \param [in,out] offsets  Array of num_runs + 1 run boundaries; clobbered.
+ */
+static void
+sc_psort_merge_runs (const sc_psort_cmp_t * cmp, char *data,
+                     size_t * offsets, int num_runs, size_t size)
+{
+  int                 r, w;
+  size_t              total;
+  char               *work, *src, *dst, *swap;
+
+  total = offsets[num_runs];
+  if (num_runs <= 1 || total == 0) {
+    return;
+  }
+  work = SC_ALLOC (char, total * size);
+  src = data;
+  dst = work;
+  while (num_runs > 1) {
+    for (r = 0, w = 0; r < num_runs; r += 2, ++w) {
+      offsets[w] = offsets[r];
+      if (r + 1 == num_runs) {
+        memcpy (dst + offsets[r] * size, src + offsets[r] * size,
+                (offsets[r + 1] - offsets[r]) * size);
+      }
+      else {
+        sc_psort_merge (cmp, dst, src, offsets[r], offsets[r + 1],
+                        offsets[r + 2], size);
+      }
+    }
+    offsets[w] = total;
+    num_runs = w;
+    swap = src;
+    src = dst;
+    dst = swap;
+  }
+  if (src != data) {
+    memcpy (data, src, total * size);
+  }
+  SC_FREE (work);
+}
+
+/** Sort local data, stably unless the plain comparison mode allows qsort. */
+static void
+sc_psort_local (const sc_psort_cmp_t * cmp, char *base, size_t nmemb,
+                size_t size, int stable)
+{
+  size_t              zz;
+  size_t             *runs;
+  sc_array_t          view;
+
+  if (nmemb <= 1) {
+    return;
+  }
+  switch (cmp->key_type) {
+  case SC_PSORT_KEY_UNSIGNED:
+  case SC_PSORT_KEY_SIGNED:
+    sc_array_init_data (&view, base, size, nmemb);
+    sc_array_sort_radix (&view, cmp->key_offset, cmp->key_size,
+                         cmp->key_type == SC_PSORT_KEY_SIGNED);
+    return;
+  case SC_PSORT_KEY_COMPAR:
+    if (!stable) {
+      qsort (base, nmemb, size, cmp->compar);
+      return;
+    }
+    /* fall through */
+  default:
+    /* bottom-up merge sort on runs of one element */
+    runs = SC_ALLOC (size_t, nmemb + 1);
+    for (zz = 0; zz <= nmemb; ++zz) {
+      runs[zz] = zz;
+    }
+    SC_ASSERT (nmemb <= (size_t) INT_MAX);
+    sc_psort_merge_runs (cmp, base, runs, (int) nmemb, size);
+    SC_FREE (runs);
+  }
+}
+
+/** Return the number of leading elements of a sorted run that are
+ * less or equal to a key, comparing global indices on equality.
+ * \param [in] first        Global index of the first element of the run.
+ */
+static              size_t
+sc_psort_upper_bound (const sc_psort_cmp_t * cmp, const char *base,
+                      size_t nmemb, size_t size, size_t first,
+                      const void *key, size_t key_index)
+{
+  size_t              lo, hi, mid;
+
+  lo = 0;
+  hi = nmemb;
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (sc_psort_cmp_index (cmp, base + mid * size, first + mid,
+                            key, key_index) <= 0) {
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/** Sample sort driver shared by the public sample sort functions.
+ * With a stable local sort, the result is globally stable: the splitters
+ * order ties by global index, and received runs are merged in rank order.
+ */
+static void
+sc_psort_sample (sc_MPI_Comm mpicomm, char *my_base, size_t * nmemb,
+                 size_t size, const sc_psort_cmp_t * cmp, int stable)
+{
+  int                 mpiret;
+  int                 num_procs, rank;
+  int                 i, q, r;
+  int                 num_samples, total_samples;
+  int                 num_receivers, num_senders, num_requests;
+  int                *receivers, *senders;
+  int                *scounts, *sdispls;
+  char               *samples, *gsamples, *splitters;
+  char               *bucket;
+  size_t              zz, lo, hi, rsize, sindex;
+  size_t              my_count, bucket_count, total;
+  size_t             *gmemb, *goffs, *boffs, *bcounts, *runs;
+  sc_MPI_Request     *requests;
+  sc_MPI_Status       status;
+
+  /* get basic MPI information */
+  mpiret = sc_MPI_Comm_size (mpicomm, &num_procs);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  /* alloc global offset array */
+  gmemb = SC_ALLOC (size_t, num_procs + 1);
+  gmemb[0] = 0;
+  for (i = 0; i < num_procs; ++i) {
+    gmemb[i + 1] = gmemb[i] + nmemb[i];
+  }
+  my_count = nmemb[rank];
+  total = gmemb[num_procs];
+  SC_GLOBAL_LDEBUGF ("Total values to samplesort %lld\n", (long long) total);
+
+  /* sort locally; this is all that is needed on a single process */
+  sc_psort_local (cmp, my_base, my_count, size, stable);
+  if (num_procs == 1 || total == 0) {
+    SC_FREE (gmemb);
+    return;
+  }
+
+  /* pick regularly spaced samples tagged with their global index */
+  rsize = size + sizeof (size_t);
+  num_samples = (int) SC_MIN (my_count, (size_t) SC_PSORT_OVERSAMPLE);
+  samples = SC_ALLOC (char, num_samples * rsize);
+  for (i = 0; i < num_samples; ++i) {
+    zz = ((2 * (size_t) i + 1) * my_count) / (2 * (size_t) num_samples);
+    memcpy (samples + i * rsize, my_base + zz * size, size);
+    zz += gmemb[rank];
+    memcpy (samples + i * rsize + size, &zz, sizeof (size_t));
+  }
+
+  /* gather all samples everywhere and choose num_procs - 1 splitters */
+  scounts = SC_ALLOC (int, num_procs);
+  sdispls = SC_ALLOC (int, num_procs + 1);
+  i = num_samples * (int) rsize;
+  mpiret = sc_MPI_Allgather (&i, 1, sc_MPI_INT, scounts, 1, sc_MPI_INT,
+                             mpicomm);
+  SC_CHECK_MPI (mpiret);
+  sdispls[0] = 0;
+  for (q = 0; q < num_procs; ++q) {
+    sdispls[q + 1] = sdispls[q] + scounts[q];
+  }
+  total_samples = sdispls[num_procs] / (int) rsize;
+  SC_ASSERT (total_samples > 0);
+  gsamples = SC_ALLOC (char, sdispls[num_procs]);
+  mpiret = sc_MPI_Allgatherv (samples, scounts[rank], sc_MPI_BYTE,
+                              gsamples, scounts, sdispls, sc_MPI_BYTE,
+                              mpicomm);
+  SC_CHECK_MPI (mpiret);
+  SC_FREE (samples);
+  SC_FREE (scounts);
+
+  /* the samples of each process are sorted by value and global index, and
+     a stable merge of these runs in rank order preserves this ordering */
+  runs = SC_ALLOC (size_t, num_procs + 1);
+  for (q = 0; q <= num_procs; ++q) {
+    runs[q] = (size_t) sdispls[q] / rsize;
+  }
+  sc_psort_merge_runs (cmp, gsamples, runs, num_procs, rsize);
+  SC_FREE (runs);
+  SC_FREE (sdispls);
+  splitters = SC_ALLOC (char, (num_procs - 1) * rsize);
+  for (q = 0; q < num_procs - 1; ++q) {
+    zz = ((size_t) (q + 1) * (size_t) total_samples) / (size_t) num_procs;
+    memcpy (splitters + q * rsize, gsamples + zz * rsize, rsize);
+  }
+  SC_FREE (gsamples);
+
+  /* bucket boundaries of the local data are found by binary search */
+  boffs = SC_ALLOC (size_t, num_procs + 1);
+  boffs[0] = 0;
+  for (q = 0; q < num_procs - 1; ++q) {
+    memcpy (&sindex, splitters + q * rsize + size, sizeof (size_t));
+    boffs[q + 1] = boffs[q] +
+      sc_psort_upper_bound (cmp, my_base + boffs[q] * size,
+                            my_count - boffs[q], size,
+                            gmemb[rank] + boffs[q],
+                            splitters + q * rsize, sindex);
+  }
+  boffs[num_procs] = my_count;
+  SC_FREE (splitters);
+
+  /* tell the owners of nonempty buckets that data is coming */
+  receivers = SC_ALLOC (int, num_procs);
+  senders = SC_ALLOC (int, num_procs);
+  num_receivers = 0;
+  for (q = 0; q < num_procs; ++q) {
+    if (q != rank && boffs[q + 1] > boffs[q]) {
+      receivers[num_receivers++] = q;
+    }
+  }
+  mpiret = sc_notify (receivers, num_receivers, senders, &num_senders,
+                      mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  /* send buckets to their owners */
+  requests = SC_ALLOC (sc_MPI_Request, num_receivers);
+  for (r = 0; r < num_receivers; ++r) {
+    q = receivers[r];
+    mpiret = sc_MPI_Isend (my_base + boffs[q] * size,
+                           (int) ((boffs[q + 1] - boffs[q]) * size),
+                           sc_MPI_BYTE, q, SC_TAG_PSORT_SAMPLE_BUCKET,
+                           mpicomm, requests + r);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* receive sorted runs ordered by source rank, own run included */
+  senders[num_senders++] = rank;
+  qsort (senders, (size_t) num_senders, sizeof (int), sc_int_compare);
+  runs = SC_ALLOC (size_t, num_senders + 1);
+  bucket_count = boffs[rank + 1] - boffs[rank];
+  bucket = SC_ALLOC (char, bucket_count * size);
+  runs[0] = 0;
+  for (r = 0; r < num_senders; ++r) {
+    if (senders[r] == rank) {
+      zz = boffs[rank + 1] - boffs[rank];
+      memcpy (bucket + runs[r] * size, my_base + boffs[rank] * size,
+              zz * size);
+      runs[r + 1] = runs[r] + zz;
+      continue;
+    }
+    mpiret = sc_MPI_Probe (senders[r], SC_TAG_PSORT_SAMPLE_BUCKET, mpicomm,
+                           &status);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Get_count (&status, sc_MPI_BYTE, &q);
+    SC_CHECK_MPI (mpiret);
+    SC_ASSERT (q % (int) size == 0);
+    zz = (size_t) q / size;
+    bucket_count += zz;
+    bucket = SC_REALLOC (bucket, char, bucket_count * size);
+    mpiret = sc_MPI_Recv (bucket + runs[r] * size, q, sc_MPI_BYTE,
+                          senders[r], SC_TAG_PSORT_SAMPLE_BUCKET, mpicomm,
+                          &status);
+    SC_CHECK_MPI (mpiret);
+    runs[r + 1] = runs[r] + zz;
+  }
+  SC_ASSERT (runs[num_senders] == bucket_count);
+  sc_psort_merge_runs (cmp, bucket, runs, num_senders, size);
+  SC_FREE (runs);
+  SC_FREE (senders);
+
+  /* the local input may only be overwritten once the buckets are out */
+  mpiret = sc_MPI_Waitall (num_receivers, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  SC_FREE (requests);
+  SC_FREE (receivers);
+  SC_FREE (boffs);
+
+  /* compute the global position of every bucket */
+  bcounts = SC_ALLOC (size_t, num_procs);
+  mpiret = sc_MPI_Allgather (&bucket_count, (int) sizeof (size_t),
+                             sc_MPI_BYTE, bcounts, (int) sizeof (size_t),
+                             sc_MPI_BYTE, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  goffs = SC_ALLOC (size_t, num_procs + 1);
+  goffs[0] = 0;
+  for (q = 0; q < num_procs; ++q) {
+    goffs[q + 1] = goffs[q] + bcounts[q];
+  }
+  SC_ASSERT (goffs[num_procs] == total);
+  SC_FREE (bcounts);
+
+  /* restore the original partition: receive the overlap of every bucket
+     with the local range and send the overlap of the own bucket with every
+     other range; both are computed without further communication */
+  requests = SC_ALLOC (sc_MPI_Request, 2 * num_procs);
+  num_requests = 0;
+  for (q = 0; q < num_procs; ++q) {
+    lo = SC_MAX (goffs[q], gmemb[rank]);
+    hi = SC_MIN (goffs[q + 1], gmemb[rank + 1]);
+    if (q == rank || lo >= hi) {
+      continue;
+    }
+    mpiret = sc_MPI_Irecv (my_base + (lo - gmemb[rank]) * size,
+                           (int) ((hi - lo) * size), sc_MPI_BYTE, q,
+                           SC_TAG_PSORT_SAMPLE_PARTITION, mpicomm,
+                           requests + num_requests++);
+    SC_CHECK_MPI (mpiret);
+  }
+  for (q = 0; q < num_procs; ++q) {
+    lo = SC_MAX (goffs[rank], gmemb[q]);
+    hi = SC_MIN (goffs[rank + 1], gmemb[q + 1]);
+    if (lo >= hi) {
+      continue;
+    }
+    if (q == rank) {
+      memcpy (my_base + (lo - gmemb[rank]) * size,
+              bucket + (lo - goffs[rank]) * size, (hi - lo) * size);
+      continue;
+    }
+    mpiret = sc_MPI_Isend (bucket + (lo - goffs[rank]) * size,
+                           (int) ((hi - lo) * size), sc_MPI_BYTE, q,
+                           SC_TAG_PSORT_SAMPLE_PARTITION, mpicomm,
+                           requests + num_requests++);
+    SC_CHECK_MPI (mpiret);
+  }
+  mpiret = sc_MPI_Waitall (num_requests, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+
+  /* clean up and free memory */
+  SC_FREE (requests);
+  SC_FREE (goffs);
+  SC_FREE (bucket);
+  SC_FREE (gmemb);
+}
+
+void
+sc_psort_samplesort (sc_MPI_Comm mpicomm, void *base, size_t * nmemb,
+                     size_t size, int (*compar) (const void *, const void *))
+{
+  sc_psort_cmp_t      cmp;
+
+  cmp.key_type = SC_PSORT_KEY_COMPAR;
+  cmp.key_offset = cmp.key_size = 0;
+  cmp.compar = compar;
+  sc_psort_sample (mpicomm, (char *) base, nmemb, size, &cmp, 0);
+}
+
+void
+sc_psort_ext (sc_MPI_Comm mpicomm, void *base, size_t * nmemb, size_t size,
+              int (*compar) (const void *, const void *),
+              sc_psort_key_t key_type, size_t key_offset, size_t key_size,
+              int stable)
+{
+  sc_psort_cmp_t      cmp;
+
+  SC_ASSERT (key_type != SC_PSORT_KEY_COMPAR || compar != NULL);
+  SC_ASSERT (key_type == SC_PSORT_KEY_COMPAR ||
+             key_offset + key_size <= size);
+  SC_ASSERT ((key_type != SC_PSORT_KEY_UNSIGNED &&
+              key_type != SC_PSORT_KEY_SIGNED) ||
+             key_size == 1 || key_size == 2 || key_size == 4 ||
+             key_size == 8);
+
+  cmp.key_type = key_type;
+  cmp.key_offset = key_offset;
+  cmp.key_size = key_size;
+  cmp.compar = compar;
+  sc_psort_sample (mpicomm, (char *) base, nmemb, size, &cmp, stable);
+}
@@ -28,6 +28,18 @@
 
 SC_EXTERN_C_BEGIN;
 
+/** How \ref sc_psort_ext orders the values. */
+typedef enum sc_psort_key
+{
+  SC_PSORT_KEY_COMPAR,          /**< Use the comparison function. */
+  SC_PSORT_KEY_UNSIGNED,        /**< Unsigned integer key of 1, 2, 4, or 8
+                                     bytes in native byte order. */
+  SC_PSORT_KEY_SIGNED,          /**< Signed integer key of 1, 2, 4, or 8
+                                     bytes in native byte order. */
+  SC_PSORT_KEY_BYTES            /**< Key of any size compared by memcmp. */
+}
+sc_psort_key_t;
+
 /** Sort a distributed set of values in parallel.
  * This algorithm uses bitonic sort between processors and qsort locally.
  * The partition of the data can be arbitrary and is not changed.
@@ -41,6 +53,50 @@ void                sc_psort (sc_MPI_Comm mpicomm, void *base,
                               size_t * nmemb, size_t size,
                               int (*compar) (const void *, const void *));
 
+/** Sort a distributed set of values in parallel by sample sort.
+ * Each process sorts locally, regular samples determine splitters,
+ * and one sparse all-to-all exchange moves every value to its bucket.
+ * The sorted buckets are then redistributed to the original partition.
+ * This needs O(log P) communication rounds instead of the O(log^2 P)
+ * rounds of \ref sc_psort and is preferable for large process counts.
+ * Unlike \ref sc_psort, this function keeps no static state and is thus
+ * reentrant; concurrent calls must use different communicators.
+ * \param [in] mpicomm          Communicator to use.
+ * \param [in,out] base         Pointer to the local subset of data.
+ * \param [in] nmemb            Array of mpisize counts of local data.
+ * \param [in] size             Size in bytes of each data value.
+ * \param [in] compar           Comparison function to use.
+ */
+void                sc_psort_samplesort (sc_MPI_Comm mpicomm, void *base,
+                                         size_t * nmemb, size_t size,
+                                         int (*compar) (const void *,
+                                                        const void *));
+
+/** Sort a distributed set of values by sample sort with a key extractor.
+ * Integer keys are sorted locally by radix sort and compared inline,
+ * byte keys by memcmp, so no function is called per comparison.
+ * If requested, the sort is stable across all processes: values with equal
+ * keys keep the order of their global indices in the input.
+ * The partition of the data is not changed.
+ * \param [in] mpicomm          Communicator to use.
+ * \param [in,out] base         Pointer to the local subset of data.
+ * \param [in] nmemb            Array of mpisize counts of local data.
+ * \param [in] size             Size in bytes of each data value.
+ * \param [in] compar           Comparison function for key type
+ *                              SC_PSORT_KEY_COMPAR, otherwise ignored.
+ * \param [in] key_type         Selects the comparison of the values.
+ * \param [in] key_offset       Byte offset of the key within each value.
+ * \param [in] key_size         Byte size of the key.
+ * \param [in] stable           If true, the sort is stable.
+ */
+void                sc_psort_ext (sc_MPI_Comm mpicomm, void *base,
+                                  size_t * nmemb, size_t size,
+                                  int (*compar) (const void *,
+                                                 const void *),
+                                  sc_psort_key_t key_type,
+                                  size_t key_offset, size_t key_size,
+                                  int stable);
+
 SC_EXTERN_C_END;
 
 #endif /* SC_SORT_H */
@@ -26,11 +26,13 @@
 int
 main (int argc, char **argv)
 {
-  sc_MPI_Comm         mpicomm;
+  sc_MPI_Comm         mpicomm, nodecomm;
+  sc_allgather_request_t *request;
   int                 mpiret;
   int                 mpisize;
   int                 mpirank;
   int                 i;
+  int                 flag;
   int                *idata;
   double              elapsed_alltoall = 0.;
   double              elapsed_recursive;
@@ -39,6 +41,7 @@ main (int argc, char **argv)
   double             *ddata2;
   double              elapsed_allgather;
   double              elapsed_replacement;
+  double              elapsed_node;
 
   mpiret = sc_MPI_Init (&argc, &argv);
   SC_CHECK_MPI (mpiret);
@@ -87,7 +90,7 @@ main (int argc, char **argv)
 
   SC_GLOBAL_INFO ("Testing allgather and replacement\n");
 
-  dsend = M_PI;
+  dsend = M_PI * (mpirank + 1);
 
   mpiret = sc_MPI_Barrier (mpicomm);
   SC_CHECK_MPI (mpiret);
@@ -114,6 +117,55 @@ main (int argc, char **argv)
   }
   SC_ASSERT (ddata1[mpirank] == dsend); /* exact match wanted */
 
+  SC_GLOBAL_INFO ("Testing node aware allgather\n");
+
+  /* emulate nodes of two processes each where the size permits */
+  mpiret = sc_MPI_Comm_dup (mpicomm, &nodecomm);
+  SC_CHECK_MPI (mpiret);
+  sc_mpi_comm_attach_node_comms (nodecomm, mpisize % 2 ? 1 : 2);
+#ifdef SC_ENABLE_MPI
+  SC_CHECK_ABORT (sc_mpi_comm_node_comms_contiguous (nodecomm),
+                  "Node comms contiguous");
+#endif
+  sc_allgather_default_mode = SC_ALLGATHER_NODE;
+  SC_GLOBAL_INFOF ("Allgather algorithm %s\n",
+                   sc_allgather_mode_to_string[sc_allgather_get_mode
+                                               (nodecomm)]);
+  for (i = 0; i < mpisize; ++i) {
+    ddata2[i] = -1.;
+  }
+  mpiret = sc_MPI_Barrier (mpicomm);
+  SC_CHECK_MPI (mpiret);
+  elapsed_node = -sc_MPI_Wtime ();
+  mpiret = sc_allgather (&dsend, 1, sc_MPI_DOUBLE, ddata2, 1, sc_MPI_DOUBLE,
+                         nodecomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Barrier (mpicomm);
+  SC_CHECK_MPI (mpiret);
+  elapsed_node += sc_MPI_Wtime ();
+  for (i = 0; i < mpisize; ++i) {
+    SC_CHECK_ABORT (ddata1[i] == ddata2[i], "Node allgather mismatch");
+  }
+  sc_allgather_default_mode = SC_ALLGATHER_AUTO;
+  sc_mpi_comm_detach_node_comms (nodecomm);
+  mpiret = sc_MPI_Comm_free (&nodecomm);
+  SC_CHECK_MPI (mpiret);
+
+  SC_GLOBAL_INFO ("Testing nonblocking allgather\n");
+
+  for (i = 0; i < mpisize; ++i) {
+    ddata2[i] = -1.;
+  }
+  sc_iallgather (&dsend, 1, sc_MPI_DOUBLE, ddata2, 1, sc_MPI_DOUBLE,
+                 mpicomm, &request);
+  for (flag = 0; !flag;) {
+    sc_iallgather_test (&request, &flag);
+  }
+  SC_CHECK_ABORT (request == NULL, "Request not freed");
+  for (i = 0; i < mpisize; ++i) {
+    SC_CHECK_ABORT (ddata1[i] == ddata2[i], "Iallgather mismatch");
+  }
+
   SC_FREE (ddata1);
   SC_FREE (ddata2);
 
@@ -123,6 +175,7 @@ main (int argc, char **argv)
   SC_GLOBAL_STATISTICSF ("   recursive %g\n", elapsed_recursive);
   SC_GLOBAL_STATISTICSF ("   allgather %g\n", elapsed_allgather);
   SC_GLOBAL_STATISTICSF ("   replacement %g\n", elapsed_replacement);
+  SC_GLOBAL_STATISTICSF ("   node %g\n", elapsed_node);
 
   sc_finalize ();
 
@@ -103,6 +103,464 @@ test_new_data (sc_array_t * a)
   sc_array_destroy (v);
 }
 
+static void
+test_sort_radix (int N)
+{
+  int                 i, cmp;
+  int32_t            *i32;
+  int64_t             key;
+  size_t             *pos;
+  sc_array_t         *a, *b, *c, *payload;
+
+  /* whole-element 32-bit keys must match the comparison sort */
+  a = sc_array_new_count (sizeof (int32_t), (size_t) N);
+  for (i = 0; i < N; ++i) {
+    i32 = (int32_t *) sc_array_index_int (a, i);
+    *i32 = (int32_t) (rand () - RAND_MAX / 2) * ((i % 3 == 0) ? 1 : 1117);
+  }
+  b = sc_array_new (sizeof (int32_t));
+  sc_array_copy (b, a);
+  sc_array_sort (a, sc_int32_compare);
+  sc_array_sort_radix (b, 0, sizeof (int32_t), 1);
+  SC_CHECK_ABORT (sc_array_is_equal (a, b), "Radix sort int32");
+  sc_array_destroy (a);
+  sc_array_destroy (b);
+
+  /* 64-bit keys inside a larger element, with payload */
+  a = sc_array_new_count (2 * sizeof (int64_t), (size_t) N);
+  payload = sc_array_new_count (sizeof (size_t), (size_t) N);
+  for (i = 0; i < N; ++i) {
+    key = ((int64_t) (rand () % 64) - 32) * ((int64_t) 1 << 40) + rand () % 5;
+    memcpy ((char *) sc_array_index_int (a, i) + sizeof (int64_t), &key,
+            sizeof (int64_t));
+    memcpy (sc_array_index_int (a, i), &i, sizeof (int));
+    *(size_t *) sc_array_index_int (payload, i) = (size_t) i;
+  }
+  c = sc_array_new (a->elem_size);
+  sc_array_copy (c, a);
+  sc_array_sort_radix_payload (a, sizeof (int64_t), sizeof (int64_t), 1,
+                               payload);
+  for (i = 0; i < N; ++i) {
+    pos = (size_t *) sc_array_index_int (payload, i);
+    SC_CHECK_ABORT (!memcmp (sc_array_index_int (a, i),
+                             sc_array_index (c, *pos), a->elem_size),
+                    "Radix sort payload");
+    if (i > 0) {
+      cmp = sc_int64_compare ((char *) sc_array_index_int (a, i - 1) +
+                              sizeof (int64_t),
+                              (char *) sc_array_index_int (a, i) +
+                              sizeof (int64_t));
+      SC_CHECK_ABORT (cmp < 0 || (cmp == 0 && pos[-1] < *pos),
+                      "Radix sort stable order");
+    }
+  }
+  sc_array_destroy (a);
+  sc_array_destroy (c);
+  sc_array_destroy (payload);
+}
+
+static              size_t
+test_type_mod5 (sc_array_t * array, size_t index, void *data)
+{
+  return (size_t) *(int *) sc_array_index (array, index) % 5;
+}
+
+static void
+test_threaded_split (sc_array_t * a, int T)
+{
+  size_t              zz, zt;
+  size_t             *zp, *zq;
+  sc_array_t         *b, *offsets, *check, *perm, *scratch;
+
+  /* grouping an unsorted array by type keeps the order within a type */
+  b = sc_array_new (sizeof (int));
+  sc_array_copy (b, a);
+  offsets = sc_array_new (sizeof (size_t));
+  check = sc_array_new (sizeof (size_t));
+  sc_array_split_threaded (b, offsets, 5, test_type_mod5, NULL, T);
+  zp = (size_t *) offsets->array;
+  SC_CHECK_ABORT (zp[0] == 0 && zp[5] == a->elem_count, "Threaded split");
+  for (zt = 0; zt < 5; ++zt) {
+    for (zz = zp[zt]; zz < zp[zt + 1]; ++zz) {
+      SC_CHECK_ABORT (test_type_mod5 (b, zz, NULL) == zt,
+                      "Threaded split type");
+    }
+  }
+  sc_array_split (b, check, 5, test_type_mod5, NULL);
+  SC_CHECK_ABORT (sc_array_is_equal (offsets, check), "Threaded split sorted");
+  sc_array_split_threaded (b, offsets, 5, test_type_mod5, NULL, T);
+  SC_CHECK_ABORT (sc_array_is_equal (offsets, check), "Threaded split again");
+
+  /* the permutation sends element zz to the reversed position */
+  perm = sc_array_new_count (sizeof (size_t), a->elem_count);
+  for (zz = 0; zz < a->elem_count; ++zz) {
+    zq = (size_t *) sc_array_index (perm, zz);
+    *zq = a->elem_count - 1 - zz;
+  }
+  sc_array_copy (b, a);
+  scratch = sc_array_new (sizeof (int));
+  sc_array_permute_threaded (b, perm, scratch, T);
+  sc_array_permute (b, perm, 1);
+  SC_CHECK_ABORT (sc_array_is_equal (a, b), "Threaded permute");
+  sc_array_permute_threaded (b, perm, NULL, T);
+  sc_array_permute (b, perm, 0);
+  SC_CHECK_ABORT (sc_array_is_equal (a, b), "Threaded permute NULL");
+
+  sc_array_destroy (scratch);
+  sc_array_destroy (perm);
+  sc_array_destroy (check);
+  sc_array_destroy (offsets);
+  sc_array_destroy (b);
+}
+
+static void
+test_threaded (int N)
+{
+  int                 i, T;
+  int                *pe;
+  sc_array_t         *a, *b;
+
+  for (T = 1; T <= 7; T += 2) {
+    a = sc_array_new_count (sizeof (int), (size_t) N);
+    for (i = 0; i < N; ++i) {
+      pe = (int *) sc_array_index_int (a, i);
+      *pe = rand () % (N / 3 + 1);      /* creates duplicates */
+    }
+    test_threaded_split (a, T);
+    b = sc_array_new (sizeof (int));
+    sc_array_copy (b, a);
+
+    sc_array_sort (a, sc_int_compare);
+    SC_CHECK_ABORT (sc_array_is_sorted_threaded (b, sc_int_compare, T) ==
+                    sc_array_is_sorted (b, sc_int_compare),
+                    "Threaded is_sorted");
+    sc_array_sort_threaded (b, sc_int_compare, T);
+    SC_CHECK_ABORT (sc_array_is_equal (a, b), "Threaded sort");
+    SC_CHECK_ABORT (sc_array_is_sorted_threaded (b, sc_int_compare, T),
+                    "Threaded is_sorted");
+
+    sc_array_uniq (a, sc_int_compare);
+    sc_array_uniq_threaded (b, sc_int_compare, T);
+    SC_CHECK_ABORT (sc_array_is_equal (a, b), "Threaded uniq");
+
+    /* an unsorted pair at a chunk boundary must be found */
+    if (b->elem_count > 2) {
+      pe = (int *) sc_array_index (b, b->elem_count / 2);
+      *pe = -1;
+      SC_CHECK_ABORT (!sc_array_is_sorted_threaded (b, sc_int_compare, T),
+                      "Threaded is_sorted unsorted");
+    }
+
+    sc_array_destroy (a);
+    sc_array_destroy (b);
+  }
+}
+
+static void
+test_arena (int N)
+{
+  int                 i;
+  int                *pe;
+  size_t              zz;
+  void               *mark, *p;
+  sc_arena_t         *arena;
+  sc_array_t         *a;
+  sc_list_t          *list;
+  sc_link_t          *lynk;
+
+  arena = sc_arena_new ();
+  for (zz = 1; zz <= 64; zz *= 2) {
+    p = sc_arena_alloc_aligned (arena, 3, zz);
+    SC_CHECK_ABORT ((size_t) p % zz == 0, "Arena alignment");
+  }
+
+  mark = sc_arena_mark (arena);
+  a = sc_array_new_arena (sizeof (int), 0, arena);
+  list = sc_list_new_arena (arena);
+  for (i = 0; i < N; ++i) {
+    *(int *) sc_array_push (a) = i;
+    pe = (int *) sc_arena_alloc (arena, sizeof (int));
+    *pe = i;
+    sc_list_append (list, pe);
+  }
+  SC_CHECK_ABORT (a->elem_count == (size_t) N, "Arena array count");
+  for (i = 0; i < N; ++i) {
+    pe = (int *) sc_array_index_int (a, i);
+    SC_CHECK_ABORT (*pe == i, "Arena array value");
+  }
+  sc_array_resize (a, (size_t) (N / 2));
+  SC_CHECK_ABORT (*(int *) sc_array_index_int (a, N / 2 - 1) == N / 2 - 1,
+                  "Arena array shrink");
+  SC_CHECK_ABORT (list->elem_count == (size_t) N, "Arena list count");
+  sc_list_pop (list);
+  for (i = 0, lynk = list->first; lynk != NULL; ++i, lynk = lynk->next) {
+    SC_CHECK_ABORT (*(int *) lynk->data == i + 1, "Arena list value");
+  }
+  SC_CHECK_ABORT (i == N - 1, "Arena list length");
+  SC_CHECK_ABORT (sc_array_memory_used (a, 1) == 0, "Arena array memory");
+  sc_array_destroy (a);
+  sc_list_destroy (list);
+  SC_CHECK_ABORT (sc_arena_memory_used (arena) > 0, "Arena memory");
+
+  /* everything allocated after the mark is released at once */
+  sc_arena_rewind (arena, mark);
+  SC_CHECK_ABORT (sc_arena_mark (arena) == mark, "Arena rewind");
+  sc_arena_rewind (arena, NULL);
+  sc_arena_destroy (arena);
+}
+
+static int
+test_is_odd (const void *elem, void *user)
+{
+  ++*(int *) user;
+  return *(const int *) elem % 2;
+}
+
+static void
+test_ranges (int N)
+{
+  int                 i, calls;
+  int                *pe;
+  int                 data[3] = { -1, -2, -3 };
+  sc_array_t         *a, *b;
+
+  a = sc_array_new (sizeof (int));
+  b = sc_array_new_count (sizeof (int), (size_t) N);
+  for (i = 0; i < N; ++i) {
+    *(int *) sc_array_index_int (b, i) = i;
+  }
+
+  /* append from another array and from the array itself */
+  sc_array_append (a, b);
+  pe = (int *) sc_array_append_data (a, a->array, (size_t) N);
+  SC_CHECK_ABORT (a->elem_count == (size_t) (2 * N) && pe[N - 1] == N - 1,
+                  "Append");
+  sc_array_erase_range (a, (size_t) N, (size_t) N);
+  SC_CHECK_ABORT (sc_array_is_equal (a, b), "Erase range");
+
+  pe = (int *) sc_array_insert_range (a, 1, 3, data);
+  SC_CHECK_ABORT (pe[0] == -1 && pe[2] == -3 && pe[3] == 1, "Insert range");
+  sc_array_insert_range (a, a->elem_count, 3, data);
+  SC_CHECK_ABORT (*(int *) sc_array_index_int (a, N + 5) == -3,
+                  "Insert range end");
+  sc_array_erase_range (a, a->elem_count - 3, 3);
+  sc_array_erase_range (a, 1, 3);
+  SC_CHECK_ABORT (sc_array_is_equal (a, b), "Erase range insert");
+
+  calls = 0;
+  SC_CHECK_ABORT (sc_array_erase_if (a, test_is_odd, &calls) ==
+                  (size_t) (N / 2), "Erase if count");
+  SC_CHECK_ABORT (calls == N, "Erase if calls");
+  for (i = 0; i < (N + 1) / 2; ++i) {
+    SC_CHECK_ABORT (*(int *) sc_array_index_int (a, i) == 2 * i,
+                    "Erase if order");
+  }
+
+  sc_array_destroy (a);
+  sc_array_destroy (b);
+}
+
+static void
+test_growth (int N)
+{
+  int                 i, k;
+  char               *base;
+  ssize_t             byte_alloc;
+  sc_array_t         *a;
+  sc_array_growth_t   growth;
+
+  a = sc_array_new (sizeof (int));
+  sc_array_reserve (a, (size_t) N);
+  SC_CHECK_ABORT (a->elem_count == 0 &&
+                  a->byte_alloc == (ssize_t) (N * sizeof (int)),
+                  "Reserve");
+  base = a->array;
+  for (i = 0; i < N; ++i) {
+    *(int *) sc_array_push (a) = i;
+  }
+  SC_CHECK_ABORT (a->array == base, "Reserve push");
+
+  /* a push and pop queue keeps its memory without shrinking */
+  growth.type = SC_ARRAY_GROWTH_GEOMETRIC;
+  growth.factor = 1.5;
+  growth.chunk = 0;
+  growth.shrink = 0;
+  sc_array_set_growth (a, &growth);
+  for (k = 0; k < 3; ++k) {
+    sc_array_resize (a, 0);
+    SC_CHECK_ABORT (a->array == base, "Growth keep");
+    sc_array_resize (a, (size_t) N);
+  }
+  for (i = 0; i < N; ++i) {
+    *(int *) sc_array_index_int (a, i) = i;
+  }
+  *(int *) sc_array_push (a) = N;
+  SC_CHECK_ABORT (a->byte_alloc >= (ssize_t) (3 * N / 2 * sizeof (int)),
+                  "Growth geometric");
+  for (i = 0; i <= N; ++i) {
+    SC_CHECK_ABORT (*(int *) sc_array_index_int (a, i) == i,
+                    "Growth value");
+  }
+
+  /* shrink only below a quarter of the allocation */
+  growth.type = SC_ARRAY_GROWTH_CHUNK;
+  growth.chunk = 10;
+  growth.shrink = 4;
+  sc_array_shrink_to_fit (a);
+  SC_CHECK_ABORT (a->byte_alloc == (ssize_t) ((N + 1) * sizeof (int)),
+                  "Shrink to fit");
+  byte_alloc = a->byte_alloc;
+  sc_array_resize (a, (size_t) (N / 3));
+  SC_CHECK_ABORT (a->byte_alloc == byte_alloc, "Growth hysteresis");
+  sc_array_resize (a, (size_t) (N / 5));
+  SC_CHECK_ABORT (a->byte_alloc < byte_alloc &&
+                  a->byte_alloc % (10 * sizeof (int)) == 0,
+                  "Growth chunk");
+  for (i = 0; i < N / 5; ++i) {
+    SC_CHECK_ABORT (*(int *) sc_array_index_int (a, i) == i,
+                    "Growth shrink value");
+  }
+  sc_array_resize (a, 0);
+  SC_CHECK_ABORT (a->byte_alloc == 0 && a->array == NULL, "Growth zero");
+
+  sc_array_set_growth (a, NULL);
+  sc_array_destroy (a);
+
+  /* rewinding keeps the allocation, which may grow in place again */
+  growth.type = SC_ARRAY_GROWTH_POW2;
+  growth.shrink = 0;
+  a = sc_array_new (sizeof (int));
+  sc_array_set_growth (a, &growth);
+  for (i = 0; i < 10; ++i) {
+    *(int *) sc_array_push (a) = i;
+  }
+  base = a->array;
+  sc_array_rewind (a, 0);
+  sc_array_resize (a, 5);
+  sc_array_rewind (a, 3);
+  sc_array_resize (a, 8);
+  SC_CHECK_ABORT (a->array == base, "Growth rewind");
+  sc_array_destroy (a);
+}
+
+static void
+test_memory_policy (int N)
+{
+  int                 i;
+  int                *pe;
+  sc_array_t         *a;
+  sc_memory_policy_t  policy, saved;
+
+  sc_memory_policy_get (sc_package_id, &saved);
+  policy.flags = SC_MEMORY_POLICY_HUGEPAGE | SC_MEMORY_POLICY_INTERLEAVE;
+  policy.threshold = 1 << 12;
+  sc_memory_policy_set (sc_package_id, &policy);
+
+  /* growing the array moves it from malloc into a mapping */
+  a = sc_array_new (sizeof (int));
+  for (i = 0; i < N; ++i) {
+    *(int *) sc_array_push (a) = i;
+  }
+  sc_array_resize (a, (size_t) (2 * N));
+  for (i = 0; i < N; ++i) {
+    pe = (int *) sc_array_index_int (a, i);
+    SC_CHECK_ABORT (*pe == i, "Policy array value");
+  }
+  sc_array_resize (a, 3);
+  SC_CHECK_ABORT (*(int *) sc_array_index_int (a, 2) == 2,
+                  "Policy array shrink");
+  sc_array_destroy (a);
+
+  pe = SC_ALLOC_ZERO (int, N);
+  for (i = 0; i < N; ++i) {
+    SC_CHECK_ABORT (pe[i] == 0, "Policy calloc");
+  }
+  SC_FREE (pe);
+
+  /* a single allocation may use its own policy */
+  sc_memory_policy_set (sc_package_id, NULL);
+  policy.flags = SC_MEMORY_POLICY_FIRST_TOUCH;
+  pe = SC_ALLOC_POLICY (int, N, &policy);
+  pe[N - 1] = N;
+  pe = SC_REALLOC (pe, int, 2 * N);
+  SC_CHECK_ABORT (pe[N - 1] == N, "Policy realloc");
+  SC_FREE (pe);
+
+  sc_memory_policy_set (sc_package_id, &saved);
+}
+
+static void
+test_pqueue (int N)
+{
+  int                 i, v, last;
+  size_t              zz, *handles;
+  int                *values;
+  sc_pqueue_t        *pq;
+
+  values = SC_ALLOC (int, N);
+  handles = SC_ALLOC (size_t, N);
+  for (i = 0; i < N; ++i) {
+    values[i] = (int) ((i * 7919L) % N);
+  }
+
+  /* half of the elements one by one, the rest in a batch */
+  pq = sc_pqueue_new (sizeof (int), 4, sc_int_compare, 1);
+  SC_CHECK_ABORT (sc_pqueue_top (pq) == NULL, "Pqueue empty top");
+  for (i = 0; i < N / 2; ++i) {
+    handles[i] = sc_pqueue_push (pq, &values[i]);
+  }
+  sc_pqueue_push_batch (pq, values + N / 2, (size_t) (N - N / 2),
+                        handles + N / 2);
+  SC_CHECK_ABORT (pq->heap.elem_count == (size_t) N, "Pqueue count");
+  for (i = 0; i < N; ++i) {
+    SC_CHECK_ABORT (*(int *) sc_pqueue_lookup (pq, handles[i]) == values[i],
+                    "Pqueue lookup");
+  }
+
+  /* decrease one key below all others, remove another element */
+  v = -1;
+  sc_pqueue_update (pq, handles[N - 1], &v);
+  SC_CHECK_ABORT (*(int *) sc_pqueue_top (pq) == -1, "Pqueue decrease");
+  v = 2 * N;
+  sc_pqueue_update (pq, handles[N - 1], &v);
+  sc_pqueue_remove (pq, handles[0], &v);
+  SC_CHECK_ABORT (v == values[0], "Pqueue remove value");
+  SC_CHECK_ABORT (sc_pqueue_lookup (pq, handles[0]) == NULL,
+                  "Pqueue removed lookup");
+  SC_CHECK_ABORT (sc_pqueue_memory_used (pq) > 0, "Pqueue memory");
+
+  /* everything else comes out in order, the increased key last */
+  last = -1;
+  zz = 0;
+  while (sc_pqueue_pop (pq, &v)) {
+    SC_CHECK_ABORT (last <= v, "Pqueue order");
+    last = v;
+    ++zz;
+  }
+  SC_CHECK_ABORT (zz == (size_t) (N - 1) && last == 2 * N, "Pqueue pop");
+  for (i = 0; i < N; ++i) {
+    SC_CHECK_ABORT (sc_pqueue_lookup (pq, handles[i]) == NULL,
+                    "Pqueue handles released");
+  }
+
+  /* handles are reused after their elements left the queue */
+  zz = sc_pqueue_push (pq, &values[1]);
+  SC_CHECK_ABORT (zz < (size_t) N, "Pqueue handle reuse");
+  sc_pqueue_destroy (pq);
+
+  /* a queue without index built by a single batch */
+  pq = sc_pqueue_new (sizeof (int), 2, sc_int_compare, 0);
+  sc_pqueue_push_batch (pq, values, (size_t) N, NULL);
+  for (i = 0; i < N; ++i) {
+    SC_CHECK_ABORT (sc_pqueue_pop (pq, &v) && v == i, "Pqueue batch order");
+  }
+  SC_CHECK_ABORT (!sc_pqueue_pop (pq, NULL), "Pqueue batch empty");
+  sc_pqueue_destroy (pq);
+
+  SC_FREE (values);
+  SC_FREE (handles);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -145,6 +603,13 @@ main (int argc, char **argv)
   test_new_count (a);
   test_new_view (a);
   test_new_data (a);
+  test_sort_radix (1000);
+  test_threaded (1000);
+  test_arena (1000);
+  test_memory_policy (100000);
+  test_growth (1000);
+  test_ranges (1000);
+  test_pqueue (1000);
 
   for (i = 0; i < N; ++i) {
     pe = (int *) sc_array_index_int (a, i);
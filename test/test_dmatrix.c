@@ -194,6 +194,46 @@ test_dotmultiply_add ()
   return (int) n_err_entries;
 }
 
+/**
+ * Tests matrices allocated in an arena against regular ones.
+ *
+ * \return  number of entries with errors.
+ */
+static int
+test_arena ()
+{
+  const sc_bint_t     m = 7, n = 5;
+  sc_bint_t           i, j;
+  int                 num_errors = 0;
+  sc_arena_t         *arena;
+  sc_dmatrix_t       *mat, *mat_chk;
+
+  arena = sc_arena_new ();
+  mat = sc_dmatrix_new_arena (m, n, arena);
+  mat_chk = sc_dmatrix_new (m, n);
+  test_dmatrix_set_random (mat_chk, -1.0, 1.0);
+  sc_dmatrix_copy (mat_chk, mat);
+
+  /* resizing copies the entries into new arena memory */
+  sc_dmatrix_resize_in_place (mat, m + 2, n + 1);
+  sc_dmatrix_resize_in_place (mat_chk, m + 2, n + 1);
+  for (i = 0; i < m; ++i) {
+    for (j = 0; j < n; ++j) {
+      if (mat->e[i][j] != mat_chk->e[i][j]) {
+        ++num_errors;
+      }
+    }
+  }
+  sc_dmatrix_resize (mat, m, n);
+  sc_dmatrix_reshape (mat, n, m);
+
+  sc_dmatrix_destroy (mat);
+  sc_dmatrix_destroy (mat_chk);
+  sc_arena_destroy (arena);
+
+  return num_errors;
+}
+
 /**
  * Runs all dmatrix tests.
  */
@@ -334,6 +374,13 @@ main (int argc, char **argv)
     ++num_failed_tests;
   }
 
+  /* Test 7: arena */
+  testret = test_arena ();
+  SC_LDEBUGF ("test_arena: #entries with errors = %i\n", testret);
+  if (testret != 0) {
+    ++num_failed_tests;
+  }
+
   /* finalize sc */
   sc_finalize ();
 
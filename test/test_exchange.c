@@ -0,0 +1,227 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+
+#include <sc_exchange.h>
+#include <sc_notify.h>
+
+/* the payload for a receiver encodes sender, receiver and position */
+static int
+test_count (int sender, int receiver)
+{
+  return (sender + 2 * receiver) % 5;
+}
+
+static int
+test_value (int sender, int receiver, int j)
+{
+  return 1000 * sender + 10 * receiver + j;
+}
+
+static void
+test_verify (int mpirank, int *expected, int num_expected,
+             sc_array_t * senders, sc_array_t * recv_counts,
+             int *recv_data)
+{
+  int                 i, j, s, offset;
+
+  SC_CHECK_ABORT ((int) senders->elem_count == num_expected,
+                  "Mismatched sender numbers");
+  for (offset = 0, i = 0; i < num_expected; ++i) {
+    s = *(int *) sc_array_index_int (senders, i);
+    SC_CHECK_ABORTF (s == expected[i], "Mismatched sender %d", i);
+    SC_CHECK_ABORT (*(int *) sc_array_index_int (recv_counts, i) ==
+                    test_count (s, mpirank), "Mismatched count");
+    for (j = 0; j < test_count (s, mpirank); ++j) {
+      SC_CHECK_ABORT (recv_data[offset++] == test_value (s, mpirank, j),
+                      "Mismatched payload");
+    }
+  }
+}
+
+/* run a plan repeatedly with changing payload and two pairs of buffers */
+static void
+test_plan (int mpirank, int num_receivers, int *receivers,
+           int *send_counts, int *expected, int num_expected,
+           sc_MPI_Comm mpicomm)
+{
+  int                 i, j, k, iter, total;
+  int                *send_data[2], *recv_data[2];
+  sc_comm_plan_t     *plan;
+
+  plan = sc_comm_plan_new (num_receivers, receivers, send_counts,
+                           sizeof (int), mpicomm);
+  SC_CHECK_ABORT (plan->num_senders == num_expected,
+                  "Mismatched plan senders");
+  for (i = 0; i < num_expected; ++i) {
+    SC_CHECK_ABORT (plan->senders[i] == expected[i], "Mismatched sender");
+    SC_CHECK_ABORT (plan->recv_counts[i] ==
+                    test_count (expected[i], mpirank), "Mismatched count");
+  }
+  total = (int) plan->send_offsets[num_receivers];
+  for (k = 0; k < 2; ++k) {
+    send_data[k] = SC_ALLOC (int, total);
+    recv_data[k] = SC_ALLOC (int, plan->recv_offsets[num_expected]);
+  }
+
+  for (iter = 0; iter < 6; ++iter) {
+    k = iter / 3;
+    for (total = 0, i = 0; i < num_receivers; ++i) {
+      for (j = 0; j < send_counts[i]; ++j) {
+        send_data[k][total++] =
+          test_value (mpirank, receivers[i], j) + 100000 * iter;
+      }
+    }
+    sc_comm_plan_execute (plan, send_data[k], recv_data[k]);
+    for (total = 0, i = 0; i < num_expected; ++i) {
+      for (j = 0; j < plan->recv_counts[i]; ++j) {
+        SC_CHECK_ABORT (recv_data[k][total++] ==
+                        test_value (expected[i], mpirank, j) +
+                        100000 * iter, "Mismatched plan payload");
+      }
+    }
+  }
+
+  for (k = 0; k < 2; ++k) {
+    SC_FREE (send_data[k]);
+    SC_FREE (recv_data[k]);
+  }
+  sc_comm_plan_destroy (plan);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 i, j;
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  int                *receivers, num_receivers;
+  int                *sorted, *expected, num_expected;
+  int                *send_counts, *send_data, total;
+  double              elapsed_exchange;
+  sc_array_t         *senders, *recv_counts, *recv_buffer;
+  sc_array_t         *areceivers, *send_arrays, *recv_arrays, *arr;
+  sc_MPI_Comm         mpicomm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpicomm = sc_MPI_COMM_WORLD;
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (mpicomm, 1, 1, NULL, SC_LP_DEFAULT);
+
+  /* unsorted receivers, possibly including ourselves */
+  num_receivers = 1 + (mpirank * (mpirank % 100)) % 7;
+  num_receivers = SC_MIN (num_receivers, mpisize);
+  receivers = SC_ALLOC (int, num_receivers);
+  send_counts = SC_ALLOC (int, num_receivers);
+  for (total = 0, i = 0; i < num_receivers; ++i) {
+    receivers[i] = (3 * mpirank + num_receivers - i) % mpisize;
+    send_counts[i] = test_count (mpirank, receivers[i]);
+    total += send_counts[i];
+  }
+  send_data = SC_ALLOC (int, total);
+  for (total = 0, i = 0; i < num_receivers; ++i) {
+    for (j = 0; j < send_counts[i]; ++j) {
+      send_data[total++] = test_value (mpirank, receivers[i], j);
+    }
+  }
+
+  /* the expected senders are computed by sc_notify_allgather */
+  sorted = SC_ALLOC (int, num_receivers);
+  memcpy (sorted, receivers, num_receivers * sizeof (int));
+  qsort (sorted, num_receivers, sizeof (int), sc_int_compare);
+  expected = SC_ALLOC (int, mpisize);
+  mpiret = sc_notify_allgather (sorted, num_receivers,
+                                expected, &num_expected, mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  SC_GLOBAL_INFO ("Testing sc_exchange\n");
+  senders = sc_array_new (sizeof (int));
+  recv_counts = sc_array_new (sizeof (int));
+  recv_buffer = sc_array_new (sizeof (int));
+  elapsed_exchange = -sc_MPI_Wtime ();
+  mpiret = sc_exchange (num_receivers, receivers, send_counts, send_data,
+                        sizeof (int), senders, recv_counts, recv_buffer,
+                        mpicomm);
+  SC_CHECK_MPI (mpiret);
+  elapsed_exchange += sc_MPI_Wtime ();
+  test_verify (mpirank, expected, num_expected, senders,
+               recv_counts, (int *) recv_buffer->array);
+
+  SC_GLOBAL_INFO ("Testing sc_exchange_arrays\n");
+  areceivers = sc_array_new_data (receivers, sizeof (int),
+                                  (size_t) num_receivers);
+  send_arrays = sc_array_new_count (sizeof (sc_array_t),
+                                    (size_t) num_receivers);
+  for (total = 0, i = 0; i < num_receivers; ++i) {
+    sc_array_init_data ((sc_array_t *) sc_array_index_int (send_arrays, i),
+                        send_data + total, sizeof (int),
+                        (size_t) send_counts[i]);
+    total += send_counts[i];
+  }
+  recv_arrays = sc_array_new (sizeof (sc_array_t));
+  mpiret = sc_exchange_arrays (areceivers, send_arrays, sizeof (int),
+                               senders, recv_arrays, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  sc_array_resize (recv_buffer, 0);
+  for (i = 0; i < (int) recv_arrays->elem_count; ++i) {
+    arr = (sc_array_t *) sc_array_index_int (recv_arrays, i);
+    *(int *) sc_array_index_int (recv_counts, i) = (int) arr->elem_count;
+    for (j = 0; j < (int) arr->elem_count; ++j) {
+      *(int *) sc_array_push (recv_buffer) = *(int *) sc_array_index_int
+        (arr, j);
+    }
+    sc_array_reset (arr);
+  }
+  test_verify (mpirank, expected, num_expected, senders,
+               recv_counts, (int *) recv_buffer->array);
+
+  SC_GLOBAL_INFO ("Testing sc_comm_plan\n");
+  test_plan (mpirank, num_receivers, receivers, send_counts,
+             expected, num_expected, mpicomm);
+
+  sc_array_destroy (recv_arrays);
+  sc_array_destroy (send_arrays);
+  sc_array_destroy (areceivers);
+  sc_array_destroy (recv_buffer);
+  sc_array_destroy (recv_counts);
+  sc_array_destroy (senders);
+  SC_FREE (expected);
+  SC_FREE (sorted);
+  SC_FREE (send_data);
+  SC_FREE (send_counts);
+  SC_FREE (receivers);
+
+  SC_GLOBAL_STATISTICSF ("   exchange %g\n", elapsed_exchange);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,448 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_containers.h>
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+static unsigned
+test_hash_fn (const void *v, const void *u)
+{
+  unsigned            a, b, c;
+
+  a = (unsigned) *(const int *) v;
+  b = 0xdeadbeef;
+  c = 0;
+  sc_hash_final (a, b, c);
+
+  return c;
+}
+
+static int
+test_equal_fn (const void *v1, const void *v2, const void *u)
+{
+  return *(const int *) v1 == *(const int *) v2;
+}
+
+static int
+test_count_fn (void **v, const void *u)
+{
+  ++*(size_t *) u;
+  return 1;
+}
+
+static void
+test_fhash (sc_array_t * keys, size_t N0)
+{
+  const size_t        N = keys->elem_count;
+  int                 added;
+  int                 other;
+  int                *k;
+  size_t              zz, count;
+  void              **found;
+  void               *removed;
+  double              elapsed_hash, elapsed_fhash;
+  sc_hash_t          *hash;
+  sc_fhash_t         *fhash;
+
+  fhash = sc_fhash_new (test_hash_fn, test_equal_fn, &count);
+  hash = sc_hash_new (test_hash_fn, test_equal_fn, &count, NULL);
+
+  /* the first N0 keys are new, then come N0 / 2 duplicates */
+  elapsed_fhash = -sc_MPI_Wtime ();
+  for (zz = 0; zz < N; ++zz) {
+    k = (int *) sc_array_index (keys, zz);
+    added = sc_fhash_insert_unique (fhash, k, &found);
+    SC_CHECK_ABORT (added == (zz < N0 || zz >= N0 + (N0 + 1) / 2),
+                    "Flat hash insert");
+    SC_CHECK_ABORT (found != NULL && *(int *) *found == *k,
+                    "Flat hash insert found");
+  }
+  for (zz = 0; zz < N; ++zz) {
+    k = (int *) sc_array_index (keys, zz);
+    SC_CHECK_ABORT (sc_fhash_lookup (fhash, k, &found) &&
+                    *(int *) *found == *k, "Flat hash lookup");
+  }
+  elapsed_fhash += sc_MPI_Wtime ();
+
+  elapsed_hash = -sc_MPI_Wtime ();
+  for (zz = 0; zz < N; ++zz) {
+    k = (int *) sc_array_index (keys, zz);
+    (void) sc_hash_insert_unique (hash, k, NULL);
+  }
+  for (zz = 0; zz < N; ++zz) {
+    k = (int *) sc_array_index (keys, zz);
+    SC_CHECK_ABORT (sc_hash_lookup (hash, k, NULL), "Hash lookup");
+  }
+  elapsed_hash += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (hash->elem_count == fhash->elem_count, "Hash count");
+
+  count = 0;
+  sc_fhash_foreach (fhash, test_count_fn);
+  SC_CHECK_ABORT (count == fhash->elem_count, "Flat hash foreach");
+  sc_fhash_print_statistics (sc_package_id, SC_LP_STATISTICS, fhash);
+  sc_hash_print_statistics (sc_package_id, SC_LP_STATISTICS, hash);
+  SC_GLOBAL_STATISTICSF ("Hash memory %lu flat %lu\n",
+                         (unsigned long) sc_hash_memory_used (hash),
+                         (unsigned long) sc_fhash_memory_used (fhash));
+  SC_GLOBAL_STATISTICSF ("Hash time %g flat %g\n",
+                         elapsed_hash, elapsed_fhash);
+
+  /* remove all odd keys and check the remaining ones */
+  for (zz = 0; zz < N; ++zz) {
+    k = (int *) sc_array_index (keys, zz);
+    if (*k % 2 == 1) {
+      added = sc_fhash_remove (fhash, k, &removed);
+      SC_CHECK_ABORT (added && *(int *) removed == *k, "Flat hash remove");
+    }
+  }
+  for (zz = 0; zz < N; ++zz) {
+    k = (int *) sc_array_index (keys, zz);
+    SC_CHECK_ABORT (sc_fhash_lookup (fhash, k, NULL) == (*k % 2 == 0),
+                    "Flat hash lookup after remove");
+  }
+  other = -1;
+  SC_CHECK_ABORT (!sc_fhash_lookup (fhash, &other, NULL),
+                  "Flat hash lookup missing");
+
+  /* remove everything to exercise shrinking */
+  for (zz = 0; zz < N; ++zz) {
+    k = (int *) sc_array_index (keys, zz);
+    (void) sc_fhash_remove (fhash, k, NULL);
+  }
+  SC_CHECK_ABORT (fhash->elem_count == 0, "Flat hash empty");
+  count = 0;
+  sc_fhash_foreach (fhash, test_count_fn);
+  SC_CHECK_ABORT (count == 0, "Flat hash foreach empty");
+
+  sc_fhash_truncate (fhash);
+  SC_CHECK_ABORT (sc_fhash_insert_unique (fhash, &other, NULL),
+                  "Flat hash insert after truncate");
+
+  sc_hash_destroy (hash);
+  sc_fhash_destroy (fhash);
+}
+
+static void
+test_fhash_array (sc_array_t * keys)
+{
+  const size_t        N = keys->elem_count;
+  int                *k, *e;
+  void               *r1, *r2;
+  size_t              zz, p1, p2;
+  double              elapsed_hash, elapsed_fhash;
+  sc_array_t          rip;
+  sc_hash_array_t    *ha;
+  sc_fhash_array_t   *fa;
+
+  ha = sc_hash_array_new (sizeof (int), test_hash_fn, test_equal_fn, NULL);
+  fa = sc_fhash_array_new (sizeof (int), test_hash_fn, test_equal_fn, NULL);
+
+  elapsed_fhash = -sc_MPI_Wtime ();
+  for (zz = 0; zz < N; ++zz) {
+    k = (int *) sc_array_index (keys, zz);
+    e = (int *) sc_fhash_array_insert_unique (fa, k, &p2);
+    if (e != NULL) {
+      *e = *k;
+    }
+  }
+  elapsed_fhash += sc_MPI_Wtime ();
+
+  elapsed_hash = -sc_MPI_Wtime ();
+  for (zz = 0; zz < N; ++zz) {
+    k = (int *) sc_array_index (keys, zz);
+    e = (int *) sc_hash_array_insert_unique (ha, k, &p1);
+    if (e != NULL) {
+      *e = *k;
+    }
+  }
+  elapsed_hash += sc_MPI_Wtime ();
+
+  /* both containers must produce the same array and positions */
+  SC_CHECK_ABORT (sc_array_is_equal (&ha->a, &fa->a), "Hash array content");
+  for (zz = 0; zz < N; ++zz) {
+    k = (int *) sc_array_index (keys, zz);
+    r1 = sc_hash_array_insert_unique (ha, k, &p1);
+    r2 = sc_fhash_array_insert_unique (fa, k, &p2);
+    SC_CHECK_ABORT (r1 == NULL && r2 == NULL && p1 == p2,
+                    "Hash array position");
+    SC_CHECK_ABORT (sc_fhash_array_lookup (fa, k, &p2) && p1 == p2,
+                    "Hash array lookup");
+  }
+  SC_CHECK_ABORT (sc_fhash_array_is_valid (fa), "Hash array valid");
+  SC_GLOBAL_STATISTICSF ("Hash array memory %lu flat %lu\n",
+                         (unsigned long) sc_hash_array_memory_used (ha),
+                         (unsigned long) sc_fhash_array_memory_used (fa));
+  SC_GLOBAL_STATISTICSF ("Hash array time %g flat %g\n",
+                         elapsed_hash, elapsed_fhash);
+
+  sc_fhash_array_truncate (fa);
+  SC_CHECK_ABORT (fa->a.elem_count == 0 &&
+                  !sc_fhash_array_lookup (fa, keys->array, NULL),
+                  "Hash array truncate");
+  e = (int *) sc_fhash_array_insert_unique (fa, keys->array, &p2);
+  SC_CHECK_ABORT (e != NULL && p2 == 0, "Hash array insert after truncate");
+  *e = *(int *) keys->array;
+
+  sc_fhash_array_rip (fa, &rip);
+  SC_CHECK_ABORT (rip.elem_count == 1 &&
+                  *(int *) rip.array == *(int *) keys->array,
+                  "Hash array rip");
+  sc_array_reset (&rip);
+  sc_hash_array_destroy (ha);
+}
+
+static void
+test_hash_batch (sc_array_t * keys)
+{
+  const size_t        N = keys->elem_count;
+  size_t              zz, num_added, num_found;
+  int                 missing = -1;
+  void              **found, **single;
+  double              elapsed_single, elapsed_batch;
+  sc_array_t         *pkeys, *out;
+  sc_hash_t          *hash;
+
+  pkeys = sc_array_new_count (sizeof (void *), N);
+  for (zz = 0; zz < N; ++zz) {
+    *(void **) sc_array_index (pkeys, zz) = sc_array_index (keys, zz);
+  }
+  out = sc_array_new (sizeof (void **));
+
+  hash = sc_hash_new (test_hash_fn, test_equal_fn, NULL, NULL);
+  num_added = sc_hash_insert_unique_batch (hash, pkeys, out);
+  SC_CHECK_ABORT (num_added == hash->elem_count, "Batch insert count");
+  SC_CHECK_ABORT (out->elem_count == N, "Batch insert output");
+  for (zz = 0; zz < N; ++zz) {
+    found = *(void ***) sc_array_index (out, zz);
+    SC_CHECK_ABORT (found != NULL && *(int *) *found ==
+                    *(int *) sc_array_index (keys, zz), "Batch insert found");
+    SC_CHECK_ABORT (sc_hash_lookup (hash, *found, &single) && single == found,
+                    "Batch insert position");
+  }
+
+  elapsed_batch = -sc_MPI_Wtime ();
+  num_found = sc_hash_lookup_batch (hash, pkeys, out);
+  elapsed_batch += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (num_found == N, "Batch lookup count");
+
+  elapsed_single = -sc_MPI_Wtime ();
+  for (zz = 0; zz < N; ++zz) {
+    SC_CHECK_ABORT (sc_hash_lookup (hash, sc_array_index (keys, zz), &found)
+                    && found == *(void ***) sc_array_index (out, zz),
+                    "Batch lookup found");
+  }
+  elapsed_single += sc_MPI_Wtime ();
+  SC_GLOBAL_STATISTICSF ("Hash lookup time single %g batch %g\n",
+                         elapsed_single, elapsed_batch);
+
+  /* a missing key yields NULL in the output */
+  sc_array_resize (pkeys, 1);
+  *(void **) sc_array_index (pkeys, 0) = &missing;
+  SC_CHECK_ABORT (sc_hash_lookup_batch (hash, pkeys, out) == 0 &&
+                  *(void **) sc_array_index (out, 0) == NULL,
+                  "Batch lookup missing");
+
+  sc_hash_destroy (hash);
+  sc_array_destroy (out);
+  sc_array_destroy (pkeys);
+}
+
+typedef struct test_chash_data
+{
+#ifdef SC_ENABLE_PTHREAD
+  pthread_t           thread;
+#endif
+  int                 id, num_threads;
+  size_t              num_added, num_removed;
+  sc_array_t         *keys;
+  sc_chash_t         *chash;
+}
+test_chash_data_t;
+
+static void        *
+test_chash_insert (void *v)
+{
+  test_chash_data_t  *td = (test_chash_data_t *) v;
+  size_t              zz;
+  int                *k;
+  void               *found;
+
+  /* every thread inserts all keys, starting at a different offset */
+  td->num_added = 0;
+  for (zz = 0; zz < td->keys->elem_count; ++zz) {
+    k = (int *) sc_array_index (td->keys, (zz + td->id * 997) %
+                                td->keys->elem_count);
+    td->num_added += sc_chash_insert_unique (td->chash, k, &found);
+    SC_CHECK_ABORT (*(int *) found == *k, "Concurrent insert found");
+  }
+  return v;
+}
+
+static void        *
+test_chash_remove (void *v)
+{
+  test_chash_data_t  *td = (test_chash_data_t *) v;
+  size_t              zz;
+  int                *k;
+
+  /* each thread removes the keys in its residue class */
+  td->num_removed = 0;
+  for (zz = 0; zz < td->keys->elem_count; ++zz) {
+    k = (int *) sc_array_index (td->keys, zz);
+    if (*k % td->num_threads == td->id) {
+      td->num_removed += sc_chash_remove (td->chash, k, NULL);
+      SC_CHECK_ABORT (!sc_chash_lookup (td->chash, k, NULL),
+                      "Concurrent remove");
+    }
+  }
+  return v;
+}
+
+static int
+test_chash_mark (void **v, const void *u)
+{
+  /* distinct objects mark distinct bytes, so no lock is needed */
+  ((char *) u)[*(int *) *v] = 1;
+  return 1;
+}
+
+static void
+test_chash_run (test_chash_data_t * td, int num_threads,
+                void *(*fn) (void *))
+{
+  int                 i;
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+  void               *exitval;
+
+  for (i = 0; i < num_threads; ++i) {
+    pth = pthread_create (&td[i].thread, NULL, fn, &td[i]);
+    SC_CHECK_ABORTF (pth == 0, "pthread_create error %d", pth);
+  }
+  for (i = 0; i < num_threads; ++i) {
+    pth = pthread_join (td[i].thread, &exitval);
+    SC_CHECK_ABORT (pth == 0 && exitval == &td[i], "Fail in pthread_join");
+  }
+#else
+  for (i = 0; i < num_threads; ++i) {
+    (void) fn (&td[i]);
+  }
+#endif
+}
+
+static void
+test_chash (sc_array_t * keys, size_t N0)
+{
+  const int           num_threads = 4;
+  int                 i;
+  size_t              zz, total;
+  char               *marks;
+  test_chash_data_t   td[4];
+  sc_chash_t         *chash;
+
+  /* all keys are smaller than 4 * N0 */
+  marks = SC_ALLOC_ZERO (char, 4 * N0);
+  chash = sc_chash_new (test_hash_fn, test_equal_fn, marks, 0);
+  for (i = 0; i < num_threads; ++i) {
+    td[i].id = i;
+    td[i].num_threads = num_threads;
+    td[i].keys = keys;
+    td[i].chash = chash;
+  }
+
+  test_chash_run (td, num_threads, test_chash_insert);
+  for (total = 0, i = 0; i < num_threads; ++i) {
+    total += td[i].num_added;
+  }
+  SC_CHECK_ABORT (total == sc_chash_elem_count (chash) &&
+                  total == keys->elem_count - (N0 + 1) / 2,
+                  "Concurrent insert count");
+
+  sc_chash_foreach_parallel (chash, test_chash_mark, num_threads);
+  for (zz = 0; zz < keys->elem_count; ++zz) {
+    SC_CHECK_ABORT (marks[*(int *) sc_array_index (keys, zz)],
+                    "Concurrent foreach");
+  }
+  SC_GLOBAL_STATISTICSF ("Concurrent hash shards %d memory %lu\n",
+                         chash->num_shards,
+                         (unsigned long) sc_chash_memory_used (chash));
+
+  test_chash_run (td, num_threads, test_chash_remove);
+  for (total = 0, i = 0; i < num_threads; ++i) {
+    total += td[i].num_removed;
+  }
+  SC_CHECK_ABORT (total == keys->elem_count - (N0 + 1) / 2 &&
+                  sc_chash_elem_count (chash) == 0,
+                  "Concurrent remove count");
+
+  sc_chash_destroy (chash);
+  SC_FREE (marks);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 N;
+  int                 i;
+  sc_array_t         *keys;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  N = 100000;
+  if (argc >= 2) {
+    N = atoi (argv[1]);
+    SC_CHECK_ABORT (N > 0, "Usage: sc_test_hash [count]");
+  }
+
+  /* keys 0 to N - 1, duplicates of the even ones, then more even ones */
+  keys = sc_array_new (sizeof (int));
+  for (i = 0; i < N; ++i) {
+    *(int *) sc_array_push (keys) = i;
+  }
+  for (i = 0; i < N; i += 2) {
+    *(int *) sc_array_push (keys) = i;
+  }
+  for (i = 0; i < N; ++i) {
+    *(int *) sc_array_push (keys) = 2 * N + 2 * i;
+  }
+
+  test_fhash (keys, (size_t) N);
+  test_fhash_array (keys);
+  test_hash_batch (keys);
+  test_chash (keys, (size_t) N);
+
+  sc_array_destroy (keys);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -139,6 +139,32 @@ main (int argc, char **argv)
     }
   }
 
+  /* the tuned type must work as well as any other */
+  itype = (int) sc_shmem_autotune (sc_MPI_COMM_WORLD);
+  SC_CHECK_ABORT (itype >= 0 && itype < (int) SC_SHMEM_NUM_TYPES &&
+                  sc_shmem_get_type (sc_MPI_COMM_WORLD) ==
+                  (sc_shmem_type_t) itype, "sc_shmem_autotune");
+  retval += test_shmem (2, sc_MPI_COMM_WORLD, (sc_shmem_type_t) itype);
+
+  /* emulate several nodes on a duplicate of the world communicator */
+  if (size > 2 && !(size % 2)) {
+    sc_MPI_Comm         comm;
+
+    mpiret = sc_MPI_Comm_dup (sc_MPI_COMM_WORLD, &comm);
+    SC_CHECK_MPI (mpiret);
+    sc_mpi_comm_attach_node_comms (comm, 2);
+    for (itype = 0; itype < (int) SC_SHMEM_NUM_TYPES; itype++) {
+      SC_GLOBAL_PRODUCTIONF ("sc_shmem type: %s on two-process nodes\n",
+                             sc_shmem_type_to_string[itype]);
+      for (count = 1; count <= 3; count++) {
+        retval += test_shmem (count, comm, (sc_shmem_type_t) itype);
+      }
+    }
+    sc_mpi_comm_detach_node_comms (comm);
+    mpiret = sc_MPI_Comm_free (&comm);
+    SC_CHECK_MPI (mpiret);
+  }
+
   sc_finalize ();
 
   mpiret = sc_MPI_Finalize ();
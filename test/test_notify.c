@@ -23,6 +23,63 @@
 
 #include <sc_notify.h>
 
+/* number of repetitions of every algorithm in the sparse benchmark */
+#define TEST_NOTIFY_REPEAT 10
+
+/* time a sparse pattern of up to 26 neighbors, as from a 3D stencil */
+static void
+test_sparse (sc_MPI_Comm mpicomm)
+{
+  int                 i, k;
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  int                 num_receivers, num_senders;
+  int                *receivers, *senders;
+  double              elapsed;
+  sc_notify_type_t    type;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  num_receivers = SC_MIN (26, mpisize - 1);
+  receivers = SC_ALLOC (int, num_receivers);
+  for (i = 0; i < num_receivers; ++i) {
+    receivers[i] = (mpirank + 1 + i) % mpisize;
+  }
+  qsort (receivers, num_receivers, sizeof (int), sc_int_compare);
+  senders = SC_ALLOC (int, mpisize);
+
+  for (type = SC_NOTIFY_ALLGATHER; type < SC_NOTIFY_NUM_TYPES; ++type) {
+    mpiret = sc_MPI_Barrier (mpicomm);
+    SC_CHECK_MPI (mpiret);
+    elapsed = -sc_MPI_Wtime ();
+    for (k = 0; k < TEST_NOTIFY_REPEAT; ++k) {
+      mpiret = sc_notify_ext (receivers, num_receivers,
+                              senders, &num_senders, mpicomm, type);
+      SC_CHECK_MPI (mpiret);
+    }
+    elapsed += sc_MPI_Wtime ();
+
+    /* the senders are the ranks that precede us cyclically */
+    SC_CHECK_ABORT (num_senders == num_receivers, "Sparse sender number");
+    for (i = 0; i < num_senders - 1; ++i) {
+      SC_CHECK_ABORT (senders[i] < senders[i + 1], "Sparse sender order");
+    }
+    for (i = 0; i < num_senders; ++i) {
+      k = (mpirank - senders[i] + mpisize) % mpisize;
+      SC_CHECK_ABORT (1 <= k && k <= num_receivers, "Sparse sender");
+    }
+    SC_GLOBAL_STATISTICSF ("   sparse %-9s %g\n",
+                           sc_notify_type_to_string[type],
+                           elapsed / TEST_NOTIFY_REPEAT);
+  }
+
+  SC_FREE (receivers);
+  SC_FREE (senders);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -31,9 +88,11 @@ main (int argc, char **argv)
   int                 mpisize, mpirank;
   int                *senders, num_senders;
   int                *senders2, num_senders2;
+  int                *senders3, num_senders3;
   int                *receivers, num_receivers;
   double              elapsed_allgather;
   double              elapsed_native;
+  double              elapsed_nbx;
   sc_MPI_Comm         mpicomm;
 
   mpiret = sc_MPI_Init (&argc, &argv);
@@ -70,17 +129,45 @@ main (int argc, char **argv)
   SC_CHECK_MPI (mpiret);
   elapsed_native += sc_MPI_Wtime ();
 
+  SC_GLOBAL_INFO ("Testing sc_notify_nbx\n");
+  senders3 = SC_ALLOC (int, mpisize);
+  elapsed_nbx = -sc_MPI_Wtime ();
+  mpiret = sc_notify_nbx (receivers, num_receivers,
+                          senders3, &num_senders3, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  elapsed_nbx += sc_MPI_Wtime ();
+
   SC_CHECK_ABORT (num_senders == num_senders2, "Mismatched sender numbers");
+  SC_CHECK_ABORT (num_senders == num_senders3, "Mismatched sender numbers");
   for (i = 0; i < num_senders; ++i) {
     SC_CHECK_ABORTF (senders[i] == senders2[i], "Mismatched sender %d", i);
+    SC_CHECK_ABORTF (senders[i] == senders3[i], "Mismatched sender %d", i);
   }
 
   SC_FREE (receivers);
   SC_FREE (senders);
   SC_FREE (senders2);
+  SC_FREE (senders3);
 
   SC_GLOBAL_STATISTICSF ("   notify_allgather %g\n", elapsed_allgather);
   SC_GLOBAL_STATISTICSF ("   notify           %g\n", elapsed_native);
+  SC_GLOBAL_STATISTICSF ("   notify_nbx       %g\n", elapsed_nbx);
+
+  SC_GLOBAL_INFO ("Timing sparse notification\n");
+  test_sparse (mpicomm);
+
+  /* select the algorithm by a communicator setting */
+  sc_notify_set_type (mpicomm, SC_NOTIFY_NBX);
+  SC_CHECK_ABORT (sc_notify_get_type (mpicomm) ==
+#ifdef SC_ENABLE_MPI
+                  SC_NOTIFY_NBX
+#else
+                  sc_notify_default_type
+#endif
+                  , "Notify type setting");
+  sc_notify_set_type (mpicomm, SC_NOTIFY_DEFAULT);
+  SC_CHECK_ABORT (sc_notify_get_type (mpicomm) == sc_notify_default_type,
+                  "Notify type reset");
 
   sc_finalize ();
 
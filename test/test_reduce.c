@@ -23,8 +23,72 @@
 
 #include <sc_reduce.h>
 
-int
-main (int argc, char **argv)
+/* minimum of pairs of value and location, ties resolved by location */
+static void
+test_minloc (void *sendbuf, void *recvbuf, int sendcount,
+             sc_MPI_Datatype sendtype)
+{
+  int                 i;
+  const int          *in = (const int *) sendbuf;
+  int                *inout = (int *) recvbuf;
+
+  SC_ASSERT (sendtype == sc_MPI_INT && sendcount % 2 == 0);
+  for (i = 0; i < sendcount; i += 2) {
+    if (in[i] < inout[i] || (in[i] == inout[i] && in[i + 1] < inout[i + 1])) {
+      inout[i] = in[i];
+      inout[i + 1] = in[i + 1];
+    }
+  }
+}
+
+static void
+test_ireduce (sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 mpirank, mpisize;
+  int                 flag, polls;
+  int                 ivalue[2], iresult[2];
+  int                 ivalue2[2], iresult2[2];
+  long                lvalue, lresult;
+  sc_reduce_request_t *request, *request2;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* test nonblocking allreduce long sum progressed by polling */
+  lvalue = (long) mpirank;
+  sc_iallreduce (&lvalue, &lresult, 1, sc_MPI_LONG, sc_MPI_SUM, mpicomm,
+                 &request);
+  for (polls = 0, flag = 0; !flag; ++polls) {
+    sc_iallreduce_test (&request, &flag);
+  }
+  SC_CHECK_ABORT (request == NULL, "Request not freed");
+  SC_CHECK_ABORT (lresult == ((long) (mpisize - 1)) * mpisize / 2,
+                  "Iallreduce mismatch");
+
+  /* test two custom minloc reductions in flight and completed in reverse */
+  ivalue[0] = mpirank % 3;
+  ivalue[1] = mpisize - mpirank;
+  sc_iallreduce_custom (ivalue, iresult, 2, sc_MPI_INT, test_minloc,
+                        mpicomm, &request);
+  ivalue2[0] = -mpirank;
+  ivalue2[1] = mpirank;
+  sc_iallreduce_custom (ivalue2, iresult2, 2, sc_MPI_INT, test_minloc,
+                        mpicomm, &request2);
+  sc_iallreduce_wait (&request2);
+  sc_iallreduce_wait (&request);
+  SC_CHECK_ABORT (request == NULL && request2 == NULL, "Request not freed");
+  SC_CHECK_ABORT (iresult[0] == 0 &&
+                  iresult[1] == mpisize - (mpisize - 1) / 3 * 3,
+                  "Iallreduce custom mismatch");
+  SC_CHECK_ABORT (iresult2[0] == 1 - mpisize && iresult2[1] == mpisize - 1,
+                  "Iallreduce custom mismatch");
+}
+
+static void
+test_reduce (sc_MPI_Comm mpicomm)
 {
   int                 mpiret;
   int                 mpirank, mpisize;
@@ -35,19 +99,12 @@ main (int argc, char **argv)
   long                lvalue, lresult;
   float               fvalue[3], fresult[3], fexpect[3];
   double              dvalue, dresult;
-  sc_MPI_Comm         mpicomm;
 
-  mpiret = sc_MPI_Init (&argc, &argv);
-  SC_CHECK_MPI (mpiret);
-
-  mpicomm = sc_MPI_COMM_WORLD;
   mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
   SC_CHECK_MPI (mpiret);
   mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
   SC_CHECK_MPI (mpiret);
 
-  sc_init (mpicomm, 1, 1, NULL, SC_LP_DEFAULT);
-
   /* test allreduce int max */
   ivalue = mpirank;
   sc_allreduce (&ivalue, &iresult, 1, sc_MPI_INT, sc_MPI_MAX, mpicomm);
@@ -100,6 +157,35 @@ main (int argc, char **argv)
                       "Reduce mismatch");
     }
   }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 mpisize;
+  sc_MPI_Comm         mpicomm, nodecomm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  mpicomm = sc_MPI_COMM_WORLD;
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (mpicomm, 1, 1, NULL, SC_LP_DEFAULT);
+
+  test_reduce (mpicomm);
+  test_ireduce (mpicomm);
+
+  /* repeat on emulated nodes of two processes each for two level reduce */
+  mpiret = sc_MPI_Comm_dup (mpicomm, &nodecomm);
+  SC_CHECK_MPI (mpiret);
+  sc_mpi_comm_attach_node_comms (nodecomm, mpisize % 2 ? 1 : 2);
+  test_reduce (nodecomm);
+  sc_mpi_comm_detach_node_comms (nodecomm);
+  mpiret = sc_MPI_Comm_free (&nodecomm);
+  SC_CHECK_MPI (mpiret);
 
   sc_finalize ();
 
@@ -0,0 +1,127 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_soa.h>
+
+static              size_t
+test_type_tag (sc_array_t * array, size_t index, void *data)
+{
+  return (size_t) *(char *) sc_array_index (array, index);
+}
+
+static int
+test_compare_double (const void *v1, const void *v2)
+{
+  const double        d1 = *(const double *) v1;
+  const double        d2 = *(const double *) v2;
+
+  return d1 < d2 ? -1 : d1 > d2;
+}
+
+int
+main (int argc, char **argv)
+{
+  const int           N = 1000;
+  const char         *names[3] = { "x", "id", "tag" };
+  const size_t        sizes[3] = { sizeof (double), sizeof (int), 1 };
+  int                 i, fx, fid, ftag;
+  size_t              zz, iz;
+  size_t             *zp;
+  sc_soa_t           *soa;
+  sc_array_t          view, *offsets, *perm;
+
+  sc_init (sc_MPI_COMM_NULL, 1, 1, NULL, SC_LP_DEFAULT);
+
+  soa = sc_soa_new (3, names, sizes);
+  fx = sc_soa_field (soa, "x");
+  fid = sc_soa_field (soa, "id");
+  ftag = sc_soa_field (soa, "tag");
+  SC_CHECK_ABORT (fx == 0 && fid == 1 && ftag == 2 &&
+                  sc_soa_field (soa, "y") == -1, "Field lookup");
+
+  for (i = 0; i < N; ++i) {
+    iz = sc_soa_push (soa);
+    SC_CHECK_ABORT (iz == (size_t) i, "Push index");
+    *(double *) sc_soa_index (soa, fx, iz) = (double) ((i * 37) % N);
+    *(int *) sc_soa_index (soa, fid, iz) = i;
+    *(char *) sc_soa_index (soa, ftag, iz) = (char) (i % 4);
+  }
+  for (i = 0; i < 3; ++i) {
+    SC_CHECK_ABORT ((uintptr_t) soa->columns[i] % SC_SOA_ALIGN == 0,
+                    "Column alignment");
+  }
+  SC_GLOBAL_INFOF ("Struct of arrays byte size %lld\n",
+                   (long long) sc_soa_memory_used (soa));
+
+  /* a column view is an ordinary array */
+  sc_soa_column (soa, fid, &view);
+  SC_CHECK_ABORT (view.elem_count == (size_t) N &&
+                  view.elem_size == sizeof (int), "Column view");
+  SC_CHECK_ABORT (*(int *) sc_array_index_int (&view, N - 1) == N - 1,
+                  "Column view value");
+
+  /* sorting by one field moves all fields along */
+  sc_soa_sort (soa, fx, test_compare_double);
+  for (zz = 0; zz < (size_t) N; ++zz) {
+    i = *(int *) sc_soa_index (soa, fid, zz);
+    SC_CHECK_ABORT (*(double *) sc_soa_index (soa, fx, zz) == (double) zz &&
+                    (i * 37) % N == (int) zz &&
+                    *(char *) sc_soa_index (soa, ftag, zz) == (char) (i % 4),
+                    "Sort by field");
+  }
+
+  /* group by tag with an explicit permutation and split */
+  perm = sc_array_new_count (sizeof (size_t), (size_t) N);
+  for (zz = 0; zz < (size_t) N; ++zz) {
+    zp = (size_t *) sc_array_index (perm, zz);
+    *zp = (zz % 4) * (N / 4) + zz / 4;
+  }
+  for (zz = 0; zz < (size_t) N; ++zz) {
+    *(char *) sc_soa_index (soa, ftag, zz) = (char) (zz % 4);
+  }
+  sc_soa_permute (soa, perm);
+  offsets = sc_array_new (sizeof (size_t));
+  sc_soa_split (soa, ftag, offsets, 4, test_type_tag, NULL);
+  for (i = 0; i <= 4; ++i) {
+    zp = (size_t *) sc_array_index_int (offsets, i);
+    SC_CHECK_ABORT (*zp == (size_t) (i * (N / 4)), "Split offsets");
+  }
+  SC_CHECK_ABORT (*(double *) sc_soa_index (soa, fx, N / 4) == 1.,
+                  "Permute value");
+
+  /* shrinking keeps the leading elements */
+  sc_soa_resize (soa, 10);
+  SC_CHECK_ABORT (soa->elem_count == 10 &&
+                  *(double *) sc_soa_index (soa, fx, 9) == 36.,
+                  "Resize");
+  sc_soa_resize (soa, 0);
+  SC_CHECK_ABORT (soa->block == NULL, "Resize zero");
+
+  sc_array_destroy (offsets);
+  sc_array_destroy (perm);
+  sc_soa_destroy (soa);
+
+  sc_finalize ();
+
+  return 0;
+}
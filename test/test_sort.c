@@ -24,6 +24,77 @@
 #include <sc_allgather.h>
 #include <sc_sort.h>
 
+#ifdef SC_ENABLE_DEBUG
+
+typedef struct test_record
+{
+  uint64_t            key;
+  size_t              gindex;
+}
+test_record_t;
+
+static int
+test_record_compare (const void *v1, const void *v2)
+{
+  const uint64_t      k1 = ((const test_record_t *) v1)->key;
+  const uint64_t      k2 = ((const test_record_t *) v2)->key;
+
+  return k1 < k2 ? -1 : k1 > k2;
+}
+
+/* sort records with many duplicate keys and verify global stability */
+static void
+test_stable (sc_MPI_Comm mpicomm, size_t * nmemb, sc_psort_key_t key_type)
+{
+  int                 mpiret;
+  int                 rank, num_procs;
+  int                 q, *recvc, *displ;
+  size_t              zz, lcount, first, gtotal;
+  test_record_t      *ldata, *gdata;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &num_procs);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  lcount = nmemb[rank];
+  for (first = 0, q = 0; q < rank; ++q) {
+    first += nmemb[q];
+  }
+  ldata = SC_ALLOC (test_record_t, lcount);
+  for (zz = 0; zz < lcount; ++zz) {
+    /* keys differing in one byte only sort by memcmp in either endian */
+    ldata[zz].key = (uint64_t) (rand () % 7) << 56;
+    ldata[zz].gindex = first + zz;
+  }
+  sc_psort_ext (mpicomm, ldata, nmemb, sizeof (test_record_t),
+                test_record_compare, key_type, 0, sizeof (uint64_t), 1);
+
+  recvc = SC_ALLOC (int, num_procs);
+  displ = SC_ALLOC (int, num_procs + 1);
+  displ[0] = 0;
+  for (q = 0; q < num_procs; ++q) {
+    recvc[q] = (int) (nmemb[q] * sizeof (test_record_t));
+    displ[q + 1] = displ[q] + recvc[q];
+  }
+  gtotal = (size_t) displ[num_procs] / sizeof (test_record_t);
+  gdata = SC_ALLOC (test_record_t, gtotal);
+  mpiret = sc_MPI_Allgatherv (ldata, recvc[rank], sc_MPI_BYTE,
+                              gdata, recvc, displ, sc_MPI_BYTE, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  for (zz = 1; zz < gtotal; ++zz) {
+    SC_CHECK_ABORT (gdata[zz - 1].key <= gdata[zz].key, "Key order");
+    SC_CHECK_ABORT (gdata[zz - 1].key != gdata[zz].key ||
+                    gdata[zz - 1].gindex < gdata[zz].gindex, "Stability");
+  }
+  SC_FREE (gdata);
+  SC_FREE (displ);
+  SC_FREE (recvc);
+  SC_FREE (ldata);
+}
+
+#endif
+
 int
 main (int argc, char **argv)
 {
@@ -37,7 +108,8 @@ main (int argc, char **argv)
   size_t              zz;
   size_t              lcount, gtotal;
   size_t             *nmemb;
-  double             *ldata, *gdata;
+  double             *ldata, *sdata, *gdata;
+  double              start, bitonic_time, sample_time;
   sc_MPI_Comm         mpicomm;
   char                buffer[BUFSIZ];
 
@@ -74,7 +146,30 @@ main (int argc, char **argv)
   for (zz = 0; zz < lcount; ++zz) {
     ldata[zz] = -50. + (100. * rand () / (RAND_MAX + 1.0));
   }
+  sdata = SC_ALLOC (double, lcount);
+  memcpy (sdata, ldata, lcount * sizeof (double));
+  start = sc_MPI_Wtime ();
   sc_psort (mpicomm, ldata, nmemb, sizeof (double), sc_double_compare);
+  bitonic_time = sc_MPI_Wtime () - start;
+
+  /* sample sort must produce the identical distributed result */
+  start = sc_MPI_Wtime ();
+  sc_psort_samplesort (mpicomm, sdata, nmemb, sizeof (double),
+                       sc_double_compare);
+  sample_time = sc_MPI_Wtime () - start;
+  SC_GLOBAL_PRODUCTIONF ("Bitonic sort %g sample sort %g seconds\n",
+                         bitonic_time, sample_time);
+  for (zz = 0; zz < lcount; ++zz) {
+    SC_CHECK_ABORT (sdata[zz] == ldata[zz], "Sample sort mismatch");
+  }
+
+  /* stable sort by integer key, byte key, and comparison function;
+     the check gathers all records on every process */
+  if (!timing || lcount < 1000) {
+    test_stable (mpicomm, nmemb, SC_PSORT_KEY_UNSIGNED);
+    test_stable (mpicomm, nmemb, SC_PSORT_KEY_BYTES);
+    test_stable (mpicomm, nmemb, SC_PSORT_KEY_COMPAR);
+  }
 
   /* output result */
   if (!timing) {
@@ -121,6 +216,7 @@ main (int argc, char **argv)
   }
 
   /* clean up and exit */
+  SC_FREE (sdata);
   SC_FREE (ldata);
   SC_FREE (nmemb);
 